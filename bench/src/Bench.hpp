@@ -0,0 +1,76 @@
+/**
+ * @file Bench.hpp
+ * @author UnnamedOrange
+ * @brief Minimal benchmark registry and timing helpers.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace orange::bench {
+    using BenchFunction = void (*)();
+
+    struct BenchCase {
+        const char* name;
+        BenchFunction function;
+    };
+
+    inline std::vector<BenchCase>& registry() {
+        static std::vector<BenchCase> cases;
+        return cases;
+    }
+
+    struct Registrar {
+        Registrar(const char* name, BenchFunction function) {
+            registry().push_back({name, function});
+        }
+    };
+
+    /**
+     * @brief Keep `value` alive so that the computation producing it is not optimized away.
+     */
+    inline void do_not_optimize(std::uint64_t value) {
+        static volatile std::uint64_t sink;
+        sink = sink ^ value;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    }
+
+    /**
+     * @brief Run `f` `iterations` times after one warm-up run and print the time per iteration.
+     *
+     * @param bytes_per_iteration If not 0, the throughput is printed as well.
+     * @return Nanoseconds per iteration.
+     */
+    template <typename F>
+    double measure(const char* label, std::size_t iterations, F&& f, std::size_t bytes_per_iteration = 0) {
+        using clock = std::chrono::steady_clock;
+        f();
+        auto start = clock::now();
+        for (std::size_t i = 0; i < iterations; i++)
+            f();
+        auto elapsed = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+        double per_iteration = elapsed / static_cast<double>(iterations);
+        if (bytes_per_iteration)
+            std::printf("  %-40s %14.1f ns/op %10.2f GB/s\n", label, per_iteration,
+                        static_cast<double>(bytes_per_iteration) / per_iteration);
+        else
+            std::printf("  %-40s %14.1f ns/op\n", label, per_iteration);
+        return per_iteration;
+    }
+} // namespace orange::bench
+
+#define ORANGE_BENCH(name)                                                                                             \
+    static void name();                                                                                                \
+    static const ::orange::bench::Registrar name##_registrar{#name, &name};                                            \
+    static void name()
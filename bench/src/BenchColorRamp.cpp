@@ -0,0 +1,51 @@
+/**
+ * @file BenchColorRamp.cpp
+ * @author UnnamedOrange
+ * @brief Benchmark `overlay::interpolate` against the lookup-table `overlay::color_ramp`.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <bit>
+#include <cstdint>
+
+#include "Bench.hpp"
+
+#include <overlay/color_ramp.hpp>
+
+using namespace overlay;
+
+ORANGE_BENCH(BenchColorRamp) {
+    constexpr color a(203u, 237u, 238u);
+    constexpr color b(255u, 104u, 143u);
+    constexpr size_t samples = 1024; // 每次迭代求值的次数，参数覆盖 [0, 8)。
+
+    orange::bench::measure("interpolate x1024", 2000, [&] {
+        float acc = 0;
+        for (size_t i = 0; i < samples; i++)
+            acc += interpolate(a, b, static_cast<double>(i) / 128, 2.0, 4.0).g;
+        orange::bench::do_not_optimize(std::bit_cast<std::uint32_t>(acc));
+    });
+    orange::bench::measure("color_ramp x1024", 2000, [&] {
+        float acc = 0;
+        for (size_t i = 0; i < samples; i++)
+            acc += ramps::button_kps(a, b, static_cast<double>(i) / 128).g;
+        orange::bench::do_not_optimize(std::bit_cast<std::uint32_t>(acc));
+    });
+    // 生成一帧时，插值后的颜色都要舍入到 8 位精度。
+    orange::bench::measure("interpolate + quantize x1024", 2000, [&] {
+        std::uint64_t acc = 0;
+        for (size_t i = 0; i < samples; i++)
+            acc += interpolate(a, b, static_cast<double>(i) / 128, 2.0, 4.0).to_rgba8();
+        orange::bench::do_not_optimize(acc);
+    });
+    orange::bench::measure("color_ramp + quantize x1024", 2000, [&] {
+        std::uint64_t acc = 0;
+        for (size_t i = 0; i < samples; i++)
+            acc += ramps::button_kps(a, b, static_cast<double>(i) / 128).to_rgba8();
+        orange::bench::do_not_optimize(acc);
+    });
+}
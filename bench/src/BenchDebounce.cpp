@@ -0,0 +1,62 @@
+/**
+ * @file BenchDebounce.cpp
+ * @author UnnamedOrange
+ * @brief Benchmark the per-event cost of `kps::debounce_filter` on batches and on single events.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <format>
+#include <span>
+#include <vector>
+
+#include "Bench.hpp"
+
+#include <debounce.hpp>
+
+using namespace kps;
+
+ORANGE_BENCH(BenchDebounce) {
+    // 8 个键交替按下与放开，约 1/8 的边沿是间隔 1 ms 的抖动。
+    constexpr size_t batch_size = 4096;
+    std::vector<key_event> events(batch_size);
+    {
+        std::vector<bool> down(8);
+        auto t = clock::now();
+        for (size_t i = 0; i < batch_size; i++) {
+            const size_t k = (i * 5) % 8;
+            t += (i % 8 == 7) ? std::chrono::milliseconds(1) : std::chrono::milliseconds(7);
+            down[k] = !down[k];
+            events[i] = {static_cast<int>(68 + k), static_cast<bool>(down[k]), 0, t};
+        }
+    }
+
+    std::vector<key_event> out(2 * batch_size);
+    for (auto mode : {debounce_mode::off, debounce_mode::eager, debounce_mode::deferred}) {
+        debounce_filter filter;
+        filter.set_mode(mode);
+        filter.set_interval(std::chrono::milliseconds(5));
+        const char* name = mode == debounce_mode::off ? "off" : mode == debounce_mode::eager ? "eager" : "deferred";
+
+        auto label = std::format("{}, batch of {}", name, batch_size);
+        double ns = orange::bench::measure(label.c_str(), 2000, [&] {
+            orange::bench::do_not_optimize(filter.process(events, out));
+        });
+        std::printf("  %-40s %14.2f ns/event\n", "", ns / static_cast<double>(batch_size));
+
+        // 监视器的回调每次只送入一个事件。
+        label = std::format("{}, one by one", name);
+        ns = orange::bench::measure(label.c_str(), 200, [&] {
+            size_t n = 0;
+            for (const auto& e : events)
+                n += filter.process({&e, 1}, std::span(out).first(2));
+            orange::bench::do_not_optimize(n);
+        });
+        std::printf("  %-40s %14.2f ns/event\n", "", ns / static_cast<double>(batch_size));
+    }
+}
@@ -0,0 +1,50 @@
+/**
+ * @file BenchFrameBuilder.cpp
+ * @author UnnamedOrange
+ * @brief Benchmark building overlay display lists.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <algorithm>
+#include <format>
+#include <string>
+
+#include "Bench.hpp"
+#include "SampleFrame.hpp"
+
+#include <overlay/frame_builder.hpp>
+
+using namespace overlay;
+
+ORANGE_BENCH(BenchFrameBuilder) {
+    orange::test::sample_frame sample(1.5);
+    for (size_t i = 0; i < sample.columns.size(); i++) {
+        sample.columns[i].down = i % 2 == 0;
+        sample.columns[i].kps = 4.0 + i;
+        sample.columns[i].since_down = 0.02 * i;
+        sample.columns[i].since_up = 0.1 * i;
+    }
+    auto& input = sample.input;
+    input.kps_now = 9;
+    input.max_kps = 15;
+    input.total_count = 12345;
+    input.history_first_second = 1000;
+    input.history_generation = 1; // 与实际运行时相同，同一秒内的帧增量更新图形。
+
+    frame_builder builder;
+    display_list list;
+    for (int button_count : {4, 10}) {
+        sample.set_button_count(button_count);
+        input.width = std::max(232.0, 60.0 * button_count - 8) * 1.5;
+
+        auto label = std::format("build {}K", button_count);
+        orange::bench::measure(label.c_str(), 100000, [&] {
+            builder.build(input, list);
+            orange::bench::do_not_optimize(list.commands().size());
+        });
+    }
+}
@@ -0,0 +1,82 @@
+/**
+ * @file BenchGraphSeries.cpp
+ * @author UnnamedOrange
+ * @brief Benchmark building the KPS graph polyline against the number of history points.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <algorithm>
+#include <format>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Bench.hpp"
+
+#include <overlay/display_list.hpp>
+#include <overlay/graph_series.hpp>
+
+using namespace overlay;
+
+ORANGE_BENCH(BenchGraphSeries) {
+    constexpr size_t columns = 216; // 默认窗口宽度下图形的像素列数。
+    constexpr float width = 216;
+    constexpr float height = 80;
+
+    for (size_t n : {300u, 3000u, 30000u}) {
+        std::vector<double> stream(n + 2048); // 每项测量共平移 2001 次。
+        for (size_t i = 0; i < stream.size(); i++)
+            stream[i] = static_cast<double>((i * 7) % 23);
+        display_list list;
+        auto y_of = [&](double v, double ceil) { return static_cast<float>(height - height * (v / ceil)); };
+
+        // 逐点生成折线，并每帧求一次最大值。
+        auto label = std::format("every point {}", n);
+        size_t offset = 0;
+        orange::bench::measure(label.c_str(), 2000, [&] {
+            offset++;
+            std::span<const double> values(stream.data() + offset, n);
+            list.clear();
+            double ceil = 1.25 * *std::max_element(values.begin(), values.end());
+            for (size_t i = 0; i < n; i++)
+                list.add_point({width * static_cast<float>(i) / static_cast<float>(n - 1), y_of(values[i], ceil)});
+            orange::bench::do_not_optimize(list.point_count());
+        });
+
+        // 抽稀，但每帧完整计算。
+        label = std::format("decimated rebuild {}", n);
+        graph_series series;
+        offset = 0;
+        orange::bench::measure(label.c_str(), 2000, [&] {
+            offset++;
+            series.update(std::span<const double>(stream.data() + offset, n), static_cast<long long>(offset), 0,
+                          columns);
+            list.clear();
+            double ceil = 1.25 * series.max();
+            series.for_each_point([&](size_t i, double v) {
+                list.add_point({width * static_cast<float>(i) / static_cast<float>(n - 1), y_of(v, ceil)});
+            });
+            orange::bench::do_not_optimize(list.point_count());
+        });
+
+        // 抽稀，每帧平移一秒并增量更新。
+        label = std::format("decimated shift {}", n);
+        graph_series shifted;
+        offset = 0;
+        orange::bench::measure(label.c_str(), 2000, [&] {
+            offset++;
+            shifted.update(std::span<const double>(stream.data() + offset, n), static_cast<long long>(offset), 1,
+                           columns);
+            list.clear();
+            double ceil = 1.25 * shifted.max();
+            shifted.for_each_point([&](size_t i, double v) {
+                list.add_point({width * static_cast<float>(i) / static_cast<float>(n - 1), y_of(v, ceil)});
+            });
+            orange::bench::do_not_optimize(list.point_count());
+        });
+    }
+}
@@ -0,0 +1,69 @@
+/**
+ * @file BenchPipeline.cpp
+ * @author UnnamedOrange
+ * @brief Benchmark `pipeline::event_pipeline` with the stages used by osu-kps and report the cost of each stage.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <format>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "Bench.hpp"
+
+#include <pipeline/event_pipeline.hpp>
+#include <pipeline/stages.hpp>
+
+using namespace pipeline;
+
+ORANGE_BENCH(BenchPipeline) {
+    constexpr size_t event_count = 4096;
+    std::vector<key_event> events(event_count);
+    {
+        std::vector<bool> down(4);
+        auto t = clock::now();
+        for (size_t i = 0; i < event_count; i++) {
+            const size_t k = i % 4;
+            t += std::chrono::milliseconds(7);
+            down[k] = !down[k];
+            events[i] = {static_cast<int>(68 + k), static_cast<bool>(down[k]), 0, t};
+        }
+    }
+
+    for (size_t max_batch : {size_t{1}, size_t{64}}) {
+        metrics::registry reg;
+        event_pipeline pipe(max_batch, reg);
+        auto& debounce = pipe.add_transform("debounce", std::make_unique<debounce_stage>());
+        pipe.add_transform("remap", std::make_unique<remap_stage>());
+        debounce.filter().set_mode(kps::debounce_mode::eager);
+        debounce.filter().set_interval(std::chrono::milliseconds(5));
+        size_t sum = 0;
+        for (const char* name : {"calculator", "statistics", "key_edges"})
+            pipe.add_sink(name, [&sum](std::span<const key_event> batch) {
+                for (const auto& e : batch)
+                    sum += static_cast<size_t>(e.key);
+            });
+
+        const auto label = std::format("2 stages, 3 sinks, batches of {}", max_batch);
+        const double ns = orange::bench::measure(label.c_str(), 200, [&] {
+            debounce.filter().reset(); // 每轮重放同一组时间。
+            if (max_batch == 1)
+                for (const auto& e : events)
+                    pipe.push({&e, 1});
+            else
+                pipe.push(events);
+            orange::bench::do_not_optimize(sum);
+        });
+        std::printf("  %-40s %14.2f ns/event\n", "", ns / static_cast<double>(event_count));
+        for (const auto& r : pipe.report())
+            std::printf("    %-38s %14.2f ns/event\n", r.name.c_str(),
+                        r.seconds * 1e9 / static_cast<double>(r.events ? r.events : 1));
+    }
+}
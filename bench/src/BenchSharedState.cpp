@@ -0,0 +1,62 @@
+/**
+ * @file BenchSharedState.cpp
+ * @author UnnamedOrange
+ * @brief Benchmark reading the shared-memory state while a writer publishes.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+#include "Bench.hpp"
+
+#include <broadcast/shared_state.hpp>
+
+using namespace broadcast;
+
+ORANGE_BENCH(BenchSharedState) {
+    auto memory = std::make_unique<std::uint64_t[]>(sizeof(shared_segment) / 8 + 1);
+    shared_state_writer writer(memory.get());
+    shared_state_reader reader(memory.get(), sizeof(shared_segment));
+    writer.state().button_count = 4;
+    writer.publish(0);
+
+    auto read = [&] {
+        auto snapshot = reader.read();
+        orange::bench::do_not_optimize(snapshot ? snapshot->frame : 0);
+    };
+    auto report = [](double ns) { std::printf("  %-40s %14.0f reads/s\n", "", 1e9 / ns); };
+
+    report(orange::bench::measure("read, idle writer", 200000, read, sizeof(shared_snapshot)));
+
+    // 写者以绘图线程的频率发布。
+    std::atomic<bool> stop{};
+    std::thread paced([&] {
+        using namespace std::chrono_literals;
+        while (!stop.load(std::memory_order_relaxed)) {
+            writer.publish(0);
+            std::this_thread::sleep_for(7ms);
+        }
+    });
+    report(orange::bench::measure("read, writer at 144 Hz", 200000, read, sizeof(shared_snapshot)));
+    stop = true;
+    paced.join();
+
+    // 写者不停地发布，读者经常与写入重叠而重试。
+    stop = false;
+    std::thread busy([&] {
+        while (!stop.load(std::memory_order_relaxed))
+            writer.publish(0);
+    });
+    report(orange::bench::measure("read, writer never idle", 200000, read, sizeof(shared_snapshot)));
+    stop = true;
+    busy.join();
+}
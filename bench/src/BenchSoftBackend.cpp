@@ -0,0 +1,62 @@
+/**
+ * @file BenchSoftBackend.cpp
+ * @author UnnamedOrange
+ * @brief Benchmark replaying a frame with the software rasterizer.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Bench.hpp"
+#include "SampleFrame.hpp"
+
+#include <overlay/frame_builder.hpp>
+#include <overlay/freetype_font.hpp>
+#include <overlay/soft_backend.hpp>
+
+using namespace overlay;
+
+ORANGE_BENCH(BenchSoftBackend) {
+    const std::filesystem::path font_path = std::filesystem::path(OSU_KPS_REPOSITORY_ROOT) / "resources" /
+                                            "exo2-regular.otf";
+    // 宽 3840 像素的一帧，图中约有 3800 个像素列。
+    for (size_t width : {232u, 3840u}) {
+        orange::test::sample_frame sample;
+        auto& input = sample.input;
+        input.width = static_cast<double>(width);
+        input.kps_now = 9;
+        input.max_kps = 15;
+        input.total_count = 12345;
+        input.history_first_second = 1000;
+        input.history_generation = 1;
+        frame_builder builder;
+        display_list list;
+        builder.build(input, list);
+
+        rgba_image image(width, 184);
+        soft_backend backend;
+        backend.device.target = &image;
+        std::vector<std::unique_ptr<freetype_font>> fonts;
+        for (size_t i = 0; i < text_style_count; i++) {
+            fonts.push_back(std::make_unique<freetype_font>(font_path, text_style_sizes[i]));
+            backend.device.fonts[i] = fonts.back().get();
+        }
+
+        auto label = std::format("replay {}x184", width);
+        orange::bench::measure(
+            label.c_str(), 500,
+            [&] {
+                backend.replay(list);
+                orange::bench::do_not_optimize(image.pixels()[image.pixels().size() / 2]);
+            },
+            image.pixels().size_bytes());
+    }
+}
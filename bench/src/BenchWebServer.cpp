@@ -0,0 +1,159 @@
+/**
+ * @file BenchWebServer.cpp
+ * @author UnnamedOrange
+ * @brief Benchmark batch encoding and `broadcast::web_server` throughput with 50 local WebSocket clients.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Bench.hpp"
+
+#include <broadcast/web_server.hpp>
+
+using namespace broadcast;
+
+namespace {
+    struct sample_source {
+        std::array<double, 300> history{};
+        long long first_second = 1000;
+
+        void fill(live_state& state) {
+            state.button_count = 4;
+            for (size_t i = 0; i < 4; i++)
+                state.columns[i] = {static_cast<double>(i) + 0.5, static_cast<int>(i) * 100, i % 2 == 0};
+            state.total_count = 12345;
+            state.max_kps = 23.5;
+            state.kps_now = 11.25;
+            state.history = history;
+            state.history_first_second = first_second;
+            state.history_generation = 1;
+        }
+    };
+
+    /**
+     * @brief Blocking test client: connect, upgrade, then count received frames.
+     */
+    struct test_client {
+        SOCKET socket{INVALID_SOCKET};
+        std::vector<std::byte> buffer;
+        std::uint64_t frames{};
+        std::uint64_t bytes{};
+
+        bool connect_to(std::uint16_t port, bool edges) {
+            socket = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(port);
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            if (connect(socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)))
+                return false;
+            const std::string request = std::string("GET ") + (edges ? "/?edges=1" : "/") +
+                                        " HTTP/1.1\r\nHost: 127.0.0.1\r\nUpgrade: websocket\r\n"
+                                        "Connection: Upgrade\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                                        "Sec-WebSocket-Version: 13\r\n\r\n";
+            send(socket, request.data(), static_cast<int>(request.size()), 0);
+            std::string response;
+            char c;
+            while (response.find("\r\n\r\n") == std::string::npos && recv(socket, &c, 1, 0) == 1)
+                response.push_back(c);
+            u_long non_blocking = 1;
+            ioctlsocket(socket, FIONBIO, &non_blocking);
+            return response.starts_with("HTTP/1.1 101");
+        }
+        /**
+         * @brief Read whatever has arrived and count the complete frames in it.
+         */
+        void drain() {
+            std::array<char, 64 * 1024> chunk;
+            int n;
+            while ((n = recv(socket, chunk.data(), static_cast<int>(chunk.size()), 0)) > 0) {
+                const auto* begin = reinterpret_cast<const std::byte*>(chunk.data());
+                buffer.insert(buffer.end(), begin, begin + n);
+                bytes += static_cast<std::uint64_t>(n);
+            }
+            size_t offset = 0;
+            while (true) {
+                auto header = websocket::parse_frame_header(std::span(buffer).subspan(offset));
+                if (!header || buffer.size() - offset - header->header_size < header->payload_size)
+                    break;
+                offset += header->header_size + static_cast<size_t>(header->payload_size);
+                frames++;
+            }
+            buffer.erase(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(offset));
+        }
+    };
+} // namespace
+
+ORANGE_BENCH(BenchWebServer) {
+    sample_source source;
+    for (size_t i = 0; i < source.history.size(); i++)
+        source.history[i] = static_cast<double>((i * 7) % 23);
+
+    // 编码一批：关键帧与只含最后一个值的增量。
+    {
+        json_encoder encoder;
+        live_state state;
+        source.fill(state);
+        orange::bench::measure("encode keyframe", 20000, [&] {
+            encoder.request_keyframe();
+            orange::bench::do_not_optimize(encoder.encode(state).size());
+        });
+        orange::bench::measure("encode delta", 200000,
+                               [&] { orange::bench::do_not_optimize(encoder.encode(state).size()); });
+        std::vector<key_edge> edges(8, key_edge{68, true, 123456789});
+        orange::bench::measure("add 8 key edges", 200000,
+                               [&] { orange::bench::do_not_optimize(encoder.with_edges(edges).size()); });
+    }
+
+    // 50 个客户端，服务器每秒发送 rate 批，统计客户端实际收到的帧数。
+    constexpr size_t client_count = 50;
+    for (unsigned rate : {60u, 1000u}) {
+        key_edge_queue edges;
+        web_server server(0, rate, [&](live_state& state) { source.fill(state); }, &edges);
+        std::vector<test_client> clients(client_count);
+        for (size_t i = 0; i < client_count; i++)
+            if (!clients[i].connect_to(server.port(), i % 2 == 0)) {
+                std::printf("  fail to connect.\n");
+                return;
+            }
+        while (server.client_count() < client_count)
+            std::this_thread::yield();
+
+        using clock = std::chrono::steady_clock;
+        const auto duration = std::chrono::seconds(2);
+        const auto start = clock::now();
+        const auto batches_before = server.batch_count();
+        while (clock::now() - start < duration) {
+            edges.push({68, true, 0});
+            for (auto& c : clients)
+                c.drain();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        const double seconds = std::chrono::duration<double>(clock::now() - start).count();
+        std::uint64_t frames = 0, bytes = 0;
+        for (auto& c : clients) {
+            c.drain();
+            frames += c.frames;
+            bytes += c.bytes;
+            closesocket(c.socket);
+        }
+        std::printf("  %-40s %14.0f frames/s %8.2f MB/s %6.0f batches/s %llu dropped\n",
+                    (std::to_string(rate) + " Hz, 50 clients").c_str(), static_cast<double>(frames) / seconds,
+                    static_cast<double>(bytes) / seconds / 1e6,
+                    static_cast<double>(server.batch_count() - batches_before) / seconds,
+                    static_cast<unsigned long long>(server.dropped_count()));
+    }
+}
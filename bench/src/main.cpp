@@ -0,0 +1,26 @@
+/**
+ * @file main.cpp
+ * @author UnnamedOrange
+ * @brief Run registered benchmarks. An optional argument filters them by name.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <cstdio>
+#include <string_view>
+
+#include "Bench.hpp"
+
+int main(int argc, char** argv) {
+    std::string_view filter = argc > 1 ? argv[1] : "";
+    for (const auto& bench_case : orange::bench::registry()) {
+        if (std::string_view(bench_case.name).find(filter) == std::string_view::npos)
+            continue;
+        std::printf("%s\n", bench_case.name);
+        bench_case.function();
+    }
+    return 0;
+}
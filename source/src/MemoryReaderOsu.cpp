@@ -3,8 +3,12 @@
 
 #include "MemoryReaderOsu.h"
 
+#include <chrono>
 #include <ranges>
 #include <span>
+#include <type_traits>
+
+#include "utils/ProcessSignatureScanner.h"
 
 using namespace orange;
 using namespace orange::memory_reader;
@@ -20,8 +24,16 @@ using VOffsets = ValueOffsets<PtrWidth::IS_32, T, R...>;
 struct Self::Hub final {
     SingleProcessDaemon process{"osu!.exe"};
 
-    Signature<"7D 15 A1 ?? ?? ?? ?? 85 C0"> //
-        sig_rulesets;
+    // The address type expected by the offsets below.
+    using Address = std::remove_cvref_t<decltype(*std::declval<Signature<"7D 15 A1 ?? ?? ?? ?? 85 C0">&>().scan(
+        std::declval<SingleProcessDaemon&>()))>;
+
+    // Scanned once per process and cached, instead of scanning on every read.
+    const SignaturePattern sig_rulesets{"7D 15 A1 ?? ?? ?? ?? 85 C0"};
+    ProcessSignatureScanner scanner;
+    std::optional<Address> rulesets;
+    std::chrono::steady_clock::time_point next_scan{};
+    static constexpr auto rescan_interval = std::chrono::seconds(1);
 
     // General C# array size.
     VOffsets<std::uint32_t, 0xC> //
@@ -46,14 +58,64 @@ struct Self::Hub final {
 Self::MemoryReaderOsu() noexcept : pimpl{std::make_unique<Hub>()} {}
 Self::~MemoryReaderOsu() = default; // Required for pimpl.
 
-std::optional<std::vector<std::pair<int, bool>>> Self::get_mania_keys() noexcept {
-    const auto rulesets = pimpl->sig_rulesets.scan(pimpl->process);
-    if (!rulesets) {
+bool Self::scan_rulesets() noexcept {
+    auto& hub = *pimpl;
+    if (hub.rulesets) {
+        return true;
+    }
+
+    // Do not rescan the whole process on every poll while osu! is absent or loading.
+    const auto now = std::chrono::steady_clock::now();
+    if (now < hub.next_scan) {
+        return false;
+    }
+    hub.next_scan = now + Hub::rescan_interval;
+
+    try {
+        if (hub.scanner.exited()) {
+            hub.scanner = ProcessSignatureScanner::try_open(L"osu!.exe");
+        }
+        const auto address = hub.scanner.scan(hub.sig_rulesets);
+        if (!address) {
+            return false;
+        }
+        hub.rulesets = static_cast<Hub::Address>(*address);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+bool Self::invalidate_rulesets() noexcept {
+    auto& hub = *pimpl;
+    if (!hub.rulesets) {
+        return false;
+    }
+    // Reads also fail when osu! is simply not in a mania play,
+    // so only drop the cache when the signature itself is gone.
+    try {
+        if (hub.scanner.verify(hub.sig_rulesets, static_cast<std::uintptr_t>(*hub.rulesets))) {
+            return false;
+        }
+    } catch (...) {
+    }
+    hub.rulesets.reset();
+    hub.next_scan = {};
+    return true;
+}
+
+std::optional<std::vector<std::pair<int, bool>>> Self::get_mania_keys(ReadStatus& status) noexcept {
+    // Until the keys array is found, a miss means osu! is simply not in a mania play.
+    status = ReadStatus::not_in_play;
+    if (!scan_rulesets()) {
         return std::nullopt;
     }
+    const auto rulesets = pimpl->rulesets;
 
     const auto array_object_base = pimpl->offsets_mania_keys_array_object.read(pimpl->process, *rulesets);
     if (!array_object_base) {
+        if (invalidate_rulesets()) {
+            status = ReadStatus::failed;
+        }
         return std::nullopt;
     }
 
@@ -62,8 +124,9 @@ std::optional<std::vector<std::pair<int, bool>>> Self::get_mania_keys() noexcept
         return std::nullopt;
     }
 
+    status = ReadStatus::failed;
     const auto array_base = pimpl->offsets_array_base.read(pimpl->process, *array_object_base);
-    if (!array_object_base) {
+    if (!array_base) {
         return std::nullopt;
     }
 
@@ -84,12 +147,17 @@ std::optional<std::vector<std::pair<int, bool>>> Self::get_mania_keys() noexcept
             return std::nullopt;
         ret.emplace_back(*key_code, *is_key_down);
     }
+    status = ReadStatus::ok;
     return ret;
 }
 std::optional<bool> Self::get_is_autoplay() noexcept {
-    const auto rulesets = pimpl->sig_rulesets.scan(pimpl->process);
-    if (!rulesets) {
+    if (!scan_rulesets()) {
         return std::nullopt;
     }
-    return pimpl->offsets_mania_is_autoplay.read(pimpl->process, *rulesets);
+    const auto rulesets = pimpl->rulesets;
+    auto ret = pimpl->offsets_mania_is_autoplay.read(pimpl->process, *rulesets);
+    if (!ret) {
+        invalidate_rulesets();
+    }
+    return ret;
 }
@@ -5,7 +5,9 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <utility>
+#include <vector>
 
 #include <memory-reader/all.h>
 
@@ -13,6 +15,16 @@ namespace orange {
     class MemoryReaderOsu final {
         struct Hub;
 
+    public:
+        /**
+         * @brief Why get_mania_keys returned or did not return the keys.
+         */
+        enum class ReadStatus {
+            ok,
+            not_in_play, // osu! is not running, or is not in an osu!mania play.
+            failed,      // The keys were there but could not be read, e.g. they were freed during the read.
+        };
+
     private:
         std::unique_ptr<Hub> pimpl;
 
@@ -20,8 +32,25 @@ namespace orange {
         MemoryReaderOsu() noexcept;
         ~MemoryReaderOsu();
 
+    private:
+        /**
+         * @brief Make sure the address of the rulesets signature is cached, scanning for it if needed.
+         *
+         * @return Whether the address is available.
+         */
+        bool scan_rulesets() noexcept;
+        /**
+         * @brief Drop the cached address if the signature no longer matches there.
+         *
+         * @return Whether the address was dropped.
+         */
+        bool invalidate_rulesets() noexcept;
+
     public:
-        std::optional<std::vector<std::pair<int, bool>>> get_mania_keys() noexcept;
+        /**
+         * @param status Set to why no keys are returned, or to ok.
+         */
+        std::optional<std::vector<std::pair<int, bool>>> get_mania_keys(ReadStatus& status) noexcept;
         std::optional<bool> get_is_autoplay() noexcept;
     };
 } // namespace orange
@@ -0,0 +1,53 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace broadcast {
+    /// <summary>
+    /// 记录上一次发出的历史记录，计算下一次需要发出的部分。
+    /// 同一 generation 内平移 k 秒时，只有最后 k + 1 个值可能不同，见 kps::kps_calculator::calc_kps_recent_stamped。
+    /// </summary>
+    class history_delta {
+    private:
+        bool keyframe_requested{true};
+        long long sent_first_second{};
+        std::uint64_t sent_generation{};
+        size_t sent_size{};
+
+    public:
+        /// <summary>
+        /// 要求下一次发出完整的历史记录。
+        /// </summary>
+        void request_keyframe() {
+            keyframe_requested = true;
+        }
+        /// <summary>
+        /// 计算本次需要发出的个数，并记为已发出。
+        /// </summary>
+        /// <param name="size">历史记录的个数。</param>
+        /// <param name="first_second">第一个值对应的秒数。</param>
+        /// <param name="generation">数据的代数。为 0 时总是发出完整的历史记录。</param>
+        /// <param name="keyframe">是否需要发出完整的历史记录。</param>
+        /// <returns>需要发出的个数，即最后若干个值。</returns>
+        size_t next(size_t size, long long first_second, std::uint64_t generation, bool& keyframe) {
+            size_t ret = size;
+            keyframe = keyframe_requested || !generation || generation != sent_generation || size != sent_size;
+            if (!keyframe) {
+                const long long k = first_second - sent_first_second;
+                if (k < 0 || k >= static_cast<long long>(size))
+                    keyframe = true;
+                else
+                    ret = static_cast<size_t>(k) + 1;
+            }
+            keyframe_requested = false;
+            sent_first_second = first_second;
+            sent_generation = generation;
+            sent_size = size;
+            return ret;
+        }
+    };
+} // namespace broadcast
@@ -0,0 +1,89 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <cstdint>
+#include <format>
+#include <iterator>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "history_delta.hpp"
+#include "key_edges.hpp"
+#include "state_frame.hpp"
+
+/*
+发给浏览器的 JSON 消息，每批一条：
+{"seq":12,"autoplay":false,"total":123,"max":12.5,"kps":8,
+ "columns":[{"kps":5,"times":12,"down":true},...],
+ "history":{"first":1000,"reset":false,"values":[3,4]},
+ "edges":[{"key":68,"down":true,"t":123456789},...]}
+history.values 为完整历史记录的最后若干个值，first 为完整历史记录第一个值对应的秒数。
+reset 为 false 时，接收方先将已有的历史记录按 first 的变化向前平移，再用 values 覆盖末尾。
+edges 只发给请求了按键边沿的客户端，t 为 std::chrono::steady_clock 纪元起的微秒数。
+*/
+
+namespace broadcast {
+    /// <summary>
+    /// 将每一批的状态编码为 JSON。同一批的两种消息（是否带按键边沿）共享除 edges 外的部分。
+    /// </summary>
+    class json_encoder {
+    private:
+        std::string text;
+        std::string text_with_edges;
+        std::uint64_t sequence{};
+        history_delta history;
+
+    public:
+        /// <summary>
+        /// 要求下一批携带完整的历史记录。有新的客户端时调用。
+        /// </summary>
+        void request_keyframe() {
+            history.request_keyframe();
+        }
+
+    public:
+        /// <summary>
+        /// 编码一批，不含按键边沿。返回的数据在下一次调用 encode 前有效。
+        /// </summary>
+        std::string_view encode(const live_state& state) {
+            auto out = std::back_inserter(text);
+            text.clear();
+            std::format_to(out, R"({{"seq":{},"autoplay":{},"total":{},"max":{},"kps":{},"columns":[)", ++sequence,
+                           state.is_autoplay, state.total_count, static_cast<float>(state.max_kps),
+                           static_cast<float>(state.kps_now));
+            for (size_t i = 0; i < state.button_count; i++) {
+                const auto& col = state.columns[i];
+                std::format_to(out, R"({}{{"kps":{},"times":{},"down":{}}})", i ? "," : "", static_cast<float>(col.kps),
+                               col.times, col.down);
+            }
+            bool keyframe;
+            const size_t m =
+                history.next(state.history.size(), state.history_first_second, state.history_generation, keyframe);
+            std::format_to(out, R"(],"history":{{"first":{},"reset":{},"values":[)", state.history_first_second,
+                           keyframe);
+            bool first = true;
+            for (double v : state.history.last(m)) {
+                std::format_to(out, "{}{}", first ? "" : ",", static_cast<float>(v));
+                first = false;
+            }
+            text += "]}}";
+            return text;
+        }
+        /// <summary>
+        /// 在上一次 encode 的结果中加入按键边沿。返回的数据在下一次调用 encode 前有效。
+        /// </summary>
+        std::string_view with_edges(std::span<const key_edge> edges) {
+            text_with_edges.assign(text, 0, text.size() - 1);
+            text_with_edges += R"(,"edges":[)";
+            auto out = std::back_inserter(text_with_edges);
+            for (size_t i = 0; i < edges.size(); i++)
+                std::format_to(out, R"({}{{"key":{},"down":{},"t":{}}})", i ? "," : "", edges[i].key, edges[i].down,
+                               edges[i].time_us);
+            text_with_edges += "]}";
+            return text_with_edges;
+        }
+    };
+} // namespace broadcast
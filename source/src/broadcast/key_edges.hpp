@@ -0,0 +1,69 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace broadcast {
+    /// <summary>
+    /// 一次按下或放开。
+    /// </summary>
+    struct key_edge {
+        int key{};
+        bool down{};
+        std::int64_t time_us{}; // std::chrono::steady_clock 纪元起的微秒数。
+    };
+
+    /// <summary>
+    /// 监视器线程写入、广播线程成批取走的按键边沿。只在有人需要时记录。
+    /// </summary>
+    class key_edge_queue {
+    public:
+        static constexpr size_t capacity = 4096; // 取走之前最多保留的个数，超出的部分被丢弃。
+
+    private:
+        std::atomic<bool> enabled{};
+        std::mutex m;
+        std::vector<key_edge> pending;
+
+    public:
+        key_edge_queue() {
+            pending.reserve(capacity);
+        }
+
+    public:
+        /// <summary>
+        /// 是否记录。不记录时 push 几乎没有开销。
+        /// </summary>
+        void enable(bool whether) {
+            enabled.store(whether, std::memory_order_relaxed);
+        }
+        bool is_enabled() const {
+            return enabled.load(std::memory_order_relaxed);
+        }
+        /// <summary>
+        /// 记录一个边沿。可以在任意线程调用。
+        /// </summary>
+        void push(const key_edge& edge) {
+            if (!enabled.load(std::memory_order_relaxed))
+                return;
+            std::lock_guard _(m);
+            if (pending.size() < capacity)
+                pending.push_back(edge);
+        }
+        /// <summary>
+        /// 取走所有边沿。out 被清空后与内部的缓冲区交换，反复使用同一个 out 不会分配内存。
+        /// </summary>
+        void take(std::vector<key_edge>& out) {
+            out.clear();
+            out.reserve(capacity);
+            std::lock_guard _(m);
+            pending.swap(out);
+        }
+    };
+} // namespace broadcast
@@ -0,0 +1,177 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <span>
+#include <stdexcept>
+
+#include "../utils/SeqLock.hpp"
+#include "history_delta.hpp"
+
+/*
+共享内存的布局。所有数值均为小端序。
+偏移  大小  内容
+0     4     magic，"OKSM"。写者初始化完成后才写入。
+4     4     version，当前为 1。
+8     4     size，整个共享内存的字节数。
+12    4     snapshot_size，sizeof(shared_snapshot)。
+16    8     sequence，为奇数时正在写入。
+24    ...   shared_snapshot，按 8 字节一组原子地写入。
+读者读取 sequence，再复制 shared_snapshot，最后再次读取 sequence；两次相同且为偶数时副本有效，否则重试。
+*/
+
+namespace broadcast {
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "atomics in shared memory must be lock-free.");
+
+    inline constexpr size_t shared_column_count = 16;
+    inline constexpr size_t shared_history_capacity = 300; // 与 kps::history_count 相同。
+
+    /// <summary>
+    /// 共享内存中发布的状态。时刻均为 std::chrono::steady_clock 纪元起的微秒数，在同一台机器的各进程间一致。
+    /// </summary>
+    struct shared_snapshot {
+        struct column {
+            double kps{};
+            std::int64_t previous_down_us{};
+            std::int64_t previous_up_us{};
+            std::int32_t times{};
+            std::uint8_t down{};
+            std::uint8_t reserved[3]{};
+        };
+
+        std::uint64_t frame{};  // 发布的次数。
+        std::int64_t time_us{}; // 发布的时刻。
+        std::int32_t button_count{};
+        std::int32_t total_count{};
+        std::uint8_t is_autoplay{};
+        std::uint8_t reserved[7]{};
+        double max_kps{};
+        double kps_now{};
+        std::int64_t history_first_second{}; // 最早的有效历史记录对应的秒数。
+        std::uint32_t history_count{};       // 有效历史记录的个数。
+        std::uint32_t reserved2{};
+        std::array<column, shared_column_count> columns{};
+        std::array<float, shared_history_capacity> history{}; // 环形缓冲区，第 s 秒的值位于 history[slot(s)]。
+
+        static size_t slot(long long second) {
+            constexpr auto n = static_cast<long long>(shared_history_capacity);
+            return static_cast<size_t>((second % n + n) % n);
+        }
+        /// <returns>第 second 秒的 KPS。不在有效范围内时为 0。</returns>
+        float history_at(long long second) const {
+            if (second < history_first_second || second >= history_first_second + history_count)
+                return 0;
+            return history[slot(second)];
+        }
+    };
+    static_assert(sizeof(shared_snapshot::column) == 32);
+
+    struct shared_segment {
+        static constexpr std::uint32_t magic_value = 0x4D534B4F; // "OKSM"
+        static constexpr std::uint32_t version_value = 1;
+
+        std::atomic<std::uint32_t> magic{};
+        std::uint32_t version{};
+        std::uint32_t size{};
+        std::uint32_t snapshot_size{};
+        orange::SeqLock<shared_snapshot> state;
+    };
+
+    /// <summary>
+    /// 共享内存的写者。只允许一个线程写入。
+    /// </summary>
+    class shared_state_writer {
+    private:
+        shared_segment* segment;
+        shared_snapshot staging;
+        history_delta history;
+
+    public:
+        /// <param name="memory">至少 sizeof(shared_segment) 字节、按 8 字节对齐的内存。</param>
+        explicit shared_state_writer(void* memory) : segment(new (memory) shared_segment) {
+            segment->version = shared_segment::version_value;
+            segment->size = sizeof(shared_segment);
+            segment->snapshot_size = sizeof(shared_snapshot);
+            segment->magic.store(shared_segment::magic_value, std::memory_order_release);
+        }
+
+    public:
+        /// <summary>
+        /// 下一次发布的状态。除历史记录外由调用者直接修改。
+        /// </summary>
+        shared_snapshot& state() {
+            return staging;
+        }
+        /// <summary>
+        /// 更新历史记录。同一 generation 内只写入可能变化的值，见 kps::kps_calculator::calc_kps_recent_stamped。
+        /// </summary>
+        /// <param name="values">最近的历史记录，values[0] 对应 first_second。</param>
+        /// <param name="generation">数据的代数。为 0 时总是全部写入。</param>
+        void set_history(std::span<const double> values, long long first_second, std::uint64_t generation) {
+            if (values.size() > shared_history_capacity) {
+                first_second += static_cast<long long>(values.size() - shared_history_capacity);
+                values = values.last(shared_history_capacity);
+            }
+            const size_t n = values.size();
+            bool keyframe;
+            const size_t begin = n - history.next(n, first_second, generation, keyframe);
+            for (size_t i = begin; i < n; i++)
+                staging.history[shared_snapshot::slot(first_second + static_cast<long long>(i))] =
+                    static_cast<float>(values[i]);
+            staging.history_first_second = first_second;
+            staging.history_count = static_cast<std::uint32_t>(n);
+        }
+        /// <summary>
+        /// 将 state 发布给读者。
+        /// </summary>
+        /// <param name="time_us">发布的时刻。</param>
+        void publish(std::int64_t time_us) {
+            staging.frame++;
+            staging.time_us = time_us;
+            segment->state.store(staging);
+        }
+    };
+
+    /// <summary>
+    /// 共享内存的读者。可以在任意进程、任意线程以任意频率读取，不会影响写者。
+    /// </summary>
+    class shared_state_reader {
+    private:
+        const shared_segment* segment;
+
+    public:
+        /// <param name="memory">写者初始化过的内存。</param>
+        /// <param name="size">memory 的字节数。</param>
+        shared_state_reader(const void* memory, size_t size) : segment(static_cast<const shared_segment*>(memory)) {
+            if (size < sizeof(shared_segment))
+                throw std::runtime_error("shared memory is too small.");
+            if (segment->magic.load(std::memory_order_acquire) != shared_segment::magic_value)
+                throw std::runtime_error("shared memory is not initialized.");
+            if (segment->version != shared_segment::version_value || segment->size != sizeof(shared_segment) ||
+                segment->snapshot_size != sizeof(shared_snapshot))
+                throw std::runtime_error("shared memory version mismatch.");
+        }
+
+    public:
+        /// <summary>
+        /// 读取一致的副本。写者在写入过程中退出时，读取会失败而不会一直等待。
+        /// </summary>
+        /// <param name="attempts">与写入重叠时的最多尝试次数。</param>
+        std::optional<shared_snapshot> read(size_t attempts = 1024) const {
+            return segment->state.try_load(attempts);
+        }
+        /// <summary>
+        /// 状态的版本。版本不变时无需再次读取。
+        /// </summary>
+        std::uint64_t version() const {
+            return segment->state.version();
+        }
+    };
+} // namespace broadcast
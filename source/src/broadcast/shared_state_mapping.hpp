@@ -0,0 +1,93 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <stdexcept>
+
+#include <Windows.h>
+#undef min
+#undef max
+
+#include "shared_state.hpp"
+
+namespace broadcast {
+    /// <summary>
+    /// 共享内存的名称。其他程序用 OpenFileMappingW 打开。
+    /// </summary>
+    inline constexpr const wchar_t* shared_state_name = L"Local\\osu-kps-state";
+
+    /// <summary>
+    /// 命名的共享内存映射。
+    /// </summary>
+    class shared_memory_view {
+    private:
+        HANDLE mapping{};
+        void* view{};
+
+    public:
+        /// <param name="create">为真时创建共享内存，否则打开已有的共享内存。</param>
+        shared_memory_view(const wchar_t* name, size_t size, bool create) {
+            if (create)
+                mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0,
+                                             static_cast<DWORD>(size), name);
+            else
+                mapping = OpenFileMappingW(FILE_MAP_READ, FALSE, name);
+            if (!mapping)
+                throw std::runtime_error("fail to open file mapping.");
+            view = MapViewOfFile(mapping, create ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+            if (!view) {
+                CloseHandle(mapping);
+                throw std::runtime_error("fail to map view of file.");
+            }
+        }
+        shared_memory_view(const shared_memory_view&) = delete;
+        shared_memory_view& operator=(const shared_memory_view&) = delete;
+        ~shared_memory_view() {
+            UnmapViewOfFile(view);
+            CloseHandle(mapping);
+        }
+
+    public:
+        void* data() const {
+            return view;
+        }
+    };
+
+    /// <summary>
+    /// 创建共享内存并在其中发布状态。
+    /// </summary>
+    class shared_state_host {
+    private:
+        shared_memory_view memory;
+        shared_state_writer state_writer;
+
+    public:
+        explicit shared_state_host(const wchar_t* name = shared_state_name)
+            : memory(name, sizeof(shared_segment), true), state_writer(memory.data()) {}
+
+    public:
+        shared_state_writer& writer() {
+            return state_writer;
+        }
+    };
+
+    /// <summary>
+    /// 打开共享内存并读取状态。供其他程序使用。
+    /// osu!kps 未运行或未开启共享内存时，构造会抛出 std::runtime_error。
+    /// </summary>
+    class shared_state_client {
+    private:
+        shared_memory_view memory;
+        shared_state_reader state_reader;
+
+    public:
+        explicit shared_state_client(const wchar_t* name = shared_state_name)
+            : memory(name, sizeof(shared_segment), false), state_reader(memory.data(), sizeof(shared_segment)) {}
+
+    public:
+        const shared_state_reader& reader() const {
+            return state_reader;
+        }
+    };
+} // namespace broadcast
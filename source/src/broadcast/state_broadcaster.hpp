@@ -0,0 +1,167 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+#undef min
+#undef max
+#pragma comment(lib, "Ws2_32.lib")
+
+namespace broadcast {
+    /// <summary>
+    /// 通过本机回环 TCP 将编码好的帧广播给所有订阅者。只监听 127.0.0.1。
+    /// 所有操作都是非阻塞的，只允许在同一线程调用。
+    /// 订阅者在下一帧到来时仍未收完上一帧，就会被断开，不会阻塞广播方。
+    /// </summary>
+    class state_broadcaster {
+    public:
+        static constexpr int send_buffer_size = 64 * 1024; // 每个订阅者的发送缓冲区大小。
+
+    private:
+        struct subscriber {
+            SOCKET socket{INVALID_SOCKET};
+            std::vector<std::byte> pending; // 上一帧未能发出的部分。通常为空。
+        };
+        bool wsa_started{};
+        SOCKET listener{INVALID_SOCKET};
+        std::vector<subscriber> subscribers;
+        std::uint64_t dropped{};
+
+    public:
+        state_broadcaster() {
+            WSADATA data;
+            if (WSAStartup(MAKEWORD(2, 2), &data))
+                throw std::runtime_error("fail to WSAStartup.");
+            wsa_started = true;
+        }
+        state_broadcaster(const state_broadcaster&) = delete;
+        state_broadcaster& operator=(const state_broadcaster&) = delete;
+        ~state_broadcaster() {
+            stop();
+            if (wsa_started)
+                WSACleanup();
+        }
+
+    public:
+        /// <summary>
+        /// 开始在 127.0.0.1:port 上监听。已经在监听时先停止。
+        /// </summary>
+        /// <returns>是否成功。端口被占用时失败。</returns>
+        bool start(std::uint16_t port) {
+            stop();
+            SOCKET s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+            if (s == INVALID_SOCKET)
+                return false;
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(port);
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            u_long non_blocking = 1;
+            if (bind(s, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) ||
+                listen(s, SOMAXCONN) || ioctlsocket(s, FIONBIO, &non_blocking)) {
+                closesocket(s);
+                return false;
+            }
+            listener = s;
+            return true;
+        }
+        /// <summary>
+        /// 停止监听并断开所有订阅者。
+        /// </summary>
+        void stop() {
+            for (auto& sub : subscribers)
+                closesocket(sub.socket);
+            subscribers.clear();
+            if (listener != INVALID_SOCKET) {
+                closesocket(listener);
+                listener = INVALID_SOCKET;
+            }
+        }
+        bool listening() const {
+            return listener != INVALID_SOCKET;
+        }
+        size_t subscriber_count() const {
+            return subscribers.size();
+        }
+        /// <returns>因接收过慢或连接断开而被断开的订阅者总数。</returns>
+        std::uint64_t dropped_count() const {
+            return dropped;
+        }
+
+    public:
+        /// <summary>
+        /// 接受所有等待中的连接。
+        /// </summary>
+        /// <returns>新订阅者的个数。不为 0 时，下一帧应为关键帧。</returns>
+        size_t accept_pending() {
+            if (!listening())
+                return 0;
+            size_t ret = 0;
+            SOCKET s;
+            while ((s = accept(listener, nullptr, nullptr)) != INVALID_SOCKET) {
+                u_long non_blocking = 1;
+                BOOL no_delay = TRUE;
+                int buffer_size = send_buffer_size;
+                if (ioctlsocket(s, FIONBIO, &non_blocking) ||
+                    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&no_delay),
+                               sizeof(no_delay)) ||
+                    setsockopt(s, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&buffer_size),
+                               sizeof(buffer_size))) {
+                    closesocket(s);
+                    continue;
+                }
+                shutdown(s, SD_RECEIVE); // 不接收订阅者的任何数据。
+                subscribers.push_back({s, {}});
+                ret++;
+            }
+            return ret;
+        }
+        /// <summary>
+        /// 将同一帧发送给所有订阅者。仍未发完上一帧的订阅者会被断开。
+        /// </summary>
+        void publish(std::span<const std::byte> frame) {
+            std::erase_if(subscribers, [&](subscriber& sub) {
+                bool alive = true;
+                if (!sub.pending.empty()) {
+                    auto pending = std::move(sub.pending);
+                    sub.pending.clear();
+                    alive = send_all(sub, pending) && sub.pending.empty();
+                }
+                if (alive)
+                    alive = send_all(sub, frame);
+                if (!alive) {
+                    closesocket(sub.socket);
+                    dropped++;
+                }
+                return !alive;
+            });
+        }
+
+    private:
+        /// <summary>
+        /// 尽可能多地发送 data，发送缓冲区满时将剩余部分复制到 pending。
+        /// </summary>
+        /// <returns>连接是否仍然可用。</returns>
+        static bool send_all(subscriber& sub, std::span<const std::byte> data) {
+            while (!data.empty()) {
+                int sent = send(sub.socket, reinterpret_cast<const char*>(data.data()), static_cast<int>(data.size()), 0);
+                if (sent == SOCKET_ERROR) {
+                    if (WSAGetLastError() != WSAEWOULDBLOCK)
+                        return false;
+                    sub.pending.assign(data.begin(), data.end());
+                    return true;
+                }
+                data = data.subspan(static_cast<size_t>(sent));
+            }
+            return true;
+        }
+    };
+} // namespace broadcast
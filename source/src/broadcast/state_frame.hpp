@@ -0,0 +1,236 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "history_delta.hpp"
+
+/*
+帧格式。所有数值均为小端序，帧之间没有分隔。
+偏移  大小  内容
+0     4     magic，"OKPS"。
+4     1     version，当前为 1。
+5     1     flags。第 0 位：自动播放；第 1 位：history 为完整的历史记录（关键帧）。
+6     1     button_count，列数 n。
+7     1     保留，为 0。
+8     4     size，整个帧的字节数（含头部）。
+12    8     sequence，帧序号，从 1 开始，每帧加一。
+20    4     total_count，int32。
+24    4     max_kps，float。
+28    4     kps_now，float。
+32    2     down_mask，第 i 位表示第 i 列是否按下。
+34    2     history_count，本帧携带的历史记录个数 m。
+36    8     history_first_second，int64，完整历史记录第一个值对应的秒数。
+44    8n    各列的 kps（float）与 times（int32）。
+44+8n 4m    完整历史记录的最后 m 个值（float）。
+非关键帧中，接收方先将已有的历史记录按 history_first_second 的变化向前平移，再用本帧的 m 个值覆盖末尾。
+*/
+
+namespace broadcast {
+    static_assert(std::endian::native == std::endian::little, "frames are encoded in the native byte order.");
+
+    inline constexpr std::uint32_t frame_magic = 0x53504B4F; // "OKPS"
+    inline constexpr std::uint8_t frame_version = 1;
+    inline constexpr size_t frame_header_size = 20;
+    inline constexpr size_t frame_fixed_size = 44; // 头部与固定长度的字段。
+    inline constexpr size_t max_column_count = 16;
+
+    inline constexpr unsigned frame_flag_autoplay = 1u << 0;
+    inline constexpr unsigned frame_flag_keyframe = 1u << 1;
+
+    struct column_state {
+        double kps{};
+        int times{};
+        bool down{};
+    };
+    /// <summary>
+    /// 某一帧要广播的状态。history 只在 encode 期间被引用。
+    /// </summary>
+    struct live_state {
+        size_t button_count{};
+        std::array<column_state, max_column_count> columns{};
+        bool is_autoplay{};
+        int total_count{};
+        double max_kps{};
+        double kps_now{};
+        std::span<const double> history;
+        long long history_first_second{};
+        std::uint64_t history_generation{}; // 代数不同时发送完整的历史记录。为 0 时总是发送完整的历史记录。
+    };
+
+    namespace detail {
+        template <typename T>
+        inline std::byte* put(std::byte* p, T value) {
+            std::memcpy(p, &value, sizeof(T));
+            return p + sizeof(T);
+        }
+        template <typename T>
+        inline T get(const std::byte* p) {
+            T ret;
+            std::memcpy(&ret, p, sizeof(T));
+            return ret;
+        }
+    } // namespace detail
+
+    /// <summary>
+    /// 将每一帧的状态编码为二进制帧。编码结果保存在内部的缓冲区中，所有订阅者共享同一份。
+    /// 历史记录只发送相对上一帧变化的部分，见 request_keyframe。
+    /// </summary>
+    class state_encoder {
+    private:
+        std::vector<std::byte> buffer;
+        std::uint64_t sequence{};
+        history_delta history;
+
+    public:
+        /// <summary>
+        /// 要求下一帧携带完整的历史记录。有新的订阅者时调用。
+        /// </summary>
+        void request_keyframe() {
+            history.request_keyframe();
+        }
+        /// <returns>最后一帧的序号。</returns>
+        std::uint64_t last_sequence() const {
+            return sequence;
+        }
+
+    public:
+        /// <summary>
+        /// 编码一帧。返回的数据在下一次调用 encode 前有效。
+        /// </summary>
+        std::span<const std::byte> encode(const live_state& state) {
+            if (state.button_count > max_column_count)
+                throw std::invalid_argument("too many columns.");
+            if (state.history.size() > 0xFFFF)
+                throw std::invalid_argument("history is too long.");
+            bool keyframe;
+            const size_t m =
+                history.next(state.history.size(), state.history_first_second, state.history_generation, keyframe);
+            const size_t size = frame_fixed_size + 8 * state.button_count + 4 * m;
+            buffer.resize(size);
+
+            unsigned down_mask = 0;
+            for (size_t i = 0; i < state.button_count; i++)
+                if (state.columns[i].down)
+                    down_mask |= 1u << i;
+            const unsigned flags = (state.is_autoplay ? frame_flag_autoplay : 0u) | (keyframe ? frame_flag_keyframe : 0u);
+
+            std::byte* p = buffer.data();
+            p = detail::put(p, frame_magic);
+            p = detail::put(p, frame_version);
+            p = detail::put(p, static_cast<std::uint8_t>(flags));
+            p = detail::put(p, static_cast<std::uint8_t>(state.button_count));
+            p = detail::put(p, std::uint8_t{});
+            p = detail::put(p, static_cast<std::uint32_t>(size));
+            p = detail::put(p, ++sequence);
+            p = detail::put(p, static_cast<std::int32_t>(state.total_count));
+            p = detail::put(p, static_cast<float>(state.max_kps));
+            p = detail::put(p, static_cast<float>(state.kps_now));
+            p = detail::put(p, static_cast<std::uint16_t>(down_mask));
+            p = detail::put(p, static_cast<std::uint16_t>(m));
+            p = detail::put(p, static_cast<std::int64_t>(state.history_first_second));
+            for (size_t i = 0; i < state.button_count; i++) {
+                p = detail::put(p, static_cast<float>(state.columns[i].kps));
+                p = detail::put(p, static_cast<std::int32_t>(state.columns[i].times));
+            }
+            for (double v : state.history.last(m))
+                p = detail::put(p, static_cast<float>(v));
+            return buffer;
+        }
+    };
+
+    /// <summary>
+    /// 订阅者一侧的解码器。依次输入收到的字节，得到与广播方一致的状态。
+    /// </summary>
+    class state_decoder {
+    public:
+        struct decoded_state {
+            std::uint64_t sequence{};
+            size_t button_count{};
+            std::array<column_state, max_column_count> columns{};
+            bool is_autoplay{};
+            int total_count{};
+            double max_kps{};
+            double kps_now{};
+            std::vector<double> history;
+            long long history_first_second{};
+        };
+
+    private:
+        decoded_state crt;
+        bool has_keyframe{};
+
+    public:
+        const decoded_state& state() const {
+            return crt;
+        }
+
+    public:
+        /// <summary>
+        /// 解码 data 开头的一帧。数据不足一帧时返回 0 且不改变状态。
+        /// </summary>
+        /// <returns>这一帧的字节数。</returns>
+        size_t decode(std::span<const std::byte> data) {
+            if (data.size() < frame_header_size)
+                return 0;
+            const std::byte* p = data.data();
+            if (detail::get<std::uint32_t>(p) != frame_magic || detail::get<std::uint8_t>(p + 4) != frame_version)
+                throw std::runtime_error("invalid frame header.");
+            const auto flags = detail::get<std::uint8_t>(p + 5);
+            const size_t n = detail::get<std::uint8_t>(p + 6);
+            const size_t size = detail::get<std::uint32_t>(p + 8);
+            if (n > max_column_count || size < frame_fixed_size + 8 * n)
+                throw std::runtime_error("invalid frame size.");
+            if (data.size() < size)
+                return 0;
+            const size_t m = detail::get<std::uint16_t>(p + 34);
+            if (size != frame_fixed_size + 8 * n + 4 * m)
+                throw std::runtime_error("invalid frame size.");
+            const bool keyframe = flags & frame_flag_keyframe;
+            if (!keyframe && !has_keyframe)
+                throw std::runtime_error("delta frame before any keyframe.");
+
+            crt.sequence = detail::get<std::uint64_t>(p + 12);
+            crt.button_count = n;
+            crt.is_autoplay = flags & frame_flag_autoplay;
+            crt.total_count = detail::get<std::int32_t>(p + 20);
+            crt.max_kps = detail::get<float>(p + 24);
+            crt.kps_now = detail::get<float>(p + 28);
+            const auto down_mask = detail::get<std::uint16_t>(p + 32);
+            const auto first_second = static_cast<long long>(detail::get<std::int64_t>(p + 36));
+            p += frame_fixed_size;
+            crt.columns = {};
+            for (size_t i = 0; i < n; i++, p += 8) {
+                crt.columns[i].kps = detail::get<float>(p);
+                crt.columns[i].times = detail::get<std::int32_t>(p + 4);
+                crt.columns[i].down = down_mask >> i & 1;
+            }
+
+            auto& history = crt.history;
+            if (keyframe)
+                history.assign(m, 0.0);
+            else {
+                const long long k = first_second - crt.history_first_second;
+                if (k < 0 || m > history.size() || k >= static_cast<long long>(history.size()))
+                    throw std::runtime_error("delta frame does not continue the history.");
+                std::shift_left(history.begin(), history.end(), static_cast<std::ptrdiff_t>(k));
+            }
+            const size_t offset = history.size() - m;
+            for (size_t i = 0; i < m; i++, p += 4)
+                history[offset + i] = detail::get<float>(p);
+            crt.history_first_second = first_second;
+            has_keyframe = true;
+            return size;
+        }
+    };
+} // namespace broadcast
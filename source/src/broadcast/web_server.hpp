@@ -0,0 +1,403 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <functional>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+#undef min
+#undef max
+#pragma comment(lib, "Ws2_32.lib")
+
+#include "../metrics/registry.hpp"
+#include "json_frame.hpp"
+#include "key_edges.hpp"
+#include "state_frame.hpp"
+#include "websocket.hpp"
+
+namespace broadcast {
+    /// <summary>
+    /// 供浏览器源使用的 HTTP/WebSocket 服务器。只监听 127.0.0.1。
+    /// 所有网络操作都在一个事件循环线程中完成。每一批只编码一次，同一份数据发给所有客户端。
+    /// 客户端连接 ws://127.0.0.1:port/ 接收状态，连接 ws://127.0.0.1:port/?edges=1 还会接收按键边沿。
+    /// 来源不被 websocket::origin_allowed 接受的升级请求被拒绝，以免任意网页读取按键。
+    /// 仍未收完上一批的客户端会被断开。
+    /// </summary>
+    class web_server {
+    public:
+        /// <summary>
+        /// 在事件循环线程中调用，填写本批的状态。history 须在下一次调用前保持有效。
+        /// </summary>
+        using collector_t = std::function<void(live_state&)>;
+        static constexpr int send_buffer_size = 64 * 1024;  // 每个客户端的发送缓冲区大小。
+        static constexpr size_t max_request_size = 8 * 1024; // HTTP 请求头的最大长度。
+
+    private:
+        struct client {
+            enum class state_t {
+                handshaking, // 等待 HTTP 请求。
+                open,        // WebSocket 已建立。
+                closing,     // 发完 pending 后断开。
+            };
+            SOCKET socket{INVALID_SOCKET};
+            state_t state{state_t::handshaking};
+            bool edges{};                   // 是否接收按键边沿。
+            std::string incoming;           // 尚未处理的数据。
+            std::vector<std::byte> pending; // 未能发出的部分。通常为空。
+            bool counted{};                 // 是否计入 open_clients。
+            bool dead{};                    // 将在本轮循环结束时断开。
+        };
+
+    private:
+        collector_t collect;
+        key_edge_queue* edge_source;
+        std::vector<std::string> allowed_origins;
+        SOCKET listener{INVALID_SOCKET};
+        std::uint16_t bound_port{};
+        std::atomic<unsigned> batch_rate;
+        std::atomic<bool> exiting{};
+        std::atomic<size_t> open_clients{};
+        std::atomic<std::uint64_t> dropped{};
+        std::atomic<std::uint64_t> rejected{};
+        std::atomic<std::uint64_t> batches{};
+
+        // 以下成员只由事件循环线程访问。
+        std::vector<client> clients;
+        std::vector<WSAPOLLFD> poll_fds;
+        json_encoder encoder;
+        std::vector<key_edge> edges;
+        std::vector<std::byte> frame;            // 本批不含按键边沿的 WebSocket 帧。
+        std::vector<std::byte> frame_with_edges; // 本批含按键边沿的 WebSocket 帧。
+        std::array<char, 4096> receive_buffer;
+
+        std::thread loop_thread; // 最后构造。
+
+    public:
+        /// <param name="listen_port">监听的端口。为 0 时由系统选择，见 port。</param>
+        /// <param name="batches_per_second">每秒发送的批数。</param>
+        /// <param name="collector">填写每批的状态。</param>
+        /// <param name="edges_from">按键边沿的来源。可以为空。</param>
+        /// <param name="origins">除本地文件与本服务器外，额外接受的页面来源。</param>
+        web_server(std::uint16_t listen_port, unsigned batches_per_second, collector_t collector,
+                   key_edge_queue* edges_from = nullptr, std::vector<std::string> origins = {})
+            : collect(std::move(collector)), edge_source(edges_from), allowed_origins(std::move(origins)),
+              batch_rate(std::max(1u, batches_per_second)) {
+            WSADATA data;
+            if (WSAStartup(MAKEWORD(2, 2), &data))
+                throw std::runtime_error("fail to WSAStartup.");
+            if (!listen_on(listen_port)) {
+                WSACleanup();
+                throw std::runtime_error("fail to listen.");
+            }
+            loop_thread = std::thread(&web_server::run, this);
+        }
+        web_server(const web_server&) = delete;
+        web_server& operator=(const web_server&) = delete;
+        ~web_server() {
+            exiting.store(true, std::memory_order_relaxed);
+            loop_thread.join();
+            for (auto& c : clients)
+                closesocket(c.socket);
+            closesocket(listener);
+            if (edge_source)
+                edge_source->enable(false);
+            WSACleanup();
+        }
+
+    public:
+        /// <returns>实际监听的端口。</returns>
+        std::uint16_t port() const {
+            return bound_port;
+        }
+        /// <summary>
+        /// 修改每秒发送的批数。可以在任意线程调用。
+        /// </summary>
+        void rate(unsigned new_rate) {
+            batch_rate.store(std::max(1u, new_rate), std::memory_order_relaxed);
+        }
+        size_t client_count() const {
+            return open_clients.load(std::memory_order_relaxed);
+        }
+        /// <returns>因接收过慢或连接断开而被断开的客户端总数。</returns>
+        std::uint64_t dropped_count() const {
+            return dropped.load(std::memory_order_relaxed);
+        }
+        /// <returns>因来源不被接受而被拒绝的升级请求数。</returns>
+        std::uint64_t rejected_count() const {
+            return rejected.load(std::memory_order_relaxed);
+        }
+        /// <returns>已发送的批数。没有客户端时不发送。</returns>
+        std::uint64_t batch_count() const {
+            return batches.load(std::memory_order_relaxed);
+        }
+
+    private:
+        bool listen_on(std::uint16_t listen_port) {
+            SOCKET s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+            if (s == INVALID_SOCKET)
+                return false;
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(listen_port);
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            int length = sizeof(address);
+            u_long non_blocking = 1;
+            if (bind(s, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) ||
+                listen(s, SOMAXCONN) || ioctlsocket(s, FIONBIO, &non_blocking) ||
+                getsockname(s, reinterpret_cast<sockaddr*>(&address), &length)) {
+                closesocket(s);
+                return false;
+            }
+            listener = s;
+            bound_port = ntohs(address.sin_port);
+            return true;
+        }
+
+    private:
+        void run() {
+            using clock = std::chrono::steady_clock;
+            auto next_batch = clock::now();
+            while (!exiting.load(std::memory_order_relaxed)) {
+                const auto period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(
+                    1.0 / batch_rate.load(std::memory_order_relaxed)));
+                // 等待网络事件或下一批的时刻。至少每 50 ms 检查一次是否退出。
+                const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(next_batch - clock::now());
+                wait_events(static_cast<int>(std::clamp<long long>(wait.count(), 0, 50)));
+
+                const auto now = clock::now();
+                if (now >= next_batch) {
+                    next_batch = now - next_batch > period ? now + period : next_batch + period;
+                    send_batch();
+                }
+                std::erase_if(clients, [this](client& c) {
+                    if (c.dead) {
+                        if (c.counted)
+                            open_clients.fetch_sub(1, std::memory_order_relaxed);
+                        closesocket(c.socket);
+                    }
+                    return c.dead;
+                });
+            }
+        }
+        /// <summary>
+        /// 等待并处理网络事件：新连接、收到的数据、可以继续发送。
+        /// </summary>
+        void wait_events(int timeout_ms) {
+            poll_fds.clear();
+            poll_fds.push_back({listener, POLLRDNORM, 0});
+            for (const auto& c : clients)
+                poll_fds.push_back(
+                    {c.socket, static_cast<short>(POLLRDNORM | (c.pending.empty() ? 0 : POLLWRNORM)), 0});
+            if (WSAPoll(poll_fds.data(), static_cast<ULONG>(poll_fds.size()), timeout_ms) <= 0)
+                return;
+
+            for (size_t i = 0; i < clients.size(); i++) {
+                const auto events = poll_fds[i + 1].revents;
+                auto& c = clients[i];
+                if (events & (POLLERR | POLLHUP | POLLNVAL))
+                    c.dead = true;
+                if (!c.dead && events & POLLRDNORM)
+                    receive(c);
+                if (!c.dead && events & POLLWRNORM)
+                    flush(c);
+            }
+            if (poll_fds[0].revents & POLLRDNORM)
+                accept_pending();
+        }
+        void accept_pending() {
+            SOCKET s;
+            while ((s = accept(listener, nullptr, nullptr)) != INVALID_SOCKET) {
+                u_long non_blocking = 1;
+                BOOL no_delay = TRUE;
+                int buffer_size = send_buffer_size;
+                if (ioctlsocket(s, FIONBIO, &non_blocking) ||
+                    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&no_delay),
+                               sizeof(no_delay)) ||
+                    setsockopt(s, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&buffer_size),
+                               sizeof(buffer_size))) {
+                    closesocket(s);
+                    continue;
+                }
+                client c;
+                c.socket = s;
+                clients.push_back(std::move(c));
+            }
+        }
+
+    private:
+        void receive(client& c) {
+            const int n = recv(c.socket, receive_buffer.data(), static_cast<int>(receive_buffer.size()), 0);
+            if (n <= 0) {
+                if (n == 0 || WSAGetLastError() != WSAEWOULDBLOCK)
+                    c.dead = true;
+                return;
+            }
+            if (c.state == client::state_t::closing)
+                return;
+            c.incoming.append(receive_buffer.data(), static_cast<size_t>(n));
+            if (c.state == client::state_t::handshaking)
+                handshake(c);
+            if (c.state == client::state_t::open)
+                handle_frames(c);
+        }
+        void handshake(client& c) {
+            size_t consumed = 0;
+            std::optional<websocket::http_request> request;
+            try {
+                request = websocket::parse_request(c.incoming, consumed);
+            } catch (const std::runtime_error&) {
+                c.dead = true;
+                return;
+            }
+            if (!request) {
+                if (c.incoming.size() > max_request_size)
+                    c.dead = true;
+                return;
+            }
+            c.incoming.erase(0, consumed);
+            if (!request->upgrade) {
+                // 普通的 HTTP 请求：/metrics 返回运行计数，其余说明如何连接，然后断开。
+                constexpr std::string_view usage = "osu!kps: connect to this address with a WebSocket. "
+                                                   "Add ?edges=1 to receive key presses and releases. "
+                                                   "GET /metrics for counters in Prometheus format.\n";
+                const bool is_metrics = request->target == "/metrics" || request->target.starts_with("/metrics?");
+                const std::string body = is_metrics ? metrics::global().expose() : std::string(usage);
+                c.state = client::state_t::closing;
+                send_or_drop(c, as_bytes(std::format("HTTP/1.1 200 OK\r\nContent-Type: text/plain{}\r\n"
+                                                     "Content-Length: {}\r\nConnection: close\r\n\r\n{}",
+                                                     is_metrics ? "; version=0.0.4" : "", body.size(), body)));
+                if (c.pending.empty())
+                    c.dead = true;
+                return;
+            }
+            if (!websocket::origin_allowed(request->origin, bound_port, allowed_origins)) {
+                rejected.fetch_add(1, std::memory_order_relaxed);
+                c.state = client::state_t::closing;
+                send_or_drop(c, as_bytes(std::string("HTTP/1.1 403 Forbidden\r\nContent-Length: 0\r\n"
+                                                     "Connection: close\r\n\r\n")));
+                if (c.pending.empty())
+                    c.dead = true;
+                return;
+            }
+            c.edges = request->target.find("edges=1") != std::string::npos;
+            send_or_drop(c, as_bytes(websocket::handshake_response(request->key)));
+            if (c.dead)
+                return;
+            c.state = client::state_t::open;
+            c.counted = true;
+            open_clients.fetch_add(1, std::memory_order_relaxed);
+            encoder.request_keyframe(); // 新的客户端需要完整的历史记录。
+            if (c.edges && edge_source)
+                edge_source->enable(true);
+        }
+        /// <summary>
+        /// 处理客户端发来的帧。只响应关闭与 ping，其余内容被忽略。
+        /// </summary>
+        void handle_frames(client& c) {
+            while (true) {
+                auto bytes = std::as_bytes(std::span(c.incoming));
+                auto header = websocket::parse_frame_header(bytes);
+                if (!header || bytes.size() - header->header_size < header->payload_size)
+                    return;
+                const size_t size = header->header_size + static_cast<size_t>(header->payload_size);
+                if (header->code == websocket::opcode::close) {
+                    send_control(c, websocket::opcode::close);
+                    c.state = client::state_t::closing;
+                    if (c.pending.empty())
+                        c.dead = true;
+                    return;
+                }
+                if (header->code == websocket::opcode::ping)
+                    send_control(c, websocket::opcode::pong); // 不回显 ping 的内容。
+                c.incoming.erase(0, size);
+            }
+        }
+        void send_control(client& c, websocket::opcode code) {
+            std::array<std::byte, 10> header;
+            const size_t n = websocket::write_frame_header(code, 0, header);
+            send_or_drop(c, std::span(header).first(n));
+        }
+
+    private:
+        static std::span<const std::byte> as_bytes(const std::string& s) {
+            return std::as_bytes(std::span(s));
+        }
+        static void build_frame(std::string_view payload, std::vector<std::byte>& out) {
+            std::array<std::byte, 10> header;
+            const size_t n = websocket::write_frame_header(websocket::opcode::text, payload.size(), header);
+            out.assign(header.begin(), header.begin() + static_cast<std::ptrdiff_t>(n));
+            const auto bytes = std::as_bytes(std::span(payload));
+            out.insert(out.end(), bytes.begin(), bytes.end());
+        }
+        void send_batch() {
+            if (edge_source)
+                edge_source->take(edges);
+            if (!open_clients.load(std::memory_order_relaxed))
+                return;
+
+            live_state state;
+            collect(state);
+            build_frame(encoder.encode(state), frame);
+            const bool any_edges = std::any_of(clients.begin(), clients.end(), [](const client& c) {
+                return c.state == client::state_t::open && c.edges;
+            });
+            if (any_edges)
+                build_frame(encoder.with_edges(edges), frame_with_edges);
+            else if (edge_source)
+                edge_source->enable(false);
+
+            for (auto& c : clients) {
+                if (c.dead || c.state != client::state_t::open)
+                    continue;
+                if (!c.pending.empty()) {
+                    c.dead = true; // 仍未收完上一批。
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                send_or_drop(c, c.edges ? frame_with_edges : frame);
+            }
+            batches.fetch_add(1, std::memory_order_relaxed);
+        }
+        /// <summary>
+        /// 尽可能多地发送 data，发送缓冲区满时将剩余部分复制到 pending。连接断开时标记为 dead。
+        /// </summary>
+        void send_or_drop(client& c, std::span<const std::byte> data) {
+            while (!data.empty()) {
+                const int sent =
+                    send(c.socket, reinterpret_cast<const char*>(data.data()), static_cast<int>(data.size()), 0);
+                if (sent == SOCKET_ERROR) {
+                    if (WSAGetLastError() != WSAEWOULDBLOCK) {
+                        c.dead = true;
+                        dropped.fetch_add(1, std::memory_order_relaxed);
+                    } else
+                        c.pending.insert(c.pending.end(), data.begin(), data.end());
+                    return;
+                }
+                data = data.subspan(static_cast<size_t>(sent));
+            }
+        }
+        void flush(client& c) {
+            auto pending = std::move(c.pending);
+            c.pending.clear();
+            send_or_drop(c, pending);
+            if (c.pending.empty() && c.state == client::state_t::closing)
+                c.dead = true;
+        }
+    };
+} // namespace broadcast
@@ -0,0 +1,287 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+/*
+WebSocket（RFC 6455）服务端所需的最小实现：握手、服务端帧头、客户端帧头的解析。
+服务端不分片、不压缩，也不发送掩码。
+*/
+
+namespace broadcast::websocket {
+    enum class opcode : std::uint8_t {
+        continuation = 0x0,
+        text = 0x1,
+        binary = 0x2,
+        close = 0x8,
+        ping = 0x9,
+        pong = 0xA,
+    };
+
+    /// <summary>
+    /// SHA-1 摘要。只用于计算握手的 Sec-WebSocket-Accept。
+    /// </summary>
+    inline std::array<std::uint8_t, 20> sha1(std::string_view data) {
+        std::array<std::uint32_t, 5> h{0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+        auto process = [&h](const std::uint8_t* block) {
+            std::array<std::uint32_t, 80> w;
+            for (size_t i = 0; i < 16; i++)
+                w[i] = std::uint32_t{block[4 * i]} << 24 | std::uint32_t{block[4 * i + 1]} << 16 |
+                       std::uint32_t{block[4 * i + 2]} << 8 | std::uint32_t{block[4 * i + 3]};
+            for (size_t i = 16; i < 80; i++)
+                w[i] = std::rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+            auto [a, b, c, d, e] = h;
+            for (size_t i = 0; i < 80; i++) {
+                std::uint32_t f, k;
+                if (i < 20)
+                    f = (b & c) | (~b & d), k = 0x5A827999;
+                else if (i < 40)
+                    f = b ^ c ^ d, k = 0x6ED9EBA1;
+                else if (i < 60)
+                    f = (b & c) | (b & d) | (c & d), k = 0x8F1BBCDC;
+                else
+                    f = b ^ c ^ d, k = 0xCA62C1D6;
+                const std::uint32_t t = std::rotl(a, 5) + f + e + k + w[i];
+                e = d;
+                d = c;
+                c = std::rotl(b, 30);
+                b = a;
+                a = t;
+            }
+            h[0] += a;
+            h[1] += b;
+            h[2] += c;
+            h[3] += d;
+            h[4] += e;
+        };
+
+        const auto* bytes = reinterpret_cast<const std::uint8_t*>(data.data());
+        size_t i = 0;
+        for (; i + 64 <= data.size(); i += 64)
+            process(bytes + i);
+        // 填充：0x80，若干个 0，最后 8 字节为以位为单位的长度。
+        std::array<std::uint8_t, 128> tail{};
+        const size_t rest = data.size() - i;
+        for (size_t j = 0; j < rest; j++)
+            tail[j] = bytes[i + j];
+        tail[rest] = 0x80;
+        const size_t tail_size = rest + 9 <= 64 ? 64 : 128;
+        const std::uint64_t bits = static_cast<std::uint64_t>(data.size()) * 8;
+        for (size_t j = 0; j < 8; j++)
+            tail[tail_size - 1 - j] = static_cast<std::uint8_t>(bits >> (8 * j));
+        for (size_t j = 0; j < tail_size; j += 64)
+            process(tail.data() + j);
+
+        std::array<std::uint8_t, 20> ret;
+        for (size_t j = 0; j < 20; j++)
+            ret[j] = static_cast<std::uint8_t>(h[j / 4] >> (24 - 8 * (j % 4)));
+        return ret;
+    }
+
+    inline std::string base64(std::span<const std::uint8_t> data) {
+        static constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        std::string ret;
+        ret.reserve((data.size() + 2) / 3 * 4);
+        for (size_t i = 0; i < data.size(); i += 3) {
+            const size_t n = std::min<size_t>(3, data.size() - i);
+            std::uint32_t v = std::uint32_t{data[i]} << 16;
+            if (n > 1)
+                v |= std::uint32_t{data[i + 1]} << 8;
+            if (n > 2)
+                v |= data[i + 2];
+            for (size_t j = 0; j < 4; j++)
+                ret.push_back(j <= n ? alphabet[v >> (18 - 6 * j) & 0x3F] : '=');
+        }
+        return ret;
+    }
+
+    /// <returns>客户端的 Sec-WebSocket-Key 对应的 Sec-WebSocket-Accept。</returns>
+    inline std::string accept_key(std::string_view key) {
+        std::string s(key);
+        s += "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+        return base64(sha1(s));
+    }
+
+    /// <summary>
+    /// HTTP 请求中握手需要的部分。
+    /// </summary>
+    struct http_request {
+        std::string method;
+        std::string target;                // 路径与查询字符串。
+        std::string key;                   // Sec-WebSocket-Key。
+        bool upgrade{};                    // 是否请求升级为 WebSocket。
+        std::optional<std::string> origin; // Origin，已转为小写。浏览器中的页面总会发送，其他客户端可能没有。
+    };
+
+    /// <summary>
+    /// 解析 HTTP 请求头。
+    /// </summary>
+    /// <param name="consumed">请求头的字节数，包括末尾的空行。</param>
+    /// <returns>请求头不完整时为空。</returns>
+    inline std::optional<http_request> parse_request(std::string_view data, size_t& consumed) {
+        const size_t end = data.find("\r\n\r\n");
+        if (end == std::string_view::npos)
+            return std::nullopt;
+        consumed = end + 4;
+        auto lower = [](std::string_view s) {
+            std::string ret(s);
+            for (auto& c : ret)
+                if ('A' <= c && c <= 'Z')
+                    c = static_cast<char>(c - 'A' + 'a');
+            return ret;
+        };
+        auto trim = [](std::string_view s) {
+            while (!s.empty() && (s.front() == ' ' || s.front() == '\t'))
+                s.remove_prefix(1);
+            while (!s.empty() && (s.back() == ' ' || s.back() == '\t'))
+                s.remove_suffix(1);
+            return s;
+        };
+
+        http_request ret;
+        std::string_view rest = data.substr(0, end + 2);
+        size_t eol = rest.find("\r\n");
+        const std::string_view request_line = rest.substr(0, eol);
+        rest.remove_prefix(eol + 2);
+        const size_t sp1 = request_line.find(' ');
+        const size_t sp2 = sp1 == std::string_view::npos ? sp1 : request_line.find(' ', sp1 + 1);
+        if (sp2 == std::string_view::npos)
+            throw std::runtime_error("invalid request line.");
+        ret.method = request_line.substr(0, sp1);
+        ret.target = request_line.substr(sp1 + 1, sp2 - sp1 - 1);
+
+        bool upgrade_websocket = false, connection_upgrade = false;
+        while (!rest.empty()) {
+            eol = rest.find("\r\n");
+            const std::string_view line = rest.substr(0, eol);
+            rest.remove_prefix(eol + 2);
+            const size_t colon = line.find(':');
+            if (colon == std::string_view::npos)
+                throw std::runtime_error("invalid header.");
+            const auto name = lower(trim(line.substr(0, colon)));
+            const auto value = trim(line.substr(colon + 1));
+            if (name == "upgrade")
+                upgrade_websocket = lower(value) == "websocket";
+            else if (name == "connection")
+                connection_upgrade = lower(value).find("upgrade") != std::string::npos;
+            else if (name == "sec-websocket-key")
+                ret.key = value;
+            else if (name == "origin")
+                ret.origin = lower(value);
+        }
+        ret.upgrade = upgrade_websocket && connection_upgrade && !ret.key.empty();
+        return ret;
+    }
+
+    /// <summary>
+    /// 是否接受来自 origin 的页面的连接。浏览器允许任意页面连接本机的 WebSocket，所以需要检查 Origin。
+    /// 接受没有 Origin 的客户端（不是浏览器中的页面）、本地文件（file://，如 OBS 中的本地浏览器源）、
+    /// 本服务器自己的地址，以及 allowed 中列出的来源。比较时忽略大小写与末尾的 /。
+    /// 沙箱中的 iframe 等任意页面都可以发送 null，所以只有 allowed 中列出 "null" 时才接受。
+    /// </summary>
+    /// <param name="origin">parse_request 得到的 Origin，已转为小写。</param>
+    /// <param name="port">本服务器的端口。</param>
+    /// <param name="allowed">额外接受的来源，例如 "https://example.com"。</param>
+    inline bool origin_allowed(const std::optional<std::string>& origin, std::uint16_t port,
+                               std::span<const std::string> allowed) {
+        if (!origin)
+            return true;
+        std::string_view crt = *origin;
+        while (crt.ends_with('/'))
+            crt.remove_suffix(1);
+        if (crt.starts_with("file:"))
+            return true;
+        if (crt == std::format("http://127.0.0.1:{}", port) || crt == std::format("http://localhost:{}", port))
+            return true;
+        return std::any_of(allowed.begin(), allowed.end(), [crt](std::string_view each) {
+            while (each.ends_with('/'))
+                each.remove_suffix(1);
+            return std::equal(crt.begin(), crt.end(), each.begin(), each.end(), [](char a, char b) {
+                return a == ('A' <= b && b <= 'Z' ? static_cast<char>(b - 'A' + 'a') : b);
+            });
+        });
+    }
+
+    /// <returns>同意升级的 HTTP 响应。</returns>
+    inline std::string handshake_response(std::string_view key) {
+        return std::format("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                           "Sec-WebSocket-Accept: {}\r\n\r\n",
+                           accept_key(key));
+    }
+
+    /// <summary>
+    /// 服务端帧的帧头。FIN 置位，不使用掩码。
+    /// </summary>
+    /// <returns>帧头的字节数。</returns>
+    inline size_t write_frame_header(opcode code, size_t payload_size, std::array<std::byte, 10>& out) {
+        out[0] = static_cast<std::byte>(0x80 | static_cast<unsigned>(code));
+        if (payload_size < 126) {
+            out[1] = static_cast<std::byte>(payload_size);
+            return 2;
+        }
+        if (payload_size <= 0xFFFF) {
+            out[1] = std::byte{126};
+            out[2] = static_cast<std::byte>(payload_size >> 8);
+            out[3] = static_cast<std::byte>(payload_size);
+            return 4;
+        }
+        out[1] = std::byte{127};
+        const auto size = static_cast<std::uint64_t>(payload_size);
+        for (size_t i = 0; i < 8; i++)
+            out[2 + i] = static_cast<std::byte>(size >> (56 - 8 * i));
+        return 10;
+    }
+
+    /// <summary>
+    /// 客户端帧的帧头。
+    /// </summary>
+    struct frame_header {
+        bool fin{};
+        opcode code{};
+        size_t header_size{};
+        std::uint64_t payload_size{};
+        bool masked{};
+        std::array<std::uint8_t, 4> mask{};
+    };
+    /// <returns>数据不足一个帧头时为空。</returns>
+    inline std::optional<frame_header> parse_frame_header(std::span<const std::byte> data) {
+        if (data.size() < 2)
+            return std::nullopt;
+        frame_header ret;
+        const auto b0 = std::to_integer<unsigned>(data[0]);
+        const auto b1 = std::to_integer<unsigned>(data[1]);
+        ret.fin = b0 & 0x80;
+        ret.code = static_cast<opcode>(b0 & 0x0F);
+        ret.masked = b1 & 0x80;
+        ret.payload_size = b1 & 0x7F;
+        size_t offset = 2;
+        const size_t extended = ret.payload_size == 126 ? 2 : ret.payload_size == 127 ? 8 : 0;
+        if (data.size() < offset + extended + (ret.masked ? 4 : 0))
+            return std::nullopt;
+        if (extended) {
+            ret.payload_size = 0;
+            for (size_t i = 0; i < extended; i++)
+                ret.payload_size = ret.payload_size << 8 | std::to_integer<unsigned>(data[offset + i]);
+            offset += extended;
+        }
+        if (ret.masked) {
+            for (size_t i = 0; i < 4; i++)
+                ret.mask[i] = std::to_integer<std::uint8_t>(data[offset + i]);
+            offset += 4;
+        }
+        ret.header_size = offset;
+        return ret;
+    }
+} // namespace broadcast::websocket
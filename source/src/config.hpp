@@ -3,6 +3,13 @@
 
 #pragma once
 
+#include <charconv>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
 #include "utils/config_manager.hpp"
 #include "utils/keyboard_char.hpp"
 
@@ -39,6 +46,12 @@ public:
 
         if (language() && !lang.is_language_supported(language()))
             language(0);
+
+        broadcast_port(std::max(0, std::min(65535, broadcast_port())));
+        broadcast_websocket_port(std::max(0, std::min(65535, broadcast_websocket_port())));
+        broadcast_websocket_rate(std::max(1, std::min(240, broadcast_websocket_rate())));
+        debounce_mode(static_cast<kps::debounce_mode>(std::max(0, std::min(2, static_cast<int>(debounce_mode())))));
+        debounce_interval_ms(std::max(0, std::min(100, debounce_interval_ms())));
     }
 
 public:
@@ -97,6 +110,15 @@ public:
     void kps_method(kps::kps_implement_type type) {
         (*this)[u8"kps.method"] = static_cast<int>(type);
     }
+    /// <summary>
+    /// 是否让未显示的 KPS 计算方法也随按键增量维护，使切换计算方法时不必重建。
+    /// </summary>
+    bool kps_hot_standby() const {
+        return std::get<bool>(get_value(u8"kps.hot_standby"));
+    }
+    void kps_hot_standby(bool whether) {
+        (*this)[u8"kps.hot_standby"] = whether;
+    }
 
     static std::u8string key_keyname(int total, int which) {
         using namespace std::literals;
@@ -136,4 +158,105 @@ public:
     void auto_reset_kps_graph(bool whether) {
         (*this)[u8"auto_reset.kps_graph"] = whether;
     }
+
+public:
+    /// <summary>
+    /// 向本机广播实时状态的 TCP 端口。为 0 时不广播。
+    /// </summary>
+    int broadcast_port() const {
+        return static_cast<int>(std::get<int64_t>(get_value(u8"broadcast.port")));
+    }
+    void broadcast_port(int port) {
+        (*this)[u8"broadcast.port"] = port;
+    }
+    /// <summary>
+    /// 是否在共享内存中发布实时状态。
+    /// </summary>
+    bool broadcast_shared_memory() const {
+        return std::get<bool>(get_value(u8"broadcast.shared_memory"));
+    }
+    void broadcast_shared_memory(bool whether) {
+        (*this)[u8"broadcast.shared_memory"] = whether;
+    }
+    /// <summary>
+    /// 供浏览器源使用的 HTTP/WebSocket 端口。为 0 时不提供。
+    /// </summary>
+    int broadcast_websocket_port() const {
+        return static_cast<int>(std::get<int64_t>(get_value(u8"broadcast.websocket_port")));
+    }
+    void broadcast_websocket_port(int port) {
+        (*this)[u8"broadcast.websocket_port"] = port;
+    }
+    /// <summary>
+    /// 每秒向 WebSocket 客户端发送的批数。
+    /// </summary>
+    int broadcast_websocket_rate() const {
+        return static_cast<int>(std::get<int64_t>(get_value(u8"broadcast.websocket_rate")));
+    }
+    void broadcast_websocket_rate(int rate) {
+        (*this)[u8"broadcast.websocket_rate"] = rate;
+    }
+    /// <summary>
+    /// 除本地文件外，允许连接 WebSocket 的页面来源，以逗号分隔，例如 "https://example.com"。
+    /// </summary>
+    std::vector<std::string> broadcast_websocket_origins() const {
+        std::vector<std::string> ret;
+        const auto& str = std::get<std::u8string>(get_value(u8"broadcast.websocket_origins"));
+        std::string_view rest(reinterpret_cast<const char*>(str.data()), str.size());
+        while (!rest.empty()) {
+            auto item = rest.substr(0, rest.find(','));
+            rest.remove_prefix(std::min(rest.size(), item.size() + 1));
+            while (!item.empty() && item.front() == ' ')
+                item.remove_prefix(1);
+            while (!item.empty() && item.back() == ' ')
+                item.remove_suffix(1);
+            if (!item.empty())
+                ret.emplace_back(item);
+        }
+        return ret;
+    }
+
+public:
+    /// <summary>
+    /// 按键抖动过滤方式。0 为不过滤，1 为 eager，2 为 deferred。
+    /// </summary>
+    kps::debounce_mode debounce_mode() const {
+        return static_cast<kps::debounce_mode>(std::get<int64_t>(get_value(u8"debounce.mode")));
+    }
+    void debounce_mode(kps::debounce_mode mode) {
+        (*this)[u8"debounce.mode"] = static_cast<int>(mode);
+    }
+    /// <summary>
+    /// 按键抖动过滤的最小间隔，以毫秒为单位。
+    /// </summary>
+    int debounce_interval_ms() const {
+        return static_cast<int>(std::get<int64_t>(get_value(u8"debounce.interval_ms")));
+    }
+    void debounce_interval_ms(int interval) {
+        (*this)[u8"debounce.interval_ms"] = interval;
+    }
+    /// <summary>
+    /// 单独设置最小间隔的按键，格式为以逗号分隔的“虚拟码:毫秒”，例如 "68:4,70:0"。忽略格式错误的项。
+    /// </summary>
+    std::vector<std::pair<int, kps::clock::duration>> debounce_key_intervals() const {
+        std::vector<std::pair<int, kps::clock::duration>> ret;
+        const auto& str = std::get<std::u8string>(get_value(u8"debounce.key_intervals"));
+        std::string_view rest(reinterpret_cast<const char*>(str.data()), str.size());
+        while (!rest.empty()) {
+            const auto item = rest.substr(0, rest.find(','));
+            rest.remove_prefix(std::min(rest.size(), item.size() + 1));
+            const auto colon = item.find(':');
+            if (colon == std::string_view::npos)
+                continue;
+            int key{}, ms{};
+            const auto key_str = item.substr(0, colon);
+            const auto ms_str = item.substr(colon + 1);
+            if (std::from_chars(key_str.data(), key_str.data() + key_str.size(), key).ec != std::errc() ||
+                std::from_chars(ms_str.data(), ms_str.data() + ms_str.size(), ms).ec != std::errc() || key < 0 ||
+                key > 255 || ms < 0)
+                continue;
+            ret.emplace_back(key, std::chrono::milliseconds(std::min(ms, 100)));
+        }
+        return ret;
+    }
 };
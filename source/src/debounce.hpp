@@ -0,0 +1,303 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+
+#include "key_event.hpp"
+
+namespace kps {
+    enum class debounce_mode : std::uint8_t {
+        off,      // 不过滤。
+        eager,    // 立即转发边沿，忽略其后最小间隔内的变化。
+        deferred, // 边沿保持最小间隔不变后才转发，时间仍为边沿本身的时间。
+    };
+
+    /// <summary>
+    /// 按键抖动过滤。每个按键的状态保存在按键码索引的平坦数组中，eager 模式下逐个事件的处理没有分支。
+    /// 输出的事件按时间不减的顺序排列，与输入的要求相同。
+    /// 过滤器本身不加锁，由调用者保证同一时间只有一个线程使用。
+    /// </summary>
+    class debounce_filter {
+    public:
+        static constexpr size_t key_count = 256;
+        /// <summary>
+        /// deferred：队列的容量。待定边沿每个按键至多一个，其余位置留给被更早的待定边沿阻塞的已稳定边沿。
+        /// </summary>
+        static constexpr size_t queue_capacity = 4 * key_count;
+
+    private:
+        static constexpr clock::rep never = std::numeric_limits<clock::rep>::min() / 2;
+
+        debounce_mode crt_mode{debounce_mode::off};
+        std::array<clock::rep, key_count> interval{};         // 各按键的最小间隔。
+        std::array<clock::rep, key_count> last{};             // eager：上一个转发的边沿的时间。
+        std::array<clock::rep, key_count> pending{};          // eager：被忽略的边沿的时间；deferred：待定边沿的时间。
+        std::array<bool, key_count> out_down{};               // eager：已转发的状态；deferred：已确定的状态。
+        std::array<bool, key_count> pending_down{};           // eager：上一个被忽略的边沿的状态。
+        std::array<bool, key_count> has_pending{};            // eager：上次转发后有被忽略的边沿；deferred：有待定边沿。
+        std::array<std::uint8_t, key_count> pending_source{}; // 被忽略或待定的边沿的来源。
+        std::array<std::uint64_t, key_count> pending_slot{};  // deferred：待定边沿在 queue 中的位置。
+        clock::rep out_last{never};                           // eager：最后转发的事件的时间。
+        std::uint64_t suppressed{};
+
+    private:
+        enum class slot_state : std::uint8_t {
+            waiting, // 待定。
+            ready,   // 已稳定，等待更早的待定边沿确定后转发。
+            dropped, // 已被抵消。
+        };
+        struct slot {
+            key_event event;
+            slot_state state{};
+        };
+        static_assert((queue_capacity & (queue_capacity - 1)) == 0);
+        /// <summary>
+        /// deferred：待定与已稳定的边沿，按时间顺序排列的环形队列。新的待定边沿的时间不早于已有的边沿，
+        /// 所以追加到末尾即保持有序。只从开头转发已稳定的边沿，使不同最小间隔的按键之间不会乱序。
+        /// 容量固定，过滤时不分配内存。
+        /// </summary>
+        std::array<slot, queue_capacity> queue{};
+        std::uint64_t queue_head{};
+        std::uint64_t queue_tail{};
+
+        slot& at_slot(std::uint64_t position) {
+            return queue[static_cast<size_t>(position & (queue_capacity - 1))];
+        }
+        const slot& at_slot(std::uint64_t position) const {
+            return queue[static_cast<size_t>(position & (queue_capacity - 1))];
+        }
+        bool queue_full() const {
+            return queue_tail - queue_head == queue_capacity;
+        }
+        /// <summary>
+        /// 追加待定边沿。保证调用该函数时队列未满。
+        /// </summary>
+        void enqueue(size_t k, const key_event& e) {
+            pending_slot[k] = queue_tail;
+            at_slot(queue_tail++) = {e, slot_state::waiting};
+        }
+        /// <summary>
+        /// 将待定边沿标记为已稳定。
+        /// </summary>
+        void settle(size_t k) {
+            at_slot(pending_slot[k]).state = slot_state::ready;
+            out_down[k] = !out_down[k];
+            has_pending[k] = false;
+        }
+        /// <summary>
+        /// 不等最小间隔结束，确定队列开头的待定边沿，使其后已稳定的边沿可以转发。
+        /// </summary>
+        void settle_head() {
+            const auto& head = at_slot(queue_head);
+            if (head.state == slot_state::waiting)
+                settle(index(head.event.key));
+        }
+        /// <summary>
+        /// 从队列开头转发已稳定的边沿，直到遇到待定边沿或写满 out。
+        /// </summary>
+        size_t release(std::span<key_event> out) {
+            size_t n = 0;
+            while (queue_head != queue_tail && n < out.size()) {
+                const auto& crt = at_slot(queue_head);
+                if (crt.state == slot_state::waiting)
+                    break;
+                if (crt.state == slot_state::ready)
+                    out[n++] = crt.event;
+                queue_head++;
+            }
+            return n;
+        }
+
+        static size_t index(int key) {
+            return static_cast<std::uint8_t>(key);
+        }
+        static clock::rep ticks(time_point time) {
+            return time.time_since_epoch().count();
+        }
+        static time_point at(clock::rep t) {
+            return time_point(clock::duration(t));
+        }
+
+    public:
+        debounce_filter() {
+            reset();
+        }
+
+    public:
+        debounce_mode mode() const {
+            return crt_mode;
+        }
+        /// <summary>
+        /// 修改模式并清空各按键的状态。被忽略或待定的边沿会被丢弃，应先用 flush 取出。
+        /// </summary>
+        void set_mode(debounce_mode new_mode) {
+            crt_mode = new_mode;
+            reset();
+        }
+        void set_interval(int key, clock::duration min_interval) {
+            interval[index(key)] = min_interval.count();
+        }
+        void set_interval(clock::duration min_interval) {
+            interval.fill(min_interval.count());
+        }
+        clock::duration get_interval(int key) const {
+            return clock::duration(interval[index(key)]);
+        }
+        /// <returns>被过滤掉的事件数。</returns>
+        std::uint64_t suppressed_count() const {
+            return suppressed;
+        }
+        /// <summary>
+        /// 下一次调用 flush 可能转发边沿的最早时刻，可能已经过去。没有被忽略或待定的边沿时为空，此时不必调用 flush。
+        /// </summary>
+        std::optional<time_point> next_deadline() const {
+            if (crt_mode == debounce_mode::off)
+                return std::nullopt;
+            constexpr clock::rep none = std::numeric_limits<clock::rep>::max();
+            clock::rep ret = none;
+            // 与 flush 的条件相同：eager 为上一个转发的边沿的最小间隔结束时，deferred 为待定边沿稳定时。
+            const auto& since = crt_mode == debounce_mode::eager ? last : pending;
+            for (size_t k = 0; k < key_count; k++)
+                if (has_pending[k])
+                    ret = std::min(ret, since[k] + interval[k]);
+            // 上次写满 out 而留下的已稳定边沿可以立即转发。
+            if (crt_mode == debounce_mode::deferred && queue_head != queue_tail &&
+                at_slot(queue_head).state != slot_state::waiting)
+                ret = std::min(ret, ticks(at_slot(queue_head).event.time));
+            if (ret == none)
+                return std::nullopt;
+            return at(ret);
+        }
+        /// <summary>
+        /// 清空各按键的状态。不改变最小间隔与计数。
+        /// </summary>
+        void reset() {
+            last.fill(never);
+            pending.fill(0);
+            out_down.fill(false);
+            pending_down.fill(false);
+            has_pending.fill(false);
+            out_last = never;
+            queue_head = queue_tail = 0;
+        }
+
+    public:
+        /// <summary>
+        /// 过滤一批事件，将结果写入 out 的开头。out 的大小至少为 in 的两倍。
+        /// deferred 模式下写满 out 后剩余的已稳定边沿留到之后转发。
+        /// </summary>
+        /// <returns>写入的事件数。</returns>
+        size_t process(std::span<const key_event> in, std::span<key_event> out) {
+            if (out.size() < 2 * in.size())
+                throw std::invalid_argument("out is too small.");
+            if (crt_mode == debounce_mode::off) {
+                std::ranges::copy(in, out.begin());
+                return in.size();
+            }
+            key_event* dst = out.data();
+            size_t n = 0;
+            if (crt_mode == debounce_mode::eager) {
+                for (const auto& e : in) {
+                    const size_t k = index(e.key);
+                    const clock::rep t = ticks(e.time);
+                    const bool accept = t - last[k] >= interval[k];
+                    // 转发的状态已经与本事件相同，说明中间被忽略了奇数个边沿：先补上最后被忽略的那一个。
+                    // 其时间不早于已转发的事件，以保持输出有序。
+                    const bool restore = accept & has_pending[k] & (out_down[k] == e.down);
+                    dst[n] = {e.key, !e.down, pending_source[k], at(std::max(pending[k], out_last))};
+                    n += restore;
+                    dst[n] = e;
+                    n += accept;
+                    last[k] = accept ? t : last[k];
+                    out_last = accept ? t : out_last;
+                    pending[k] = accept ? pending[k] : t;
+                    pending_down[k] = accept ? pending_down[k] : e.down;
+                    pending_source[k] = accept ? pending_source[k] : e.source;
+                    out_down[k] = accept ? e.down : out_down[k];
+                    has_pending[k] = !accept;
+                    suppressed += !accept;
+                }
+            } else {
+                for (const auto& e : in) {
+                    const size_t k = index(e.key);
+                    const clock::rep t = ticks(e.time);
+                    if (has_pending[k]) {
+                        if (t - pending[k] >= interval[k])
+                            settle(k); // 待定边沿已稳定。
+                        else {
+                            // 待定边沿在最小间隔内被本事件抵消：两者都丢弃。
+                            at_slot(pending_slot[k]).state = slot_state::dropped;
+                            has_pending[k] = false;
+                            suppressed += 2;
+                            continue;
+                        }
+                    }
+                    if (e.down != out_down[k]) {
+                        if (queue_full()) {
+                            // 只在最小间隔内积压了大量边沿时发生：提前确定开头的待定边沿，转发以腾出位置。
+                            settle_head();
+                            n += release(out.subspan(n));
+                        }
+                        if (queue_full()) {
+                            // out 也已写满，只能丢弃本事件。已确定的状态不变，该键之后的事件仍与之一致。
+                            suppressed++;
+                            continue;
+                        }
+                        has_pending[k] = true;
+                        pending[k] = t;
+                        pending_source[k] = e.source;
+                        enqueue(k, e);
+                    } else
+                        suppressed++;
+                    n += release(out.subspan(n));
+                }
+            }
+            return n;
+        }
+        /// <summary>
+        /// 转发在 now 时已确定的边沿，写入 out 的开头。out 的大小至少为 key_count。
+        /// eager 模式下为最小间隔结束时与已转发状态不同的被忽略边沿，例如短于最小间隔的点按的放开；
+        /// deferred 模式下为已稳定的待定边沿。
+        /// 应在 next_deadline 时调用，否则这些边沿要等到该键的下一个事件才能转发。
+        /// </summary>
+        /// <returns>写入的事件数。</returns>
+        size_t flush(time_point now, std::span<key_event> out) {
+            if (out.size() < key_count)
+                throw std::invalid_argument("out is too small.");
+            const clock::rep t = ticks(now);
+            if (crt_mode == debounce_mode::deferred) {
+                for (size_t k = 0; k < key_count; k++)
+                    if (has_pending[k] && t - pending[k] >= interval[k])
+                        settle(k);
+                return release(out);
+            }
+            if (crt_mode != debounce_mode::eager)
+                return 0;
+            size_t n = 0;
+            for (size_t k = 0; k < key_count; k++) {
+                if (!has_pending[k] || last[k] > t - interval[k])
+                    continue;
+                has_pending[k] = false;
+                if (pending_down[k] == out_down[k])
+                    continue;
+                out[n++] = {static_cast<int>(k), pending_down[k], pending_source[k],
+                            at(std::max(pending[k], out_last))};
+                out_down[k] = pending_down[k];
+            }
+            std::stable_sort(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(n),
+                             [](const key_event& a, const key_event& b) { return a.time < b.time; });
+            if (n)
+                out_last = ticks(out[n - 1].time);
+            return n;
+        }
+    };
+} // namespace kps
@@ -3,15 +3,29 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
 #include <type_traits>
+#include <utility>
 
+#include "debounce.hpp"
+#include "key_event.hpp"
 #include "key_monitor.hpp"
 #include "key_monitor_async.hpp"
 #include "key_monitor_dinput.hpp"
 #include "key_monitor_hook.hpp"
 #include "key_monitor_memory.hpp"
 #include "kps_calculator.hpp"
+#include "monitor_latency.hpp"
+#include "pipeline/event_pipeline.hpp"
+#include "pipeline/stages.hpp"
 
 namespace kps {
     enum key_monitor_implement_type {
@@ -22,20 +36,28 @@ namespace kps {
     };
 
     class kps final : public kps_calculator {
-    public:
-        using callback_t = key_monitor::callback_t;
-
     private:
-        callback_t callback;
+        pipeline::event_pipeline pipe; // 在 monitor 之后析构，监视器线程退出前一直可用。
+        pipeline::debounce_stage& debounce{
+            pipe.add_transform("debounce", std::make_unique<pipeline::debounce_stage>())};
+        std::mutex mutex_flush;
+        std::condition_variable cv_flush;
+        std::optional<time_point> flush_at; // 下一次转发已确定的边沿的时刻。没有被忽略或待定的边沿时为空。
+        bool flush_exit{};
+        monitor_latency latency;
+        std::atomic<key_monitor_implement_type> crt_type{monitor_implement_type_dinput};
         key_monitor monitor;
-        key_monitor_implement_type crt_type;
 
     private:
         void on_key(int key, time_point time, bool down) {
-            if (down)
-                notify_key_down(key, time);
-            if (callback)
-                callback(key, time, down);
+            const auto type = crt_type.load(std::memory_order_relaxed);
+            latency.record_event(static_cast<size_t>(type), time, clock::now());
+            const key_event e{key, down, static_cast<std::uint8_t>(type), time};
+            pipe.push({&e, 1});
+            schedule_flush();
+        }
+        void on_poll(time_point time) {
+            latency.record_poll(static_cast<size_t>(crt_type.load(std::memory_order_relaxed)), time);
         }
 
     private:
@@ -44,33 +66,125 @@ namespace kps {
         }
 
     public:
-        void change_monitor_implement_type(key_monitor_implement_type type) {
+        /// <summary>
+        /// 创建一个按键监视器。创建失败时抛出异常。
+        /// </summary>
+        static std::shared_ptr<key_monitor_base> make_monitor(key_monitor_implement_type type) {
             switch (type) {
-            case monitor_implement_type_async:
-                change_monitor_implement_type(std::make_shared<key_monitor_async>());
-                break;
-            case monitor_implement_type_hook:
-                change_monitor_implement_type(std::make_shared<key_monitor_hook>());
-                break;
-            case monitor_implement_type_dinput:
-                change_monitor_implement_type(std::make_shared<key_monitor_dinput>());
-                break;
-            case monitor_implement_type_memory:
-                change_monitor_implement_type(std::make_shared<key_monitor_memory>());
-                break;
+            case monitor_implement_type_async: return std::make_shared<key_monitor_async>();
+            case monitor_implement_type_hook: return std::make_shared<key_monitor_hook>();
+            case monitor_implement_type_dinput: return std::make_shared<key_monitor_dinput>();
+            case monitor_implement_type_memory: return std::make_shared<key_monitor_memory>();
             default: throw std::invalid_argument("type not supported.");
             }
-            crt_type = type;
+        }
+        void change_monitor_implement_type(key_monitor_implement_type type) {
+            auto p = make_monitor(type);
+            crt_type = type; // 先于替换设置，使新的监视器的事件与轮询计入自己的统计。
+            change_monitor_implement_type(std::move(p));
         }
         key_monitor_implement_type get_monitor_implement_type() const {
             return crt_type;
         }
+        /// <summary>
+        /// 各监视方式的延迟与轮询抖动。在切换监视方式后仍保留之前的统计，以便比较。
+        /// </summary>
+        const monitor_latency& get_monitor_latency() const {
+            return latency;
+        }
+        void clear_monitor_latency() {
+            latency.clear();
+        }
+
+    private:
+        std::thread flush_thread; // 只在有被忽略或待定的边沿时醒来，转发已确定的边沿。
+
+        /// <summary>
+        /// 使转发线程不晚于抖动过滤的下一个截止时刻醒来。在处理事件或修改抖动过滤后调用。
+        /// </summary>
+        void schedule_flush() {
+            const auto deadline = pipe.configure([this] { return debounce.filter().next_deadline(); });
+            if (!deadline)
+                return;
+            std::lock_guard _(mutex_flush);
+            if (flush_at && *flush_at <= *deadline)
+                return; // 转发线程已经会及时醒来。
+            flush_at = deadline;
+            cv_flush.notify_one();
+        }
+        void flush_proc() {
+            std::unique_lock lock(mutex_flush);
+            while (!flush_exit) {
+                if (!flush_at) {
+                    cv_flush.wait(lock);
+                    continue;
+                }
+                if (const auto target = *flush_at; clock::now() < target) {
+                    cv_flush.wait_until(lock, target); // 期间 flush_at 可能提前。
+                    continue;
+                }
+                flush_at.reset();
+                lock.unlock();
+                pipe.flush(clock::now());
+                const auto next = pipe.configure([this] { return debounce.filter().next_deadline(); });
+                lock.lock();
+                if (next && (!flush_at || *next < *flush_at))
+                    flush_at = next;
+            }
+        }
 
     public:
-        kps(callback_t callback) : callback(callback) {
+        /// <summary>
+        /// 按键事件的处理管线。监视器的事件经过变换阶段后交给汇点，第一个汇点为 KPS 计算。
+        /// 应在启动时添加其他汇点。
+        /// </summary>
+        pipeline::event_pipeline& get_pipeline() {
+            return pipe;
+        }
+        /// <summary>
+        /// 设置按键抖动过滤。之前模式下待定的边沿会立即转发。
+        /// </summary>
+        /// <param name="min_interval">所有按键的最小间隔。</param>
+        /// <param name="overrides">单独设置最小间隔的按键。</param>
+        void set_debounce(debounce_mode mode, clock::duration min_interval,
+                          std::span<const std::pair<int, clock::duration>> overrides = {}) {
+            pipe.configure([&] {
+                pipe.flush(time_point::max());
+                auto& filter = debounce.filter();
+                filter.set_mode(mode);
+                filter.set_interval(min_interval);
+                for (const auto& [key, interval] : overrides)
+                    filter.set_interval(key, interval);
+            });
+            schedule_flush();
+        }
+        debounce_mode get_debounce_mode() {
+            return pipe.configure([this] { return debounce.filter().mode(); });
+        }
+        /// <returns>被抖动过滤丢弃的事件数。</returns>
+        std::uint64_t debounce_suppressed_count() {
+            return pipe.configure([this] { return debounce.filter().suppressed_count(); });
+        }
+
+    public:
+        kps() {
+            pipe.add_sink("calculator", [this](std::span<const key_event> events) {
+                for (const auto& e : events)
+                    if (e.down)
+                        notify_key_down(e.key, e.time);
+            });
+            flush_thread = std::thread(&kps::flush_proc, this);
             monitor.set_callback(std::bind_front(&kps::on_key, this));
+            monitor.set_poll_callback(std::bind_front(&kps::on_poll, this));
             change_monitor_implement_type(monitor_implement_type_dinput);
-            crt_type = monitor_implement_type_dinput;
+        }
+        ~kps() {
+            {
+                std::lock_guard _(mutex_flush);
+                flush_exit = true;
+            }
+            cv_flush.notify_one();
+            flush_thread.join();
         }
     };
 } // namespace kps
@@ -0,0 +1,20 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <cstdint>
+
+#include "kps_calculator.hpp"
+
+namespace kps {
+    /// <summary>
+    /// 一次按下或抬起。
+    /// </summary>
+    struct key_event {
+        int key{};
+        bool down{};
+        std::uint8_t source{}; // 来源的编号，例如 key_monitor_implement_type。
+        time_point time{};     // 监视器得知按键的时间。
+    };
+} // namespace kps
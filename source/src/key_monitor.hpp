@@ -20,8 +20,11 @@ namespace kps {
     public:
         using callback_t = key_monitor_base::callback_t;
 
+        using poll_callback_t = key_monitor_base::poll_callback_t;
+
     private:
         callback_t callback;
+        poll_callback_t poll_callback;
 
     public:
         /// <summary>
@@ -34,11 +37,21 @@ namespace kps {
                 implement->set_callback(callback);
         }
         /// <summary>
-        /// 清空回调函数。
+        /// 设置轮询回调函数。类型参见 poll_callback_t。
+        /// </summary>
+        void set_poll_callback(poll_callback_t func) {
+            std::lock_guard _(m);
+            poll_callback = func;
+            if (implement)
+                implement->set_poll_callback(poll_callback);
+        }
+        /// <summary>
+        /// 清空回调函数与轮询回调函数。
         /// </summary>
         void reset_callback() {
             std::lock_guard _(m);
             callback = callback_t();
+            poll_callback = poll_callback_t();
             if (implement)
                 implement->reset_callback();
         }
@@ -54,6 +67,7 @@ namespace kps {
             p->reset_callback();
             implement = p;
             p->set_callback(callback);
+            p->set_poll_callback(poll_callback);
         }
 
     public:
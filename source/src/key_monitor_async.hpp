@@ -24,6 +24,7 @@ namespace kps {
     private:
         using key_monitor_base::_on_llkey_down;
         using key_monitor_base::_on_llkey_up;
+        using key_monitor_base::_on_poll;
 
     public:
         /// <summary>
@@ -43,6 +44,7 @@ namespace kps {
             while (true) {
                 if (s_exit.try_acquire_for(10ms))
                     break;
+                _on_poll(clock::now());
                 for (int i = 1; i < 256; i++)
                     if (msb(GetAsyncKeyState(i)))
                         _on_llkey_down(i, clock::now());
@@ -52,6 +54,7 @@ namespace kps {
         }
 
     public:
+        key_monitor_async() : key_monitor_base("async") {}
         ~key_monitor_async() {
             s_exit.release();
             t.join();
@@ -4,10 +4,13 @@
 #pragma once
 
 #include <array>
+#include <format>
 #include <functional>
 #include <mutex>
+#include <string_view>
 
 #include "kps_calculator.hpp"
+#include "metrics/registry.hpp"
 
 namespace kps {
     /// <summary>
@@ -19,10 +22,15 @@ namespace kps {
         /// 回调函数的类型。使用 set_callback 注册回调函数。
         /// </summary>
         using callback_t = std::function<void(int key, time_point time, bool is_down)>;
+        /// <summary>
+        /// 轮询回调函数的类型。轮询方式每轮轮询开始时调用。使用 set_poll_callback 注册。
+        /// </summary>
+        using poll_callback_t = std::function<void(time_point time)>;
 
     private:
         std::mutex mutex_callback;
         callback_t callback;
+        poll_callback_t poll_callback;
 
     public:
         /// <summary>
@@ -33,16 +41,48 @@ namespace kps {
             callback = func;
         }
         /// <summary>
-        /// 清空回调函数。
+        /// 设置轮询回调函数。类型参见 poll_callback_t。
+        /// </summary>
+        void set_poll_callback(poll_callback_t func) {
+            std::lock_guard _(mutex_callback);
+            poll_callback = func;
+        }
+        /// <summary>
+        /// 清空回调函数与轮询回调函数。
         /// </summary>
         void reset_callback() {
             std::lock_guard _(mutex_callback);
             callback = callback_t();
+            poll_callback = poll_callback_t();
         }
 
     private:
         std::array<bool, 256> is_down{};
 
+    private:
+        metrics::sharded_counter& events_counter;     // 转发给回调函数的按下与抬起。
+        metrics::sharded_counter& suppressed_counter; // 因状态未变而被 is_down 去重的报告。
+        metrics::sharded_counter& polls_counter;
+        metrics::sharded_counter& failed_reads_counter;
+
+    protected:
+        /// <summary>
+        /// 由轮询的子类在每轮轮询开始时调用。
+        /// </summary>
+        /// <param name="time">本轮轮询的时间，与本轮报告的按键使用同一时间。</param>
+        void _on_poll(time_point time) {
+            polls_counter.add();
+            std::lock_guard _(mutex_callback);
+            if (poll_callback)
+                poll_callback(time);
+        }
+        /// <summary>
+        /// 由子类在读取设备状态或内存失败时调用。
+        /// </summary>
+        void _count_failed_read() {
+            failed_reads_counter.add();
+        }
+
     protected:
         /// <summary>
         /// 由 key_monitor_base 的子类调用。当得知某个键被按下时，即调用该函数。
@@ -52,10 +92,12 @@ namespace kps {
         void _on_llkey_down(int key, time_point time) {
             if (!is_down[key]) {
                 is_down[key] = true;
+                events_counter.add();
                 std::lock_guard _(mutex_callback);
                 if (callback)
                     callback(key, time, true);
-            }
+            } else
+                suppressed_counter.add();
         }
         /// <summary>
         /// 由 key_monitor_base 的子类调用。当得知某个键已抬起时，即调用该函数。
@@ -65,17 +107,32 @@ namespace kps {
         void _on_llkey_up(int key, time_point time) {
             if (is_down[key]) {
                 is_down[key] = false;
+                events_counter.add();
                 std::lock_guard _(mutex_callback);
                 if (callback)
                     callback(key, time, false);
-            }
+            } else
+                suppressed_counter.add();
         }
 
     public:
-        key_monitor_base() = default;
+        /// <param name="monitor_name">实现方式的名称，作为计数器的 monitor 标签。</param>
+        explicit key_monitor_base(std::string_view monitor_name)
+            : events_counter(counter("osu_kps_monitor_events_total", "Key edges ingested.", monitor_name)),
+              suppressed_counter(counter("osu_kps_monitor_suppressed_edges_total",
+                                         "Key reports dropped because the key state did not change.", monitor_name)),
+              polls_counter(counter("osu_kps_monitor_polls_total", "Polling iterations.", monitor_name)),
+              failed_reads_counter(counter("osu_kps_monitor_failed_reads_total",
+                                           "Failed device state or memory reads.", monitor_name)) {}
         key_monitor_base(const key_monitor_base&) = delete;
         key_monitor_base(key_monitor_base&&) = delete;
         key_monitor_base& operator=(const key_monitor_base&) = delete;
         key_monitor_base& operator=(key_monitor_base&&) = delete;
+
+    private:
+        static metrics::sharded_counter& counter(std::string_view name, std::string_view help,
+                                                 std::string_view monitor_name) {
+            return metrics::global().counter(name, help, std::format("monitor=\"{}\"", monitor_name));
+        }
     };
 } // namespace kps
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <array>
 #include <chrono>
 #include <thread>
 using namespace std::literals;
@@ -21,6 +22,7 @@ using namespace std::literals;
 #pragma comment(lib, "dxguid.lib")
 
 #include "key_monitor_base.hpp"
+#include "key_remap.hpp"
 #include "utils/d2d/SharedComPtr.hpp"
 
 namespace kps {
@@ -28,25 +30,55 @@ namespace kps {
     private:
         using key_monitor_base::_on_llkey_down;
         using key_monitor_base::_on_llkey_up;
+        using key_monitor_base::_count_failed_read;
+        using key_monitor_base::_on_poll;
+
+    private:
+        HKL layout{};                      // 构建 scan_codes 时的键盘布局。
+        key_remap_table scan_codes;        // 扫描码到虚拟键码。
+        std::array<bool, 256> scan_down{}; // 上一次读取到的各扫描码的状态。
+        /// <summary>
+        /// 键盘布局改变时重建 scan_codes。
+        /// </summary>
+        /// <returns>是否重建。重建后应报告所有按键的状态。</returns>
+        bool update_scan_codes() {
+            const HKL crt = GetKeyboardLayout(0);
+            if (crt == layout)
+                return false;
+            layout = crt;
+            scan_codes = key_remap_table::build([crt](int code) {
+                return static_cast<int>(MapVirtualKeyExW(static_cast<UINT>(code), MAPVK_VSC_TO_VK_EX, crt));
+            });
+            return true;
+        }
 
     private:
         void polling_thread_routine(std::stop_token st) {
             while (!st.stop_requested()) {
                 auto now = std::chrono::steady_clock::now();
+                _on_poll(now);
 
                 // Poll keyboard.
                 {
                     BYTE keyboard_state[256];
                     if (FAILED(keyboard_device->GetDeviceState(sizeof(keyboard_state), keyboard_state))) {
+                        _count_failed_read();
                         keyboard_device->Acquire();
                         continue;
                     }
+                    // 只转换状态改变的扫描码。
+                    const bool report_all = update_scan_codes();
                     for (int i = 0; i < 256; ++i) {
-                        auto code = MapVirtualKeyW(i, MAPVK_VSC_TO_VK_EX);
-                        if (!code) {
+                        const bool down = (keyboard_state[i] & 0x80) != 0;
+                        if (!report_all && down == scan_down[i]) {
+                            continue;
+                        }
+                        scan_down[i] = down;
+                        const int code = scan_codes[i];
+                        if (code == key_remap_table::dropped) {
                             continue;
                         }
-                        if (keyboard_state[i] & 0x80) {
+                        if (down) {
                             _on_llkey_down(code, now);
                         } else {
                             _on_llkey_up(code, now);
@@ -58,6 +90,7 @@ namespace kps {
                 {
                     DIMOUSESTATE mouse_state;
                     if (FAILED(mouse_device->GetDeviceState(sizeof(mouse_state), &mouse_state))) {
+                        _count_failed_read();
                         mouse_device->Acquire();
                         continue;
                     }
@@ -88,7 +121,7 @@ namespace kps {
         std::jthread polling_thread;
 
     public:
-        key_monitor_dinput() {
+        key_monitor_dinput() : key_monitor_base("dinput") {
             // Initialize DirectInput.
             if (FAILED(DirectInput8Create(GetModuleHandleW(nullptr), DIRECTINPUT_VERSION, IID_IDirectInput8W,
                                           reinterpret_cast<void**>(dinput.reset_and_get_address()), nullptr))) {
@@ -50,7 +50,7 @@ namespace kps {
         }
 
     public:
-        key_monitor_hook() {
+        key_monitor_hook() : key_monitor_base("hook") {
             k_hook.set_callback(std::bind(&key_monitor_hook::keyboard_proc, this, std::placeholders::_1,
                                           std::placeholders::_2, std::placeholders::_3));
             m_hook.set_callback(std::bind(&key_monitor_hook::mouse_proc, this, std::placeholders::_1,
@@ -17,6 +17,7 @@ using namespace std::literals;
 #include "MemoryReaderOsu.h"
 
 #include "key_monitor_base.hpp"
+#include "key_remap.hpp"
 
 namespace kps {
     /// <summary>
@@ -26,31 +27,42 @@ namespace kps {
     private:
         using key_monitor_base::_on_llkey_down;
         using key_monitor_base::_on_llkey_up;
+        using key_monitor_base::_count_failed_read;
+        using key_monitor_base::_on_poll;
 
     private:
         bool exit{false};
         std::thread t;
         orange::MemoryReaderOsu r;
+        const key_remap_table osu_keys = key_remap_table::osu_keys(); // osu! 的按键码到虚拟键码。
         void thread_proc() {
             while (!exit) {
                 auto now = clock::now();
-                auto keys = r.get_mania_keys();
+                _on_poll(now);
+                orange::MemoryReaderOsu::ReadStatus status;
+                auto keys = r.get_mania_keys(status);
+                if (status == orange::MemoryReaderOsu::ReadStatus::failed)
+                    _count_failed_read(); // 不在游玩中时也读不到按键，不计入。
                 if (!keys || (*keys).empty()) {
                     for (int i = 0; i < 256; i++)
                         _on_llkey_up(i, now);
                     continue;
                 }
 
-                for (const auto& t : *keys)
-                    if (t.second)
-                        _on_llkey_down(t.first, now);
+                for (const auto& [code, down] : *keys) {
+                    const int key = osu_keys.translate_osu_key(code);
+                    if (key == key_remap_table::dropped)
+                        continue;
+                    if (down)
+                        _on_llkey_down(key, now);
                     else
-                        _on_llkey_up(t.first, now);
+                        _on_llkey_up(key, now);
+                }
             }
         }
 
     public:
-        key_monitor_memory() {
+        key_monitor_memory() : key_monitor_base("memory") {
             t = std::thread(&key_monitor_memory::thread_proc, this);
         }
         ~key_monitor_memory() {
@@ -0,0 +1,67 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace kps {
+    /// <summary>
+    /// 将来源自己的按键码（如扫描码、osu! 的按键码）转换为虚拟键码的表。
+    /// 在来源或键盘布局改变时构建一次，之后每次转换只需查一次表。
+    /// </summary>
+    class key_remap_table {
+    public:
+        static constexpr size_t size = 256;
+        static constexpr int dropped = -1; // 没有对应虚拟键码的按键码。
+
+    private:
+        std::array<std::int16_t, size> table;
+
+    public:
+        /// <summary>
+        /// 不改变按键码的表。
+        /// </summary>
+        key_remap_table() {
+            for (size_t i = 0; i < size; i++)
+                table[i] = static_cast<std::int16_t>(i);
+        }
+        /// <summary>
+        /// 对 0 到 size - 1 的每个按键码调用一次 translate 构建表。
+        /// </summary>
+        /// <param name="translate">返回虚拟键码。返回值不在 1 到 size - 1 之间时，该按键码被丢弃。</param>
+        template <typename F>
+        static key_remap_table build(F&& translate) {
+            key_remap_table ret;
+            for (int code = 0; code < static_cast<int>(size); code++)
+                ret.set(code, translate(code));
+            return ret;
+        }
+        /// <summary>
+        /// osu! 的按键码为 System.Windows.Forms.Keys，低 16 位为虚拟键码，更高位为修饰键。
+        /// </summary>
+        static key_remap_table osu_keys() {
+            return build([](int code) { return code; });
+        }
+
+    public:
+        /// <param name="vk">虚拟键码。不在 1 到 size - 1 之间时丢弃 code。</param>
+        void set(int code, int vk) {
+            if (0 <= code && code < static_cast<int>(size))
+                table[static_cast<size_t>(code)] =
+                    static_cast<std::int16_t>(0 < vk && vk < static_cast<int>(size) ? vk : dropped);
+        }
+        /// <returns>虚拟键码，或 dropped。</returns>
+        int operator[](int code) const {
+            return static_cast<unsigned>(code) < size ? table[static_cast<size_t>(code)] : dropped;
+        }
+        /// <summary>
+        /// 转换 osu! 的按键码。忽略修饰键的位。
+        /// </summary>
+        int translate_osu_key(int code) const {
+            return (*this)[code & 0xFFFF];
+        }
+    };
+} // namespace kps
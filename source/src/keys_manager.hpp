@@ -3,14 +3,22 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <cstdint>
+#include <filesystem>
+#include <span>
 #include <stdexcept>
-#include <vector>
+#include <string>
 
+#include "utils/SeqLock.hpp"
 #include "utils/keyboard_char.hpp"
 
 #include "autoplay_manager.hpp"
 #include "kps_calculator.hpp"
+#include "kps_digest.hpp"
+#include "timing_statistics.hpp"
 
 /// <summary>
 /// 按键管理器。用于保存当前按键数量、获取当前各按键。主要用于获取画图时需要的信息。
@@ -26,24 +34,58 @@ private:
 private:
     kps::kps* src{};
 
-private:
-    autoplay_manager am;
-
-private:
-    std::array<std::vector<int>, max_key_count> keys;
-    int crt_button_count{default_key_count};
+public:
     struct key_info {
         bool down{};
         kps::time_point previous_down{};
         kps::time_point previous_up{};
         int times{};
     };
-    std::vector<key_info> extra_info{default_key_count};
+    /// <summary>
+    /// 某一时刻各列状态及统计信息的一致副本。
+    /// </summary>
+    struct snapshot_t {
+        int button_count{};
+        std::array<int, max_key_count> keys{}; // 当前键位。前 button_count 个有效。
+        std::array<key_info, max_key_count> columns{};
+        bool is_autoplay{};
+        int total_count{}; // 当前模式（手动或自动播放）下的总按键次数。
+        double max_kps{};  // 当前模式下的最大 KPS。
+
+        /// <returns>当前的按键集合（序列）。</returns>
+        std::span<const int> layout_keys() const {
+            return std::span(keys).first(static_cast<size_t>(button_count));
+        }
+        /// <returns>key 是否在当前键位中。</returns>
+        bool in_layout(int key) const {
+            const auto crt = layout_keys();
+            return std::find(crt.begin(), crt.end(), key) != crt.end();
+        }
+    };
+
+private:
+    /// <summary>
+    /// 写操作在 m 下修改成员后发布到 state，读者通过 state 无锁读取，不会阻塞监视器线程。
+    /// </summary>
+    orange::SeqLock<snapshot_t> state;
+
+private:
+    autoplay_manager am;
+
+private:
+    std::array<std::array<int, max_key_count>, max_key_count> keys{}; // keys[i] 的前 i + 1 个元素为 i + 1 键的键位。
+    int crt_button_count{default_key_count};
+    using column_mask_t = std::uint16_t;
+    static_assert(sizeof(column_mask_t) * 8 >= max_key_count);
+    std::array<column_mask_t, 256> key_columns{}; // 当前键位下，各按键对应的列。第 i 位表示第 i 列。
+    std::array<key_info, max_key_count> extra_info{};
+    kps::timing_statistics<max_key_count> timing; // 各列按键时长与间隔的统计。只统计手动游玩。
     // 其他统计信息。
 private:
     bool is_autoplay{};
     int total_count{}, total_count_auto{};
-    double max_kps{}, max_kps_auto{};
+    double max_kps{}; // 进入自动播放或状态切换前，手动游玩的最大 KPS。此后的最大 KPS 由 src 统计。
+    kps::kps_digest kps_distribution; // 手动游玩时 KPS 的分布。
 
 public:
     /// <summary>
@@ -53,51 +95,75 @@ public:
     /// <param name="time"></param>
     void update_on_key_down(int key, kps::time_point time, bool down) {
         std::lock_guard _(m);
+        unsigned columns = 0 <= key && key < static_cast<int>(key_columns.size()) ? key_columns[key] : 0u;
+        if (!columns)
+            return;
         if (down) {
-            const auto& crt_keys = keys[crt_button_count - 1];
-            for (size_t i = 0; i < crt_keys.size(); i++)
-                if (key == crt_keys[i]) {
-                    extra_info[i].down = true;
-                    extra_info[i].times++;
-                    extra_info[i].previous_down = time;
-                }
-
-            if (std::count(crt_keys.begin(), crt_keys.end(), key)) {
-                if (is_autoplay)
-                    ++total_count_auto;
-                else
-                    ++total_count;
+            for (; columns; columns &= columns - 1) {
+                auto column = static_cast<size_t>(std::countr_zero(columns));
+                auto& info = extra_info[column];
+                if (!is_autoplay && info.previous_down != kps::time_point{})
+                    timing.record(column, timing_metric::interval, time - info.previous_down);
+                info.down = true;
+                info.times++;
+                info.previous_down = time;
             }
 
-            if (src) {
-                if (is_autoplay)
-                    max_kps_auto = std::max(max_kps_auto, src->calc_kps_now(crt_keys));
-                else
-                    max_kps = std::max(max_kps, src->calc_kps_now(crt_keys));
-            }
+            if (is_autoplay)
+                ++total_count_auto;
+            else
+                ++total_count;
         } else {
-            const auto& crt_keys = keys[crt_button_count - 1];
-            for (size_t i = 0; i < crt_keys.size(); i++)
-                if (key == crt_keys[i]) {
-                    extra_info[i].down = false;
-                    extra_info[i].previous_up = time;
-                }
+            for (; columns; columns &= columns - 1) {
+                auto column = static_cast<size_t>(std::countr_zero(columns));
+                auto& info = extra_info[column];
+                if (!is_autoplay && info.down)
+                    timing.record(column, timing_metric::hold, time - info.previous_down);
+                info.down = false;
+                info.previous_up = time;
+            }
         }
+        publish();
+    }
+
+private:
+    /// <summary>
+    /// 将当前状态发布给读者。保证调用该函数时已上锁。
+    /// </summary>
+    void publish() {
+        snapshot_t crt;
+        crt.button_count = crt_button_count;
+        std::ranges::copy(get_keys(), crt.keys.begin());
+        crt.columns = extra_info;
+        crt.is_autoplay = is_autoplay;
+        crt.total_count = is_autoplay ? total_count_auto : total_count;
+        crt.max_kps = max_kps; // 由 snapshot 与 src 中的值合并。
+        state.store(crt);
+    }
+
+public:
+    /// <summary>
+    /// 无锁地获取各列状态及统计信息的一致副本。可以在任意线程调用。
+    /// </summary>
+    snapshot_t snapshot() const {
+        auto ret = state.load();
+        double crt = src ? src->get_max_kps() : 0;
+        ret.max_kps = ret.is_autoplay ? crt : std::max(ret.max_kps, crt);
+        return ret;
     }
 
 public:
     keys_manager(kps::kps* source)
         : src(source), am(source, std::bind(&keys_manager::autoplay_manager_callback, this, std::placeholders::_1)) {
-        using vk = keyboard_char::vk;
-        for (unsigned i = 0; i < max_key_count; i++)
-            keys[i].resize(i + 1);
+        std::lock_guard _(m);
+        publish();
     }
     /// <summary>
     /// 获取当前按键数量。
     /// </summary>
     /// <returns></returns>
     int get_button_count() const {
-        return crt_button_count;
+        return state.load().button_count;
     }
     /// <summary>
     /// 修改当前按键数量。该方法只能运行在主线程。
@@ -108,38 +174,131 @@ public:
         if (!(1 <= new_button_count && new_button_count <= static_cast<int>(keys.size())))
             throw std::invalid_argument("new_button_count should be in [1, keys.size()].");
         crt_button_count = new_button_count;
-        extra_info.clear();
-        extra_info.resize(crt_button_count);
+        extra_info.fill({});
+        timing.clear();
+        on_layout_changed();
+        publish();
     }
     /// <summary>
-    /// 获取当前的按键集合（序列）。只有主线程才应在外部调用该函数。
+    /// 获取当前的按键集合（序列）。只有主线程才应在外部调用该函数，其他线程使用 snapshot().layout_keys()。
     /// </summary>
     /// <returns></returns>
-    const std::vector<int>& get_keys() const {
-        return keys[static_cast<size_t>(crt_button_count) - 1];
+    std::span<const int> get_keys() const {
+        return std::span(keys[static_cast<size_t>(crt_button_count) - 1]).first(static_cast<size_t>(crt_button_count));
     }
     /// <summary>
-    /// 修改其中的某个按键。只有主线程才应在外部调用该函数。该函数不加锁。
+    /// 修改其中的某个按键。只有主线程才应在外部调用该函数。
     /// </summary>
     /// <param name="button_count">几键。从 1 开始。</param>
     /// <param name="which">从左到右第几个键。从 0 开始。</param>
     /// <param name="new_key">新的键位。需自行保证 keyboard_char 支持，不做额外检查。</param>
     void modify_key(int button_count, int which, int new_key) {
+        std::lock_guard _(m);
         keys[static_cast<size_t>(button_count) - 1][static_cast<size_t>(which)] = new_key;
+        if (button_count == crt_button_count) {
+            on_layout_changed();
+            publish();
+        }
     }
 
 private:
+    /// <summary>
+    /// 当前键位改变后，重建 key_columns，并让 src 按当前的按键集合统计最大 KPS。
+    /// </summary>
+    void on_layout_changed() {
+        key_columns.fill(0);
+        auto crt_keys = get_keys();
+        for (size_t i = 0; i < crt_keys.size(); i++)
+            if (0 <= crt_keys[i] && crt_keys[i] < static_cast<int>(key_columns.size()))
+                key_columns[crt_keys[i]] |= static_cast<column_mask_t>(1u << i);
+        if (src)
+            src->set_max_kps_keys(crt_keys);
+    }
     void autoplay_manager_callback(autoplay_manager::status_t crt) {
         std::lock_guard _(m);
         total_count_auto = 0;
-        max_kps_auto = 0;
+        // 保存手动游玩的最大 KPS，之后 src 重新开始统计。
+        if (src) {
+            if (!is_autoplay)
+                max_kps = std::max(max_kps, src->get_max_kps());
+            src->clear_max_kps();
+        }
         is_autoplay = crt == autoplay_manager::status_t::auto_play;
+        publish();
+    }
+
+public:
+    /// <summary>
+    /// 采样当前按键集合的 KPS，计入 KPS 的分布。应以固定频率调用。
+    /// 只统计手动游玩且 KPS 不为 0 的时刻，以免空闲时间占据分布。
+    /// </summary>
+    void sample_kps() {
+        // 按快照中的键位计算，不在持有 m 时等待计算器的锁。
+        const auto crt_state = snapshot();
+        if (crt_state.is_autoplay || !src)
+            return;
+        double crt = src->calc_kps_now(crt_state.layout_keys());
+        if (crt <= 0)
+            return;
+        std::lock_guard _(m);
+        if (!is_autoplay)
+            kps_distribution.add(crt);
+    }
+    /// <summary>
+    /// 获取 KPS 分布的副本，用于显示分位数或导出。
+    /// </summary>
+    kps::kps_digest get_kps_distribution() {
+        std::lock_guard _(m);
+        return kps_distribution;
+    }
+    /// <summary>
+    /// 并入其他会话导出的 KPS 分布。
+    /// </summary>
+    void merge_kps_distribution(const kps::kps_digest& other) {
+        std::lock_guard _(m);
+        kps_distribution.merge(other);
+    }
+    /// <summary>
+    /// 清空 KPS 的分布。
+    /// </summary>
+    void clear_kps_distribution() {
+        std::lock_guard _(m);
+        kps_distribution.clear();
+    }
+
+public:
+    using timing_metric = kps::timing_statistics<max_key_count>::metric;
+    /// <summary>
+    /// 无锁地获取第 idx 列按键时长或间隔的统计。可以在任意线程调用。时间以微秒为单位。
+    /// </summary>
+    /// <param name="idx">从 0 开始的下标。</param>
+    kps::timing_statistics<max_key_count>::snapshot_t timing_statistics_by_index(size_t idx, timing_metric which) const {
+        return timing.snapshot(idx, which);
+    }
+    /// <summary>
+    /// 生成各列按键时长与间隔的统计表。可以在任意线程调用。
+    /// </summary>
+    std::wstring timing_statistics_report() const {
+        return timing.report();
+    }
+    /// <summary>
+    /// 将各列按键时长与间隔的统计表和直方图写入文件。可以在任意线程调用。
+    /// </summary>
+    bool write_timing_statistics(const std::filesystem::path& path) const {
+        return timing.write_to_file(path);
+    }
+    /// <summary>
+    /// 清空按键时长与间隔的统计。
+    /// </summary>
+    void clear_timing_statistics() {
+        std::lock_guard _(m);
+        timing.clear();
     }
 
 public:
     /// <returns>总按键次数。</returns>
     int get_total_count() const {
-        return is_autoplay ? total_count_auto : total_count;
+        return state.load().total_count;
     }
     /// <summary>
     /// 清空总按键次数。
@@ -148,10 +307,11 @@ public:
         std::lock_guard _(m);
         total_count = 0;
         total_count_auto = 0;
+        publish();
     }
     /// <returns>最大 KPS。</returns>
     double get_max_kps() const {
-        return is_autoplay ? max_kps_auto : max_kps;
+        return snapshot().max_kps;
     }
     /// <summary>
     /// 清空最大 KPS。
@@ -159,34 +319,36 @@ public:
     void clear_max_kps() {
         std::lock_guard _(m);
         max_kps = 0;
-        max_kps_auto = 0;
+        if (src)
+            src->clear_max_kps();
+        publish();
     }
     /// <summary>
-    /// 获取第 idx 个按键上一次放开的时间。
+    /// 获取第 idx 个按键上一次放开的时间。需要同时读取多列时，使用 snapshot。
     /// </summary>
     /// <param name="idx">从 0 开始的下标。</param>
-    kps::time_point previous_up_by_index(size_t idx) {
-        return extra_info[idx].previous_up;
+    kps::time_point previous_up_by_index(size_t idx) const {
+        return state.load().columns[idx].previous_up;
     }
     /// <summary>
-    /// 获取第 idx 个按键上一次按下的时间。
+    /// 获取第 idx 个按键上一次按下的时间。需要同时读取多列时，使用 snapshot。
     /// </summary>
     /// <param name="idx">从 0 开始的下标。</param>
-    kps::time_point previous_down_by_index(size_t idx) {
-        return extra_info[idx].previous_down;
+    kps::time_point previous_down_by_index(size_t idx) const {
+        return state.load().columns[idx].previous_down;
     }
     /// <summary>
-    /// 获取第 idx 个按键是否被按下。
+    /// 获取第 idx 个按键是否被按下。需要同时读取多列时，使用 snapshot。
     /// </summary>
     /// <param name="idx">从 0 开始的下标。</param>
-    bool down_by_index(size_t idx) {
-        return extra_info[idx].down;
+    bool down_by_index(size_t idx) const {
+        return state.load().columns[idx].down;
     }
     /// <summary>
     /// 获取当前是否应当以自动播放的模式显示。
     /// </summary>
     /// <returns></returns>
     bool is_autoplay_display() const {
-        return is_autoplay;
+        return state.load().is_autoplay;
     }
 };
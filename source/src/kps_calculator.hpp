@@ -5,16 +5,25 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <deque>
+#include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <numeric>
+#include <span>
+#include <string>
+#include <string_view>
 #include <tuple>
 #include <unordered_set>
 #include <vector>
 
+#include "metrics/registry.hpp"
+
 namespace kps {
     using clock = std::chrono::steady_clock;
     using time_point = std::chrono::time_point<clock>;
@@ -29,44 +38,69 @@ namespace kps {
     private:
         deque_t records;                             // 按键记录。按时间（第二个元素）升序。
         std::array<deque_t, 256> records_individual; // 各按键的按键记录。
-    public:
-        using callback_t = std::function<void(int, time_point)>;
 
-    private:
-        callback_t callback; // 按键时的回调函数。
+        std::array<bool, 256> max_kps_keys{}; // 统计最大 KPS 时考虑的按键集合。
+        std::atomic<double> max_kps{};        // 按键集合的最大 KPS。只由监视器线程写入，可以随时无锁读取。
     public:
+        using callback_t = std::function<void(int, time_point)>;
         using id_t = unsigned long long;
 
     private:
-        unsigned long long callback_id; // 回调函数的标志 id。
+        struct subscriber {
+            id_t id;
+            callback_t func;
+        };
+        using subscriber_list = std::vector<subscriber>;
+        /// <summary>
+        /// 按键时的回调函数。修改时复制整个列表再替换，遍历时只需原子地取得当前列表，不必加锁。
+        /// </summary>
+        std::atomic<std::shared_ptr<const subscriber_list>> subscribers{std::make_shared<const subscriber_list>()};
+        std::mutex mutex_subscribers;        // 只在修改 subscribers 时使用，保证修改不会丢失。
+        std::recursive_mutex mutex_dispatch; // 通知期间持有，使取消注册可以等待正在进行的调用结束。先于 m 加锁。
 
-    private:
+    public:
         /// <summary>
-        /// 注册回调函数。按键时会被调用。
-        /// 调用线程与监视器线程相同。保证调用该函数时已上锁。不要再次上锁！
-        /// 会覆盖之前注册的回调函数。
+        /// 注册回调函数。按键时会被调用，多个回调函数按注册的顺序调用。
+        /// 调用线程与监视器线程相同。调用时不持有按键记录的锁，回调函数中可以查询 KPS。
+        /// 可以在任意线程调用，包括在回调函数中。注册后的下一次按键开始生效。
         /// </summary>
         /// <param name="func">注册的回调函数。</param>
-        /// <param name="id">回调函数的标志 id。需要在取消注册时提供。</param>
+        /// <param name="id">回调函数的标志 id。需要在取消注册时提供。已有相同 id 的回调函数时将其替换。</param>
         void register_callback(callback_t func, id_t id) {
-            std::lock_guard _(m);
-            callback = func;
-            callback_id = id;
+            std::lock_guard _(mutex_subscribers);
+            auto list = std::make_shared<subscriber_list>(*subscribers.load());
+            auto it = std::ranges::find(*list, id, &subscriber::id);
+            if (it != list->end())
+                it->func = std::move(func);
+            else
+                list->push_back({id, std::move(func)});
+            subscribers.store(std::move(list));
         }
         /// <summary>
         /// 取消注册回调函数。
-        /// 有可能调用该函数时回调函数正在被调用，此时将在回调函数运行结束后再取消注册。
+        /// 在其他线程调用时，会等待正在进行的通知结束，所以返回后该回调函数不会再被调用。
+        /// 在回调函数中调用时，本次通知中排在后面的回调函数仍会被调用。
+        /// 不能在持有 m 时从其他线程调用，否则可能与正在加锁的回调函数死锁。
         /// </summary>
         /// <param name="id">用于标志的 id。仅当 id 与注册时的相同时，取消注册才会成功。</param>
         /// <returns>是否取消注册成功。即 id 是否匹配。</returns>
         bool unregister_callback(id_t id) {
-            std::lock_guard _(m);
-            if (callback_id == id) {
-                callback = callback_t();
-                id = id_t();
-                return true;
-            }
-            return false;
+            std::lock_guard _(mutex_subscribers);
+            auto crt = subscribers.load();
+            if (std::ranges::find(*crt, id, &subscriber::id) == crt->end())
+                return false;
+            auto list = std::make_shared<subscriber_list>();
+            list->reserve(crt->size() - 1);
+            for (const auto& s : *crt)
+                if (s.id != id)
+                    list->push_back(s);
+            subscribers.store(std::move(list));
+            std::lock_guard __(mutex_dispatch); // 等待已取得旧列表的通知结束。
+            return true;
+        }
+        /// <returns>已注册的回调函数的个数。</returns>
+        size_t callback_count() const {
+            return subscribers.load()->size();
         }
 
     public:
@@ -86,6 +120,19 @@ namespace kps {
             for (auto& t : records_individual)
                 t.clear();
         }
+        /// <summary>
+        /// 获取按键集合（参见 kps_calculator::set_max_kps_keys）自上次清空以来的最大 KPS。不加锁。
+        /// </summary>
+        double get_max_kps() const {
+            return max_kps.load(std::memory_order_relaxed);
+        }
+        /// <summary>
+        /// 清空最大 KPS。
+        /// </summary>
+        void clear_max_kps() {
+            std::lock_guard _(m);
+            max_kps.store(0, std::memory_order_relaxed);
+        }
 
     protected:
         /// <summary>
@@ -94,16 +141,24 @@ namespace kps {
         /// <param name="key">按的键。</param>
         /// <param name="time">按键时间。</param>
         void notify_key_down(int key, time_point time) {
-            std::lock_guard _(m);
-            records.push_back({key, time});
-            records_individual[key].push_back({key, time});
-            if (callback)
-                callback(key, time);
+            std::lock_guard _(mutex_dispatch);
+            std::shared_ptr<const subscriber_list> list;
+            {
+                // 在同一次加锁中追加记录并取得列表，与 kps_implement_* 的构造函数配合，使每个按键恰好被计入一次。
+                std::lock_guard __(m);
+                records.push_back({key, time});
+                records_individual[key].push_back({key, time});
+                list = subscribers.load();
+            }
+            // 不持有 m，回调函数需要访问按键记录时自行加锁。
+            for (const auto& s : *list)
+                s.func(key, time);
         }
 
         friend class kps_implement_base;
         friend class kps_implement_hard;
         friend class kps_implement_sensitive;
+        friend class kps_calculator;
     };
 
     enum class kps_implement_type {
@@ -114,12 +169,117 @@ namespace kps {
     inline constexpr size_t history_count = 300; // 历史记录个数，一秒记录一次。
     using history_array = std::array<double, history_count>;
 
+    /// <summary>
+    /// 带时间戳的最近 KPS。
+    /// </summary>
+    struct stamped_history {
+        history_array values{};
+        long long first_second{};   // values[0] 对应时间区间的左端点，为自时钟纪元起的秒数。
+        std::uint64_t generation{}; // 记录被清空、计算方法或按键集合改变时递增，从 1 开始。
+    };
+
     class kps_implement_base {
     protected:
         kps_interface* src;
 
+    private:
+        std::deque<time_point> max_window; // 最大 KPS 的按键集合中，仍可能影响 KPS 的按键时间。升序。
+        double own_max_kps;                // 该计算方法的最大 KPS。只有正在显示的计算方法同步到 src->max_kps。
+        bool active{};                     // 是否正在显示。
+
+        metrics::sharded_counter& maintenance_events;
+        metrics::sharded_counter& maintenance_nanoseconds;
+
+    private:
+        /// <summary>
+        /// 按键回调。记录增量维护的次数与耗时。
+        /// </summary>
+        void on_key_down(int key, time_point time) {
+            const auto start = clock::now();
+            {
+                std::lock_guard _(src->m);
+                // 只有监视器线程追加记录，记录为空说明该按键在通知前已被清空。
+                if (src->records.empty())
+                    return;
+                on_key_down_implement(key, time);
+            }
+            maintenance_events.add();
+            maintenance_nanoseconds.add(static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count()));
+        }
+        /// <summary>
+        /// 增量维护子类数据。保证调用该函数时已上锁。
+        /// </summary>
+        virtual void on_key_down_implement(int key, time_point time) = 0;
+
+    protected:
+        /// <summary>
+        /// 注册按键回调。由子类在构造函数中持有 src->m 时调用。
+        /// </summary>
+        void subscribe() {
+            src->register_callback(std::bind_front(&kps_implement_base::on_key_down, this),
+                                   reinterpret_cast<kps_interface::id_t>(this));
+        }
+        /// <summary>
+        /// 取消注册按键回调。由子类在析构函数中不持有 src->m 时调用，返回后不会再被调用。
+        /// </summary>
+        void unsubscribe() {
+            src->unregister_callback(reinterpret_cast<kps_interface::id_t>(this));
+        }
+
+    protected:
+        /// <summary>
+        /// 增量更新最大 KPS。由子类在按键回调中调用。保证调用该函数时已上锁。
+        /// KPS 在两次按键之间不会增大，所以只需在按下的时刻求值，得到的最大值是精确的。
+        /// </summary>
+        void update_max_kps(int key, time_point time) {
+            if (!src->max_kps_keys[key])
+                return;
+            max_window.push_back(time);
+            while (time - max_window.front() > max_window_length())
+                max_window.pop_front();
+            double crt = calc_kps_at_press_implement(max_window);
+            own_max_kps = std::max(own_max_kps, crt);
+            if (active && crt > src->max_kps.load(std::memory_order_relaxed))
+                src->max_kps.store(crt, std::memory_order_relaxed);
+        }
+        /// <summary>
+        /// 根据已有的按键记录重建 max_window。保证调用该函数时已上锁。
+        /// </summary>
+        void rebuild_max_window() {
+            max_window.clear();
+            const auto& r = src->records;
+            for (size_t i = r.size(); i--;) {
+                const auto& [key, time] = r[i];
+                if (std::get<1>(r.back()) - time > max_window_length())
+                    break;
+                if (src->max_kps_keys[key])
+                    max_window.push_front(time);
+            }
+        }
+
+    private:
+        /// <summary>
+        /// 可能影响 KPS 的按键的最远时间。
+        /// </summary>
+        virtual clock::duration max_window_length() const = 0;
+        /// <summary>
+        /// 计算恰好在最后一次按键时刻的 KPS。
+        /// </summary>
+        /// <param name="window">按键集合中不超过 max_window_length 的按键时间，升序。</param>
+        virtual double calc_kps_at_press_implement(const std::deque<time_point>& window) const = 0;
+
     public:
-        kps_implement_base(kps_interface* src) : src(src) {}
+        /// <param name="method">计算方法的名称，作为计数器的 method 标签。</param>
+        kps_implement_base(kps_interface* src, std::string_view method)
+            : src(src), own_max_kps(src->get_max_kps()),
+              maintenance_events(metrics::global().counter("osu_kps_calculator_maintenance_events_total",
+                                                           "Key presses applied incrementally by each KPS method.",
+                                                           method_label(method))),
+              maintenance_nanoseconds(metrics::global().counter(
+                  "osu_kps_calculator_maintenance_seconds_total",
+                  "Time spent applying key presses incrementally in each KPS method.", method_label(method), 1e-9)) {}
+        virtual ~kps_implement_base() = default;
         kps_implement_base(const kps_implement_base&) = delete;
         kps_implement_base(kps_implement_base&&) = delete;
         kps_implement_base& operator=(const kps_implement_base&) = delete;
@@ -130,8 +290,38 @@ namespace kps {
         void clear() {
             std::lock_guard _(src->m);
             src->clear();
+            max_window.clear();
             clear_implement();
         }
+        /// <summary>
+        /// 设置是否正在显示。开始显示时，src 的最大 KPS 变为该计算方法的最大 KPS。
+        /// </summary>
+        void set_active(bool whether) {
+            std::lock_guard _(src->m);
+            active = whether;
+            if (active)
+                src->max_kps.store(own_max_kps, std::memory_order_relaxed);
+        }
+        /// <summary>
+        /// 清空该计算方法的最大 KPS。
+        /// </summary>
+        void clear_max_kps() {
+            std::lock_guard _(src->m);
+            own_max_kps = 0;
+            if (active)
+                src->max_kps.store(0, std::memory_order_relaxed);
+        }
+        /// <summary>
+        /// 设置统计最大 KPS 的按键集合。
+        /// </summary>
+        void set_max_kps_keys(std::span<const int> keys) {
+            std::lock_guard _(src->m);
+            src->max_kps_keys.fill(false);
+            for (int key : keys)
+                if (0 <= key && key < static_cast<int>(src->max_kps_keys.size()))
+                    src->max_kps_keys[key] = true;
+            rebuild_max_window();
+        }
 
     private:
         /// <summary>
@@ -149,7 +339,7 @@ namespace kps {
         /// </summary>
         /// <param name="key"></param>
         /// <returns></returns>
-        virtual double calc_kps_now_implement(const std::vector<int>& keys) {
+        virtual double calc_kps_now_implement(std::span<const int> keys) {
             return std::accumulate(keys.begin(), keys.end(), 0.0,
                                    [this](double pre, int key) { return pre + calc_kps_now_implement(key); });
         }
@@ -157,21 +347,38 @@ namespace kps {
         /// 计算最近的 kps。通过 src 访问数据。保证在被调用时 src 不会发生写操作。
         /// </summary>
         /// <param name="key"></param>
+        /// <param name="now">最后一个时间区间的右端点，是整秒。</param>
         /// <returns></returns>
-        virtual history_array calc_kps_recent_implement(const std::unordered_set<int>& keys) = 0;
+        virtual history_array calc_kps_recent_implement(const std::unordered_set<int>& keys, time_point now) = 0;
 
     public:
         double calc_kps_now(int key) {
             std::lock_guard _(src->m);
             return calc_kps_now_implement(key);
         }
-        double calc_kps_now(const std::vector<int>& keys) {
+        double calc_kps_now(std::span<const int> keys) {
             std::lock_guard _(src->m);
             return calc_kps_now_implement(keys);
         }
-        history_array calc_kps_recent(const std::unordered_set<int>& keys) {
+        /// <summary>
+        /// 计算最近的 kps。
+        /// </summary>
+        /// <param name="now">最后一个时间区间的右端点，由 history_end 得到。</param>
+        history_array calc_kps_recent(const std::unordered_set<int>& keys, time_point now) {
             std::lock_guard _(src->m);
-            return calc_kps_recent_implement(keys);
+            return calc_kps_recent_implement(keys, now);
+        }
+        /// <summary>
+        /// 将时间向上取整到整秒，作为最近 KPS 最后一个时间区间的右端点。
+        /// </summary>
+        static long long history_end(time_point now) {
+            return static_cast<long long>(
+                std::ceil(std::chrono::duration_cast<std::chrono::duration<double>>(now.time_since_epoch()).count()));
+        }
+
+    private:
+        static std::string method_label(std::string_view method) {
+            return "method=\"" + std::string(method) + "\"";
         }
     };
 
@@ -193,22 +400,42 @@ namespace kps {
         }
 
     public:
-        kps_implement_hard(kps_interface* src) : kps_implement_base(src) {
-            src->register_callback(
-                std::bind(&kps_implement_hard::on_key_down, this, std::placeholders::_1, std::placeholders::_2),
-                reinterpret_cast<kps_interface::id_t>(this));
-
+        kps_implement_hard(kps_interface* src) : kps_implement_base(src, "hard") {
+            // 在同一次加锁中注册并统计已有的记录，使每个按键恰好被计入一次。
             std::lock_guard _(src->m);
+            subscribe();
             for (const auto& [key, time] : src->records)
                 sum[key]++;
+            rebuild_max_window();
         }
         ~kps_implement_hard() {
-            src->unregister_callback(reinterpret_cast<kps_interface::id_t>(this));
+            unsubscribe(); // 等待正在进行的通知结束。
         }
 
     private:
-        void on_key_down(int key, time_point) {
+        /// <summary>
+        /// 移出在 now 时已不影响当前 KPS 的记录。
+        /// </summary>
+        void advance(time_point now) {
+            while (start_index < src->records.size() && now - std::get<1>(src->records[start_index]) > frame_length) {
+                sum[std::get<0>(src->records[start_index])]--;
+                start_index++;
+            }
+        }
+        void on_key_down_implement(int key, time_point time) override {
             sum[key]++;
+            update_max_kps(key, time);
+            // 查询的时间不早于按键的时间，所以可以提前移动下标。不显示时也不会在切换后积压。
+            advance(time);
+            while (recent_pivot < src->records.size() &&
+                   time - std::get<1>(src->records[recent_pivot]) > 1s * history_count + frame_length)
+                recent_pivot++;
+        }
+        virtual clock::duration max_window_length() const override {
+            return frame_length;
+        }
+        virtual double calc_kps_at_press_implement(const std::deque<time_point>& window) const override {
+            return static_cast<double>(window.size());
         }
         virtual void clear_implement() override {
             start_index = 0;
@@ -216,19 +443,12 @@ namespace kps {
             recent_pivot = 0;
         }
         virtual double calc_kps_now_implement(int key) override {
-            auto now = clock::now();
-            while (start_index < src->records.size() && now - std::get<1>(src->records[start_index]) > frame_length) {
-                sum[std::get<0>(src->records[start_index])]--;
-                start_index++;
-            }
+            advance(clock::now());
             return sum[key];
         }
-        virtual history_array calc_kps_recent_implement(const std::unordered_set<int>& keys) override {
+        virtual history_array calc_kps_recent_implement(const std::unordered_set<int>& keys,
+                                                        time_point now) override {
             auto get_time = [&](size_t idx) { return std::get<1>(src->records[idx]); };
-            auto now = clock::now();
-            long long integral_second =
-                std::ceil(std::chrono::duration_cast<std::chrono::duration<double>>(now.time_since_epoch()).count());
-            now = clock::time_point(std::chrono::duration_cast<clock::duration>(std::chrono::seconds(integral_second)));
             if (src->records.size() && record_stamp == get_time(src->records.size() - 1) && cache_stamp == now &&
                 keys == cache_keys)
                 return cache;
@@ -256,7 +476,7 @@ namespace kps {
                         count--;
                     left++;
                 }
-                ret[crt_time] = count;
+                ret[crt_time] = static_cast<double>(count);
                 // 用当前时间区间内的点更新。
                 while (right < src->records.size() && get_time(right) < real_time_point_right) {
                     if (keys.count(std::get<0>(src->records[right])))
@@ -305,17 +525,41 @@ namespace kps {
         }
 
     public:
-        kps_implement_sensitive(kps_interface* src) : kps_implement_base(src) {
-            src->register_callback(
-                std::bind(&kps_implement_sensitive::on_key_down, this, std::placeholders::_1, std::placeholders::_2),
-                reinterpret_cast<kps_interface::id_t>(this));
+        kps_implement_sensitive(kps_interface* src) : kps_implement_base(src, "sensitive") {
+            std::lock_guard _(src->m);
+            subscribe();
+            rebuild_max_window();
         }
         ~kps_implement_sensitive() {
-            src->unregister_callback(reinterpret_cast<kps_interface::id_t>(this));
+            unsubscribe(); // 等待正在进行的通知结束。
         }
 
     private:
-        void on_key_down(int key, time_point) {}
+        void on_key_down_implement(int key, time_point time) override {
+            update_max_kps(key, time);
+            // 查询的时间不早于按键的时间，所以可以提前移动下标。
+            while (recent_pivot < src->records.size() &&
+                   time - std::get<1>(src->records[recent_pivot]) > 1s * history_count + considered_length)
+                recent_pivot++;
+        }
+        virtual clock::duration max_window_length() const override {
+            return considered_length;
+        }
+        virtual double calc_kps_at_press_implement(const std::deque<time_point>& window) const override {
+            // 与 calc_kps_now_implement 相同的定义，但不提前退出，以得到精确值。
+            double ret = 0;
+            auto now = window.back();
+            size_t crt_count = 0;
+            for (auto it = window.rbegin(); it != window.rend(); it++) {
+                crt_count++;
+                double elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(now - *it).count();
+                double crt_kps = static_cast<double>(crt_count) * 1.5;
+                if (elapsed > 0)
+                    crt_kps = std::min(crt_kps, static_cast<double>(crt_count) / elapsed);
+                ret = std::max(ret, crt_kps);
+            }
+            return ret;
+        }
         virtual void clear_implement() override {
             std::fill(pre_farthest.begin(), pre_farthest.end(), size_t());
             pre_farthest_multi = size_t();
@@ -337,7 +581,8 @@ namespace kps {
                 crt_count++;
                 double elapsed =
                     std::chrono::duration_cast<std::chrono::duration<double>>(now - std::get<1>(r[farthest])).count();
-                double crt_kps = std::min(crt_count * 1.5, crt_count / elapsed);
+                double crt_kps =
+                    std::min(static_cast<double>(crt_count) * 1.5, static_cast<double>(crt_count) / elapsed);
                 if (crt_kps >= ret)
                     ret = crt_kps;
                 else
@@ -347,7 +592,7 @@ namespace kps {
 
             return ret;
         }
-        virtual double calc_kps_now_implement(const std::vector<int>& keys) override {
+        virtual double calc_kps_now_implement(std::span<const int> keys) override {
             auto now = clock::now();
             const auto& r = src->records;
             std::unordered_set<int> keys_set(keys.begin(), keys.end());
@@ -368,7 +613,8 @@ namespace kps {
                     double elapsed =
                         std::chrono::duration_cast<std::chrono::duration<double>>(now - std::get<1>(r[farthest]))
                             .count();
-                    double crt_kps = std::min(crt_count * 1.5, crt_count / elapsed);
+                    double crt_kps =
+                        std::min(static_cast<double>(crt_count) * 1.5, static_cast<double>(crt_count) / elapsed);
                     if (crt_kps >= ret)
                         ret = crt_kps;
                     else
@@ -379,13 +625,10 @@ namespace kps {
 
             return ret;
         }
-        virtual history_array calc_kps_recent_implement(const std::unordered_set<int>& keys) override {
+        virtual history_array calc_kps_recent_implement(const std::unordered_set<int>& keys,
+                                                        time_point now) override {
             const auto& r = src->records;
             auto get_time = [&](size_t idx) { return std::get<1>(r[idx]); };
-            auto now = clock::now();
-            long long integral_second =
-                std::ceil(std::chrono::duration_cast<std::chrono::duration<double>>(now.time_since_epoch()).count());
-            now = clock::time_point(std::chrono::duration_cast<clock::duration>(std::chrono::seconds(integral_second)));
 
             if (src->records.size() && record_stamp == get_time(r.size() - 1) && cache_stamp == now &&
                 keys == cache_keys)
@@ -430,7 +673,8 @@ namespace kps {
                                 double elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(
                                                      real_time_point_left - get_time(farthest))
                                                      .count();
-                                double crt_kps = std::min(crt_count * 1.5, crt_count / elapsed);
+                                double crt_kps = std::min(static_cast<double>(crt_count) * 1.5,
+                                                          static_cast<double>(crt_count) / elapsed);
                                 if (crt_kps >= temp)
                                     temp = crt_kps;
                                 else
@@ -454,7 +698,8 @@ namespace kps {
                                     double elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(
                                                          get_time(crt) - get_time(farthest))
                                                          .count();
-                                    double crt_kps = std::min(crt_count * 1.5, crt_count / elapsed);
+                                    double crt_kps = std::min(static_cast<double>(crt_count) * 1.5,
+                                                              static_cast<double>(crt_count) / elapsed);
                                     if (crt_kps >= temp)
                                         temp = crt_kps;
                                     else
@@ -486,9 +731,80 @@ namespace kps {
     class kps_calculator : public kps_interface {
     private:
         mutable std::mutex m;
+        mutable std::uint64_t generation{1};           // 见 stamped_history::generation。
+        mutable std::unordered_set<int> stamped_keys; // 上一次计算带时间戳的最近 KPS 时的按键集合。
+
+    private:
+        /// <summary>
+        /// 一类查询的次数与总耗时。耗时包括等待锁的时间。
+        /// </summary>
+        struct query_metrics {
+            metrics::sharded_counter& count;
+            metrics::sharded_counter& nanoseconds;
+            explicit query_metrics(std::string_view labels)
+                : count(
+                      metrics::global().counter("osu_kps_calculator_queries_total", "KPS calculator queries.", labels)),
+                  nanoseconds(metrics::global().counter("osu_kps_calculator_query_seconds_total",
+                                                        "Time spent in KPS calculator queries, including lock waits.",
+                                                        labels, 1e-9)) {}
+        };
+        query_metrics now_metrics{R"(query="now")"};
+        query_metrics recent_metrics{R"(query="recent")"};
+        /// <summary>
+        /// 在作用域结束时记录一次查询。
+        /// </summary>
+        class scoped_query {
+        private:
+            const query_metrics& target;
+            clock::time_point start{clock::now()};
+
+        public:
+            explicit scoped_query(const query_metrics& target) : target(target) {}
+            scoped_query(const scoped_query&) = delete;
+            scoped_query& operator=(const scoped_query&) = delete;
+            ~scoped_query() {
+                target.count.add();
+                target.nanoseconds.add(static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count()));
+            }
+        };
 
     private:
-        std::shared_ptr<kps_implement_base> implement;
+        static constexpr size_t implement_count = 2;
+        /// <summary>
+        /// 按 kps_implement_type 索引的各计算方法。启用热备时全部存在并随按键增量维护，切换时只改变显示哪一个。
+        /// </summary>
+        std::array<std::shared_ptr<kps_implement_base>, implement_count> implements;
+        std::shared_ptr<kps_implement_base> implement; // 正在显示的计算方法。
+        bool hot_standby;
+
+        static size_t implement_index(kps_implement_type implement_type) {
+            const auto index = static_cast<size_t>(implement_type);
+            if (index >= implement_count)
+                throw std::invalid_argument("invalid type.");
+            return index;
+        }
+        std::shared_ptr<kps_implement_base> make_implement(kps_implement_type implement_type) {
+            switch (implement_type) {
+            case kps_implement_type::kps_implement_type_hard: return std::make_shared<kps_implement_hard>(this);
+            case kps_implement_type::kps_implement_type_sensitive:
+                return std::make_shared<kps_implement_sensitive>(this);
+            default: throw std::invalid_argument("invalid type.");
+            }
+        }
+        /// <summary>
+        /// 按 hot_standby 创建或销毁未显示的计算方法。保证调用该函数时已上锁。
+        /// </summary>
+        void update_standby() {
+            for (size_t i = 0; i < implement_count; i++) {
+                if (implements[i] == implement)
+                    continue;
+                if (!hot_standby)
+                    implements[i].reset();
+                else if (!implements[i])
+                    implements[i] = make_implement(static_cast<kps_implement_type>(i));
+            }
+        }
 
     public:
         auto implement_type() const {
@@ -496,28 +812,70 @@ namespace kps {
         }
 
     public:
-        kps_calculator(kps_implement_type implement_type = kps_implement_type::kps_implement_type_hard) {
+        /// <param name="hot_standby">参见 set_hot_standby。</param>
+        kps_calculator(kps_implement_type implement_type = kps_implement_type::kps_implement_type_hard,
+                       bool hot_standby = true)
+            : hot_standby(hot_standby) {
             change_implement_type(implement_type);
         }
+        /// <summary>
+        /// 切换显示的计算方法。启用热备时不需要重建，最大 KPS 变为该计算方法自己的最大 KPS；
+        /// 否则新建该计算方法，最大 KPS 保持不变。
+        /// </summary>
         void change_implement_type(kps_implement_type implement_type) {
             std::lock_guard _(m);
-            switch (implement_type) {
-            case kps_implement_type::kps_implement_type_hard: {
-                implement = std::make_shared<kps_implement_hard>(this);
-                break;
-            }
-            case kps_implement_type::kps_implement_type_sensitive: {
-                implement = std::make_shared<kps_implement_sensitive>(this);
-                break;
-            }
-            default: throw std::invalid_argument("invalid type.");
-            }
+            auto& target = implements[implement_index(implement_type)];
+            if (!target)
+                target = make_implement(implement_type);
+            if (implement)
+                implement->set_active(false);
+            implement = target;
+            implement->set_active(true);
+            update_standby();
+            generation++;
+        }
+        /// <summary>
+        /// 设置是否让未显示的计算方法也随按键增量维护。
+        /// 启用后切换计算方法不必重放按键记录，代价是每次按键都要维护所有计算方法。
+        /// </summary>
+        void set_hot_standby(bool whether) {
+            std::lock_guard _(m);
+            hot_standby = whether;
+            update_standby();
+        }
+        bool get_hot_standby() const {
+            std::lock_guard _(m);
+            return hot_standby;
         }
 
     public:
         void clear() {
             std::lock_guard _(m);
-            implement->clear();
+            std::lock_guard __(kps_interface::m); // 避免在清空各计算方法的间隙中计入按键。
+            for (const auto& each : implements)
+                if (each)
+                    each->clear();
+            generation++;
+        }
+        /// <summary>
+        /// 设置统计最大 KPS 的按键集合。最大 KPS 本身不会被清空。
+        /// </summary>
+        void set_max_kps_keys(std::span<const int> keys) {
+            std::lock_guard _(m);
+            std::lock_guard __(kps_interface::m);
+            for (const auto& each : implements)
+                if (each)
+                    each->set_max_kps_keys(keys);
+        }
+        /// <summary>
+        /// 清空所有计算方法的最大 KPS。
+        /// </summary>
+        void clear_max_kps() {
+            std::lock_guard _(m);
+            std::lock_guard __(kps_interface::m);
+            for (const auto& each : implements)
+                if (each)
+                    each->clear_max_kps();
         }
 
     public:
@@ -525,13 +883,15 @@ namespace kps {
         /// 计算当前的 KPS。其含义取决于具体实现。
         /// </summary>
         double calc_kps_now(int key) const {
+            scoped_query q(now_metrics);
             std::lock_guard _(m);
             return implement->calc_kps_now(key);
         }
         /// <summary>
         /// 计算当前的 KPS。其含义取决于具体实现。
         /// </summary>
-        double calc_kps_now(const std::vector<int>& keys) const {
+        double calc_kps_now(std::span<const int> keys) const {
+            scoped_query q(now_metrics);
             std::lock_guard _(m);
             return implement->calc_kps_now(keys);
         }
@@ -539,8 +899,26 @@ namespace kps {
         /// 计算最近的 KPS。其含义取决于具体实现。
         /// </summary>
         history_array calc_kps_recent(const std::unordered_set<int>& keys) const {
+            return calc_kps_recent_stamped(keys).values;
+        }
+        /// <summary>
+        /// 计算最近的 KPS，并给出时间戳。时间戳相同的两次结果中，只有最后一个值可能不同（只增不减）；
+        /// 同一 generation 内，时间戳较新的结果是较旧结果平移后的延续。
+        /// </summary>
+        stamped_history calc_kps_recent_stamped(const std::unordered_set<int>& keys) const {
+            scoped_query q(recent_metrics);
             std::lock_guard _(m);
-            return implement->calc_kps_recent(keys);
+            if (keys != stamped_keys) {
+                stamped_keys = keys;
+                generation++;
+            }
+            stamped_history ret;
+            const long long end = kps_implement_base::history_end(clock::now());
+            ret.values = implement->calc_kps_recent(
+                keys, clock::time_point(std::chrono::duration_cast<clock::duration>(std::chrono::seconds(end))));
+            ret.first_second = end - static_cast<long long>(history_count);
+            ret.generation = generation;
+            return ret;
         }
     };
 } // namespace kps
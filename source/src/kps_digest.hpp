@@ -0,0 +1,275 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <numbers>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+namespace kps {
+    /// <summary>
+    /// 合并式 t-digest，用于估计 KPS 的分位数。
+    /// 内存大小固定，与样本数量无关。可以随时查询，也可以合并其他 digest 或导出的质心。
+    /// 非线程安全，需由使用者加锁。
+    /// </summary>
+    class kps_digest {
+    public:
+        static constexpr double compression = 100;
+        static constexpr size_t capacity = 2 * static_cast<size_t>(compression); // 压缩后质心数量的上界。
+        static constexpr size_t buffer_capacity = 5 * static_cast<size_t>(compression);
+
+        struct centroid {
+            double mean{};
+            double weight{};
+        };
+
+    private:
+        std::array<centroid, capacity> centroids_{};
+        size_t centroid_count{};
+        std::array<centroid, buffer_capacity> buffer{};
+        size_t buffer_count{};
+        std::array<centroid, capacity + buffer_capacity> scratch{}; // 压缩时使用，避免分配内存。
+
+        double total_weight_{}; // 包括缓冲区中的样本。
+        double min_{};
+        double max_{};
+
+    private:
+        /// <summary>
+        /// 尺度函数 k1。质心在该尺度下的跨度不超过 1，使两端的质心更小、分位数更准确。
+        /// </summary>
+        static double scale(double q) {
+            return compression / (2 * std::numbers::pi) * std::asin(2 * q - 1);
+        }
+        static double scale_inverse(double k) {
+            k = std::clamp(k, -compression / 4, compression / 4);
+            return (std::sin(k * 2 * std::numbers::pi / compression) + 1) / 2;
+        }
+
+        /// <summary>
+        /// 将缓冲区并入质心。
+        /// </summary>
+        void compress() {
+            if (!buffer_count)
+                return;
+            size_t n = 0;
+            for (size_t i = 0; i < centroid_count; i++)
+                scratch[n++] = centroids_[i];
+            for (size_t i = 0; i < buffer_count; i++)
+                scratch[n++] = buffer[i];
+            buffer_count = 0;
+            std::sort(scratch.begin(), scratch.begin() + static_cast<std::ptrdiff_t>(n),
+                      [](const centroid& a, const centroid& b) { return a.mean < b.mean; });
+
+            centroid_count = 0;
+            centroid crt = scratch[0];
+            double weight_before = 0; // crt 之前的总权重。
+            double q_limit = scale_inverse(scale(0) + 1);
+            for (size_t i = 1; i < n; i++) {
+                const auto& next = scratch[i];
+                if ((weight_before + crt.weight + next.weight) / total_weight_ <= q_limit) {
+                    crt.weight += next.weight;
+                    crt.mean += (next.mean - crt.mean) * next.weight / crt.weight;
+                } else {
+                    weight_before += crt.weight;
+                    q_limit = scale_inverse(scale(weight_before / total_weight_) + 1);
+                    centroids_[centroid_count++] = crt;
+                    crt = next;
+                }
+            }
+            centroids_[centroid_count++] = crt;
+        }
+
+    public:
+        /// <summary>
+        /// 加入一个样本或一个质心。
+        /// </summary>
+        /// <param name="weight">样本的权重。导入质心时为质心的权重。</param>
+        void add(double value, double weight = 1) {
+            if (!(weight > 0) || std::isnan(value))
+                return;
+            if (buffer_count == buffer.size())
+                compress();
+            if (total_weight_ == 0) {
+                min_ = value;
+                max_ = value;
+            } else {
+                min_ = std::min(min_, value);
+                max_ = std::max(max_, value);
+            }
+            buffer[buffer_count++] = {value, weight};
+            total_weight_ += weight;
+        }
+        /// <summary>
+        /// 合并另一个 digest。other 可以是自身。
+        /// </summary>
+        void merge(const kps_digest& other) {
+            if (other.total_weight_ == 0)
+                return;
+            if (&other == this) {
+                // add 会修改正在遍历的缓冲区。
+                const kps_digest copy = other;
+                merge(copy);
+                return;
+            }
+            for (size_t i = 0; i < other.centroid_count; i++)
+                add(other.centroids_[i].mean, other.centroids_[i].weight);
+            for (size_t i = 0; i < other.buffer_count; i++)
+                add(other.buffer[i].mean, other.buffer[i].weight);
+            min_ = std::min(min_, other.min_);
+            max_ = std::max(max_, other.max_);
+        }
+        void clear() {
+            centroid_count = 0;
+            buffer_count = 0;
+            total_weight_ = 0;
+            min_ = max_ = 0;
+        }
+
+    public:
+        /// <returns>样本的总权重。</returns>
+        double count() const {
+            return total_weight_;
+        }
+        double min() const {
+            return min_;
+        }
+        double max() const {
+            return max_;
+        }
+        /// <summary>
+        /// 导出质心，按均值升序。可以逐个传给 add 以在其他地方重建或合并。
+        /// </summary>
+        std::span<const centroid> centroids() {
+            compress();
+            return std::span(centroids_).first(centroid_count);
+        }
+        /// <summary>
+        /// 估计分位数。没有样本时返回 0。
+        /// </summary>
+        /// <param name="q">[0, 1] 中的分位。</param>
+        double quantile(double q) {
+            compress();
+            if (!centroid_count)
+                return 0;
+            if (centroid_count == 1)
+                return centroids_[0].mean;
+            q = std::clamp(q, 0.0, 1.0);
+            const double index = q * total_weight_;
+
+            // 质心的样本视为以均值为中心、均匀分布于两侧。两端使用最小值和最大值插值。
+            const auto& first = centroids_[0];
+            if (index < first.weight / 2)
+                return min_ + (first.mean - min_) * index / (first.weight / 2);
+            const auto& last = centroids_[centroid_count - 1];
+            if (index > total_weight_ - last.weight / 2)
+                return last.mean + (max_ - last.mean) * (index - (total_weight_ - last.weight / 2)) / (last.weight / 2);
+
+            double center = first.weight / 2; // 当前质心中心处的累计权重。
+            for (size_t i = 0; i + 1 < centroid_count; i++) {
+                const auto& left = centroids_[i];
+                const auto& right = centroids_[i + 1];
+                double gap = (left.weight + right.weight) / 2;
+                if (index <= center + gap)
+                    return left.mean + (right.mean - left.mean) * (index - center) / gap;
+                center += gap;
+            }
+            return last.mean;
+        }
+
+    public:
+        /// <summary>
+        /// 以文本表格的形式输出样本数、常用分位数与最大值。
+        /// </summary>
+        std::wstring report() {
+            std::wstring ret = std::format(L"{:>10}{:>10}{:>10}{:>10}{:>10}{:>10}\n", L"samples", L"p50", L"p90",
+                                           L"p95", L"p99", L"max");
+            std::format_to(std::back_inserter(ret), L"{:>10.0f}{:>10.1f}{:>10.1f}{:>10.1f}{:>10.1f}{:>10.1f}\n",
+                           count(), quantile(0.5), quantile(0.9), quantile(0.95), quantile(0.99), max());
+            return ret;
+        }
+        /// <summary>
+        /// 导出为文本，用于跨会话合并。第一行为 "min,max"，之后每行为一个质心 "mean,weight"。没有样本时为空。
+        /// </summary>
+        std::string serialize() {
+            std::string ret;
+            if (total_weight_ == 0)
+                return ret;
+            std::format_to(std::back_inserter(ret), "{},{}\n", min_, max_);
+            for (const auto& c : centroids())
+                std::format_to(std::back_inserter(ret), "{},{}\n", c.mean, c.weight);
+            return ret;
+        }
+        /// <summary>
+        /// 合并 serialize 导出的文本。格式错误时不修改。
+        /// </summary>
+        /// <returns>是否成功。</returns>
+        bool merge_serialized(std::string_view text) {
+            auto parse_pair = [](std::string_view line, double& a, double& b) {
+                const size_t comma = line.find(',');
+                if (comma == std::string_view::npos)
+                    return false;
+                const char* end = line.data() + line.size();
+                const auto [p1, e1] = std::from_chars(line.data(), line.data() + comma, a);
+                const auto [p2, e2] = std::from_chars(line.data() + comma + 1, end, b);
+                return e1 == std::errc() && p1 == line.data() + comma && e2 == std::errc() && p2 == end;
+            };
+            kps_digest imported;
+            bool header = true;
+            double low{}, high{};
+            while (!text.empty()) {
+                auto line = text.substr(0, text.find('\n'));
+                text.remove_prefix(std::min(text.size(), line.size() + 1));
+                if (line.ends_with('\r'))
+                    line.remove_suffix(1);
+                if (line.empty())
+                    continue;
+                double a{}, b{};
+                if (!parse_pair(line, a, b))
+                    return false;
+                if (header) {
+                    if (!(a <= b) || !std::isfinite(a) || !std::isfinite(b))
+                        return false;
+                    low = a, high = b;
+                    header = false;
+                } else if (!(b > 0) || !std::isfinite(a) || !std::isfinite(b))
+                    return false;
+                else
+                    imported.add(a, b);
+            }
+            if (imported.total_weight_ == 0)
+                return header; // 空文本表示没有样本。
+            imported.min_ = low;
+            imported.max_ = high;
+            merge(imported);
+            return true;
+        }
+        bool write_to_file(const std::filesystem::path& path) {
+            std::ofstream ofs(path, std::ios::binary);
+            ofs << serialize();
+            return static_cast<bool>(ofs);
+        }
+        /// <summary>
+        /// 合并 write_to_file 写入的文件。
+        /// </summary>
+        bool merge_from_file(const std::filesystem::path& path) {
+            std::ifstream ifs(path, std::ios::binary);
+            if (!ifs)
+                return false;
+            std::stringstream ss;
+            ss << ifs.rdbuf();
+            return merge_serialized(ss.str());
+        }
+    };
+} // namespace kps
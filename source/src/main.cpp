@@ -1,15 +1,25 @@
 // Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
 // See the LICENSE file in the repository root for full licence text.
 
+#include <atomic>
+#include <chrono>
 #include <format>
 #include <functional>
+#include <memory>
+#include <optional>
 #include <set>
+#include <span>
+#include <utility>
+#include <vector>
 
+#include <WinSock2.h> // 须在 Windows.h 之前包含。
 #include <Windows.h>
 #undef min
 #undef max
 #include <shellapi.h>
 #pragma comment(lib, "shell32.lib")
+#include <commdlg.h>
+#pragma comment(lib, "comdlg32.lib")
 #include "resource.h"
 
 #include "utils/ConvertCode.hpp"
@@ -21,10 +31,20 @@
 #include "utils/timer_thread.hpp"
 #include "utils/window.hpp"
 
+#include "broadcast/shared_state_mapping.hpp"
+#include "broadcast/state_broadcaster.hpp"
+#include "broadcast/state_frame.hpp"
+#include "broadcast/web_server.hpp"
 #include "config.hpp"
 #include "integrated_kps.hpp"
 #include "keys_manager.hpp"
+#include "metrics/registry.hpp"
+#include "monitor_comparison.hpp"
 #include "my_multi_language.hpp"
+#include "overlay/d2d_backend.hpp"
+#include "overlay/frame_builder.hpp"
+#include "overlay/frame_scheduler.hpp"
+#include "overlay/frame_timing.hpp"
 
 #include "key_window.h"
 
@@ -67,6 +87,12 @@ class main_window : public window {
 
             HANDLE_MSG(hwnd, WM_PAINT, OnPaint);
 
+        case wm_frame_tick: {
+            frame_tick_pending.store(false, std::memory_order_relaxed);
+            OnFrameTick();
+            break;
+        }
+
         case WM_DPICHANGED: {
             RECT* const prcNewWindow = (RECT*)lParam;
             SetWindowPos(hwnd, NULL, prcNewWindow->left, prcNewWindow->top, prcNewWindow->right - prcNewWindow->left,
@@ -100,6 +126,7 @@ class main_window : public window {
         cfg.regulate();
 
         // 应用配置。
+        init_pipeline();
         init_options();
 
         // 窗口信息相关。
@@ -141,7 +168,7 @@ class main_window : public window {
     void OnLButtonDown(HWND, BOOL fDoubleClick, int x, int y, UINT keyFlags) {
         UNREFERENCED_PARAMETER(keyFlags);
         if (fDoubleClick) {
-            if (cfg.show_buttons() && y <= cy_button * dpi() * cfg.scale())
+            if (cfg.show_buttons() && y <= layout::cy_button * dpi() * cfg.scale())
                 modify_keys();
         } else {
             PostMessageW(hwnd, WM_NCLBUTTONDOWN, HTCAPTION, MAKELPARAM(x, y));
@@ -217,6 +244,19 @@ class main_window : public window {
         id_monitor_method_dinput,
         id_monitor_method_memory,
         id_monitor_fence,
+        id_dump_metrics,
+        id_monitor_latency_show,
+        id_monitor_latency_export,
+        id_monitor_latency_clear,
+        id_monitor_comparison,
+        id_frame_timing_panel,
+        id_frame_timing_dump,
+        id_frame_timing_clear,
+        id_kps_distribution_show,
+        id_kps_distribution_export,
+        id_kps_distribution_import,
+        id_key_timing_show,
+        id_key_timing_export,
     };
     /// <summary>
     /// 创建或重建菜单。
@@ -263,6 +303,23 @@ class main_window : public window {
             AppendMenuW(hMenuPopup, MF_POPUP, reinterpret_cast<UINT_PTR>(menus_auto_reset),
                         lang["menu.auto_reset"].c_str());
         }
+        // menus_session_statistics
+        {
+            HMENU menus_session_statistics = CreateMenu();
+            AppendMenuW(menus_session_statistics, MF_STRING, id_kps_distribution_show,
+                        lang["menu.kps_distribution.show"].c_str());
+            AppendMenuW(menus_session_statistics, MF_STRING, id_kps_distribution_export,
+                        lang["menu.kps_distribution.export"].c_str());
+            AppendMenuW(menus_session_statistics, MF_STRING, id_kps_distribution_import,
+                        lang["menu.kps_distribution.import"].c_str());
+            AppendMenuW(menus_session_statistics, MF_SEPARATOR, NULL, nullptr);
+            AppendMenuW(menus_session_statistics, MF_STRING, id_key_timing_show, lang["menu.key_timing.show"].c_str());
+            AppendMenuW(menus_session_statistics, MF_STRING, id_key_timing_export,
+                        lang["menu.key_timing.export"].c_str());
+
+            AppendMenuW(hMenuPopup, MF_POPUP, reinterpret_cast<UINT_PTR>(menus_session_statistics),
+                        lang["menu.session_statistics"].c_str());
+        }
         AppendMenuW(hMenuPopup, MF_SEPARATOR, NULL, nullptr);
         // menus_monitor_method
         {
@@ -271,6 +328,15 @@ class main_window : public window {
             AppendMenuW(menus_monitor_method, MF_STRING, id_monitor_method_hook, lang["menu.hook"].c_str());
             AppendMenuW(menus_monitor_method, MF_STRING, id_monitor_method_dinput, lang["menu.dinput"].c_str());
             AppendMenuW(menus_monitor_method, MF_STRING, id_monitor_method_memory, lang["menu.memory"].c_str());
+            AppendMenuW(menus_monitor_method, MF_SEPARATOR, NULL, nullptr);
+            AppendMenuW(menus_monitor_method, MF_STRING, id_monitor_latency_show,
+                        lang["menu.monitor_latency.show"].c_str());
+            AppendMenuW(menus_monitor_method, MF_STRING, id_monitor_latency_export,
+                        lang["menu.monitor_latency.export"].c_str());
+            AppendMenuW(menus_monitor_method, MF_STRING, id_monitor_latency_clear,
+                        lang["menu.monitor_latency.clear"].c_str());
+            AppendMenuW(menus_monitor_method, MF_STRING, id_monitor_comparison,
+                        lang["menu.monitor_comparison"].c_str());
 
             AppendMenuW(hMenuPopup, MF_POPUP, reinterpret_cast<UINT_PTR>(menus_monitor_method),
                         lang["menu.monitor_method"].c_str());
@@ -321,6 +387,17 @@ class main_window : public window {
                         lang["menu.language"].c_str());
         }
         AppendMenuW(hMenuPopup, MF_STRING, id_monitor_fence, lang["menu.monitor_fence"].c_str());
+        AppendMenuW(hMenuPopup, MF_STRING, id_dump_metrics, lang["menu.dump_metrics"].c_str());
+#if OSU_KPS_FRAME_TIMING
+        {
+            HMENU menus_frame_timing = CreateMenu();
+            AppendMenuW(menus_frame_timing, MF_STRING, id_frame_timing_panel, lang["menu.frame_timing.panel"].c_str());
+            AppendMenuW(menus_frame_timing, MF_STRING, id_frame_timing_dump, lang["menu.frame_timing.dump"].c_str());
+            AppendMenuW(menus_frame_timing, MF_STRING, id_frame_timing_clear, lang["menu.frame_timing.clear"].c_str());
+            AppendMenuW(hMenuPopup, MF_POPUP, reinterpret_cast<UINT_PTR>(menus_frame_timing),
+                        lang["menu.frame_timing"].c_str());
+        }
+#endif
         AppendMenuW(hMenuPopup, MF_SEPARATOR, NULL, nullptr);
         AppendMenuW(
             hMenuPopup, MF_STRING | MF_DISABLED, NULL,
@@ -360,6 +437,8 @@ class main_window : public window {
             break;
         }
         }
+        if (monitor_comparison)
+            CheckMenuItem(hMenu, id_monitor_comparison, MF_CHECKED);
         // 勾选当前显示内容。
         if (cfg.show_buttons())
             CheckMenuItem(hMenu, id_show_buttons, MF_CHECKED);
@@ -386,6 +465,10 @@ class main_window : public window {
         // 勾选禁止移出屏幕。
         if (cfg.monitor_fence())
             CheckMenuItem(hMenu, id_monitor_fence, MF_CHECKED);
+#if OSU_KPS_FRAME_TIMING
+        if (show_frame_timing)
+            CheckMenuItem(hMenu, id_frame_timing_panel, MF_CHECKED);
+#endif
         // 勾选当前自动重置。
         if (cfg.auto_reset_total_hits())
             CheckMenuItem(hMenu, id_auto_reset_total_hits, MF_CHECKED);
@@ -431,6 +514,8 @@ class main_window : public window {
                 case id_reset_all: {
                     k_manager.clear_total_count();
                     k_manager.clear_max_kps();
+                    k_manager.clear_timing_statistics();
+                    k_manager.clear_kps_distribution();
                     kps.clear();
                     break;
                 }
@@ -475,6 +560,81 @@ class main_window : public window {
                     change_monitor_fence(!cfg.monitor_fence());
                     break;
                 }
+                case id_monitor_latency_show: {
+                    MessageBoxW(hwnd, kps.get_monitor_latency().report().c_str(),
+                                lang["messagebox.monitor_latency.caption"].c_str(), MB_ICONINFORMATION);
+                    break;
+                }
+                case id_monitor_latency_export: {
+                    kps.get_monitor_latency().write_to_file("osu-kps-monitor-latency.txt");
+                    break;
+                }
+                case id_monitor_latency_clear: {
+                    kps.clear_monitor_latency();
+                    break;
+                }
+                case id_monitor_comparison: {
+                    toggle_monitor_comparison();
+                    break;
+                }
+                case id_dump_metrics: {
+                    metrics::global().write_to_file("osu-kps-metrics.txt");
+                    break;
+                }
+#if OSU_KPS_FRAME_TIMING
+                case id_frame_timing_panel: {
+                    show_frame_timing = !show_frame_timing;
+                    break;
+                }
+                case id_frame_timing_dump: {
+                    frame_timing.write_to_file("osu-kps-frame-timing.txt");
+                    break;
+                }
+                case id_frame_timing_clear: {
+                    frame_timing.clear();
+                    break;
+                }
+#endif
+                case id_kps_distribution_show: {
+                    MessageBoxW(hwnd, k_manager.get_kps_distribution().report().c_str(),
+                                lang["messagebox.kps_distribution.caption"].c_str(), MB_ICONINFORMATION);
+                    break;
+                }
+                case id_kps_distribution_export: {
+                    if (!k_manager.get_kps_distribution().write_to_file("osu-kps-kps-distribution.txt"))
+                        MessageBoxW(hwnd, lang["messagebox.kps_distribution.export_failed"].c_str(),
+                                    lang["messagebox.kps_distribution.caption"].c_str(), MB_ICONERROR);
+                    break;
+                }
+                case id_kps_distribution_import: {
+                    // 由用户选择文件，而不是读取导出的文件，否则会把本次统计再计入一次。
+                    std::wstring filter = lang["dialog.kps_distribution.filter"] + L'\0' + L"*.txt" + L'\0';
+                    wchar_t path[MAX_PATH]{};
+                    OPENFILENAMEW ofn{sizeof(ofn)};
+                    ofn.hwndOwner = hwnd;
+                    ofn.lpstrFilter = filter.c_str();
+                    ofn.lpstrFile = path;
+                    ofn.nMaxFile = MAX_PATH;
+                    ofn.Flags = OFN_FILEMUSTEXIST | OFN_PATHMUSTEXIST | OFN_NOCHANGEDIR; // 配置文件在当前目录。
+                    if (!GetOpenFileNameW(&ofn))
+                        break;
+                    kps::kps_digest other;
+                    if (other.merge_from_file(path))
+                        k_manager.merge_kps_distribution(other);
+                    else
+                        MessageBoxW(hwnd, lang["messagebox.kps_distribution.import_failed"].c_str(),
+                                    lang["messagebox.kps_distribution.caption"].c_str(), MB_ICONERROR);
+                    break;
+                }
+                case id_key_timing_show: {
+                    MessageBoxW(hwnd, k_manager.timing_statistics_report().c_str(),
+                                lang["messagebox.key_timing.caption"].c_str(), MB_ICONINFORMATION);
+                    break;
+                }
+                case id_key_timing_export: {
+                    k_manager.write_timing_statistics("osu-kps-key-timing.txt");
+                    break;
+                }
                 default: // 语言。
                 {
                     change_language(id);
@@ -495,16 +655,8 @@ class main_window : public window {
     SharedComPtr<ID2D1HwndRenderTarget> pRenderTarget{};
     struct cache_t {
         // indep
-        static constexpr auto theme_color = color(203u, 237u, 238u);
-        static constexpr auto theme_color_half_trans = color(203u, 237u, 238u, 191u);
-        static constexpr auto theme_color_full_trans = color(203u, 237u, 238u, 0u);
-        static constexpr auto light_active_color = color(227u, 172u, 181u);
-        static constexpr auto active_color = color(255u, 104u, 143u);
-
         keyboard_char kc;
 
-        SharedComPtr<ID2D1SolidColorBrush> theme_brush;
-        SharedComPtr<ID2D1SolidColorBrush> theme_half_trans_brush;
         SharedComPtr<ID2D1StrokeStyle> dash_stroke;
         private_font_collection theme_font_collection;
 
@@ -518,7 +670,7 @@ class main_window : public window {
         SharedComPtr<IDWriteTextFormat> text_format_statistics_MDL2;
         SharedComPtr<IDWriteTextFormat> text_format_graph;
 
-        SharedComPtr<ID2D1LinearGradientBrush> graph_brush;
+        overlay::d2d_backend backend;
 
         void reset() {
             this->~cache_t();
@@ -540,10 +692,6 @@ class main_window : public window {
         d2d_inited = true;
     }
     void build_indep_resource() {
-        pRenderTarget->CreateSolidColorBrush(cache.theme_color, cache.theme_brush.reset_and_get_address());
-        pRenderTarget->CreateSolidColorBrush(cache.theme_color_half_trans,
-                                             cache.theme_half_trans_brush.reset_and_get_address());
-
         factory::d2d1()->CreateStrokeStyle(D2D1::StrokeStyleProperties(D2D1_CAP_STYLE_FLAT, D2D1_CAP_STYLE_FLAT,
                                                                        D2D1_CAP_STYLE_FLAT, D2D1_LINE_JOIN_MITER, 10.0F,
                                                                        D2D1_DASH_STYLE_DASH, 0.0f),
@@ -606,70 +754,45 @@ class main_window : public window {
                                cache.text_format_graph.reset_and_get_address());
             cache.text_format_graph->SetParagraphAlignment(DWRITE_PARAGRAPH_ALIGNMENT_FAR);
         }
-
-        // graph_brush
-        {
-            SharedComPtr<ID2D1GradientStopCollection> gradient_stops;
-            D2D1_GRADIENT_STOP stops[] = {
-                {0.f, cache.theme_color},
-                {0.3f, cache.light_active_color},
-                {1.f, cache.active_color},
-            };
-            pRenderTarget->CreateGradientStopCollection(stops, std::size(stops),
-                                                        gradient_stops.reset_and_get_address());
-            pRenderTarget->CreateLinearGradientBrush(
-                D2D1::LinearGradientBrushProperties(D2D1::Point2F(0, cy_graph * x), D2D1::Point2F(0, 0)),
-                D2D1::BrushProperties(), gradient_stops, cache.graph_brush.reset_and_get_address());
-        }
+        cache.backend.reset_text_layouts(); // 排版引用了旧的文字格式。
     }
+    /// <summary>
+    /// 通知主线程检查是否需要重绘的消息。
+    /// </summary>
+    static constexpr UINT wm_frame_tick = WM_APP + 1;
+    std::atomic<bool> frame_tick_pending{}; // 是否已有未处理的 wm_frame_tick，用于合并消息。
     timer_thread _tt{[this] {
-                         if (hwnd) {
-                             InvalidateRect(hwnd, nullptr, FALSE);
-                             UpdateWindow(hwnd);
-                         }
+                         if (hwnd && !frame_tick_pending.exchange(true, std::memory_order_relaxed))
+                             PostMessageW(hwnd, wm_frame_tick, 0, 0);
                      },
                      1000 / 144};
-    /// <summary>
-    /// 将颜色根据参数进行插值。
-    /// crt 从 0 到 threshold 1 之间，总是 from。
-    /// crt 接近 threshold2 时，接近 to（0.9）。
-    /// crt 趋于正无穷时，为 to。当 crt 为负数时，行为未定义。
-    /// </summary>
-    /// <typeparam name="param_t"></typeparam>
-    /// <param name="from"></param>
-    /// <param name="to"></param>
-    /// <param name="crt">当前参数。</param>
-    /// <param name="threshold1">阈值 1。</param>
-    /// <returns></returns>
-    template <typename param_t>
-    static color _interpolate(color from, color to, param_t crt, param_t threshold1, param_t threshold2) {
-        if (crt < 0 || threshold1 < 0 || threshold2 < threshold1)
-            throw std::invalid_argument("invalid argument.");
-
-        double ratio{};
-        if (crt >= threshold1) {
-            crt -= threshold1;
-            auto sigmoid = [](double x) { return 1 / (1 + std::exp(-x)); };
-            constexpr double ratio_t2 = 0.9;
-            double a = -std::log(1 / ratio_t2 - 1) / std::log(std::exp(1)) / (threshold2 - threshold1);
-            ratio = (sigmoid(a * crt) - 0.5) * 2;
-        }
-        return color::linear_interpolation(from, to, ratio);
+    overlay::frame_builder frame_builder;
+    struct key_label {
+        int code{-1}; // text 对应的键码。
+        std::wstring text;
+        overlay::label_style style{};
+    };
+    std::array<key_label, keys_manager::max_key_count> key_labels; // 各列的键名。只在键码改变时重新转换。
+    overlay::frame_timing frame_timing; // 各阶段的耗时。只在打开 OSU_KPS_FRAME_TIMING 时记录。
+    bool show_frame_timing{};           // 是否在画面上显示各阶段的耗时。
+    overlay::frame_scheduler frame_scheduler;
+    overlay::display_list next_frame;     // 新生成的一帧。呈现后与上一次呈现的一帧交换。
+    overlay::frame_strings frame_strings; // 与语言相关的文字，切换语言时更新。
+    void update_frame_strings() {
+        frame_strings.max_caption = lang["draw.statistics.max"];
+        frame_strings.recent_format = lang["draw.graph.recent"];
+        frame_strings.keys_format = lang["draw.graph.keys"];
     }
+    broadcast::state_encoder state_encoder;         // 所有订阅者共享同一次编码的结果。
+    broadcast::state_broadcaster state_broadcaster; // 只在配置了 broadcast.port 时监听。
+    std::optional<broadcast::shared_state_host> shared_state; // 只在配置了 broadcast.shared_memory 时创建。
+    void build_frame(overlay::display_list& out, bool publish = false); // publish 为真时将本帧的状态广播给订阅者。
+    void render_frame(const overlay::display_list& frame);
+    void OnFrameTick();
     void OnPaint(HWND);
 
     // 绘图位置参数。
-    inline static double cx_button = 52.0;
-    inline static double cy_button = 72.0;
-    inline static double cx_gap = 8.0;
-    inline static double cy_separator = 8.0;
-    inline static double cx_statistics = 232.0;
-    inline static double cx_kps_number = 33.0;
-    inline static double cx_kps_text = 33.0;
-    inline static double cx_total_number = 40.0;
-    inline static double cy_statistics = 20.0;
-    inline static double cy_statistics_small = 15.0;
-    inline static double cy_graph = 80.0;
+    using layout = overlay::layout;
     /// <summary>
     /// 计算窗口应有的大小。<remarks>计算时不考虑缩放，最后再乘以缩放。</remarks>
     /// </summary>
@@ -677,16 +800,17 @@ class main_window : public window {
     std::tuple<double, double> calc_size() const {
         double cx = 0;
         if (cfg.show_buttons())
-            cx = std::max(cx, cx_button * k_manager.get_button_count() + cx_gap * (k_manager.get_button_count() - 1));
-        cx = std::max(cx, cx_statistics);
+            cx = std::max(cx, layout::cx_button * k_manager.get_button_count() +
+                                  layout::cx_gap * (k_manager.get_button_count() - 1));
+        cx = std::max(cx, layout::cx_statistics);
         double cy = 0;
         if (cfg.show_buttons())
-            cy += cy_button + cy_separator;
+            cy += layout::cy_button + layout::cy_separator;
         if (cfg.show_statistics())
-            cy += cy_statistics + 0.5 * cy_separator + cy_separator;
+            cy += layout::cy_statistics + 0.5 * layout::cy_separator + layout::cy_separator;
         if (cfg.show_graph())
-            cy += cy_graph + cy_separator;
-        cy -= cy_separator;
+            cy += layout::cy_graph + layout::cy_separator;
+        cy -= layout::cy_separator;
 
         double scale = cfg.scale();
         return {cx * dpi() * scale, cy * dpi() * scale};
@@ -763,8 +887,35 @@ private:
     // KPS。
 public:
     keys_manager k_manager{&kps};
-    kps::kps kps{std::bind(&keys_manager::update_on_key_down, &k_manager, std::placeholders::_1, std::placeholders::_2,
-                           std::placeholders::_3)};
+    broadcast::key_edge_queue key_edges; // 只在有 WebSocket 客户端请求时记录。
+    kps::kps kps;
+    /// <summary>
+    /// 在 KPS 计算之后添加按键统计与 WebSocket 的按键边沿。
+    /// </summary>
+    void init_pipeline() {
+        auto& pipe = kps.get_pipeline();
+        pipe.add_sink("statistics", [this](std::span<const kps::key_event> events) {
+            for (const auto& e : events)
+                k_manager.update_on_key_down(e.key, e.time, e.down);
+        });
+        // 只转发当前键位中的按键，以免把输入的文字发给网页。
+        pipe.add_sink("key_edges", [this](std::span<const kps::key_event> events) {
+            if (!key_edges.is_enabled())
+                return;
+            const auto snapshot = k_manager.snapshot();
+            for (const auto& e : events) {
+                if (!snapshot.in_layout(e.key))
+                    continue;
+                const auto us = std::chrono::duration_cast<std::chrono::microseconds>(e.time.time_since_epoch());
+                key_edges.push({e.key, e.down, us.count()});
+            }
+        });
+    }
+    timer_thread tt_sample_kps{[this] { k_manager.sample_kps(); }, 100}; // 以固定频率采样 KPS，用于统计分位数。
+    kps::stamped_history web_history; // 只由 web_server 的线程访问。
+    // 只在配置了 broadcast.websocket_port 时创建。声明在 kps 之后，从而先于 kps 析构。
+    std::optional<broadcast::web_server> web_server;
+    void collect_live_state(broadcast::live_state& state); // 在 web_server 的线程中调用。
     // 选项。
 public:
     config cfg;
@@ -774,12 +925,35 @@ public:
             cfg.language(lang.query_current_language_id());
         } else
             lang.set_current_language(cfg.language());
+        update_frame_strings();
         k_manager.set_button_count(cfg.button_count());
+        kps.set_hot_standby(cfg.kps_hot_standby());
         kps.change_implement_type(cfg.kps_method());
         for (int i = 1; i <= keys_manager::max_key_count; i++)
             for (int j = 0; j < i; j++)
                 k_manager.modify_key(i, j, cfg.key_map(i, j));
         kps.change_monitor_implement_type(static_cast<kps::key_monitor_implement_type>(cfg.key_monitor_implement()));
+        kps.set_debounce(cfg.debounce_mode(), std::chrono::milliseconds(cfg.debounce_interval_ms()),
+                         cfg.debounce_key_intervals());
+        if (cfg.broadcast_port())
+            state_broadcaster.start(static_cast<std::uint16_t>(cfg.broadcast_port())); // 端口被占用时不广播。
+        if (cfg.broadcast_shared_memory()) {
+            try {
+                shared_state.emplace();
+            } catch (const std::runtime_error&) {
+                // 创建共享内存失败时不发布。
+            }
+        }
+        if (cfg.broadcast_websocket_port()) {
+            try {
+                web_server.emplace(static_cast<std::uint16_t>(cfg.broadcast_websocket_port()),
+                                   static_cast<unsigned>(cfg.broadcast_websocket_rate()),
+                                   [this](broadcast::live_state& state) { collect_live_state(state); }, &key_edges,
+                                   cfg.broadcast_websocket_origins());
+            } catch (const std::runtime_error&) {
+                // 端口被占用时不提供。
+            }
+        }
     }
     /// <summary>
     /// 改变当前按键个数。
@@ -836,6 +1010,7 @@ public:
     void change_language(int id) {
         lang.set_current_language(id);
         cfg.language(lang.query_current_language_id());
+        update_frame_strings();
     }
     void change_monitor_fence(bool set) {
         cfg.monitor_fence(set);
@@ -854,296 +1029,214 @@ public:
 
         kps.change_monitor_implement_type(new_type);
     }
+    std::optional<kps::monitor_comparison> monitor_comparison; // 只在比较模式下存在。
+    /// <summary>
+    /// 开始或结束比较模式。结束时导出并显示报告。
+    /// </summary>
+    void toggle_monitor_comparison() {
+        if (monitor_comparison) {
+            const auto report = monitor_comparison->report();
+            monitor_comparison->write_to_file("osu-kps-monitor-comparison.txt");
+            monitor_comparison.reset();
+            MessageBoxW(hwnd, report.text().c_str(), lang["messagebox.monitor_comparison.caption"].c_str(),
+                        MB_ICONINFORMATION);
+            return;
+        }
+        // 钩子最先得知按键，作为参照。
+        std::vector<std::pair<std::wstring, std::shared_ptr<kps::key_monitor_base>>> sources;
+        for (auto type : {kps::monitor_implement_type_hook, kps::monitor_implement_type_dinput,
+                          kps::monitor_implement_type_async, kps::monitor_implement_type_memory}) {
+            try {
+                sources.emplace_back(kps::monitor_latency::source_names[type], kps::kps::make_monitor(type));
+            } catch (const std::runtime_error&) {
+                // 无法创建的方式不参与比较。
+            }
+        }
+        monitor_comparison.emplace(std::move(sources));
+    }
 
     // 选项窗口
 public:
     key_window key_wnd{&cfg, &k_manager};
 };
 
-void main_window::OnPaint(HWND) {
-    if (!d2d_inited)
-        init_d2d();
-
-    pRenderTarget->BeginDraw();
-    pRenderTarget->SetTransform(D2D1::IdentityMatrix());
-    pRenderTarget->Clear(D2D1::ColorF(D2D1::ColorF::Black));
-    double x = dpi() * cfg.scale(); // 总比例因子。
+void main_window::collect_live_state(broadcast::live_state& state) {
+    const auto snapshot = k_manager.snapshot();
+    const auto keys = snapshot.layout_keys(); // get_keys 只能在主线程调用。
+    const size_t count = keys.size();
+    state.button_count = count;
+    for (size_t i = 0; i < count; i++)
+        state.columns[i] = {kps.calc_kps_now(keys[i]), snapshot.columns[i].times, snapshot.columns[i].down};
+    state.is_autoplay = snapshot.is_autoplay;
+    state.total_count = snapshot.total_count;
+    state.max_kps = snapshot.max_kps;
+    state.kps_now = kps.calc_kps_now(keys);
+    web_history = kps.calc_kps_recent_stamped({keys.begin(), keys.end()});
+    state.history = web_history.values;
+    state.history_first_second = web_history.first_second;
+    state.history_generation = web_history.generation;
+}
+void main_window::build_frame(overlay::display_list& out, bool publish) {
+    // 收集本帧的输入。
+    keys_manager::snapshot_t snapshot; // 本帧使用的一致的按键状态。
+    std::span<const int> keys;
     {
-        // 画按键框。
-        if (cfg.show_buttons()) {
-            for (int i = 0; i < k_manager.get_button_count(); i++) {
-                auto original_rect =
-                    D2D1::RectF(i * (cx_button + cx_gap) * x, 0.0F, (i * (cx_button + cx_gap) + cx_button) * x,
-                                cy_button * x); // 框对应矩形。
-                double stroke_width = 2 * x;
-                auto draw_rect = original_rect; // 使用 DrawRectangle 时对应的矩形。
-                draw_rect.left += stroke_width / 2;
-                draw_rect.right -= stroke_width / 2;
-                draw_rect.top += stroke_width / 2;
-                draw_rect.bottom -= stroke_width / 2;
-                auto draw_rounded_rect = D2D1::RoundedRect(draw_rect, 4.0 * x, 4.0 * x);
-
-                auto key_name_rect = original_rect; // 每个框的键名对应的矩形。
-                key_name_rect.bottom -= (key_name_rect.bottom - key_name_rect.top) * 2 / 5;
-                auto number_rect = original_rect; // 每个框的数字对应的矩形。
-                number_rect.top += (number_rect.bottom - number_rect.top) * 2 / 5;
-
-                // 按键的发光效果。
-                {
-                    color brush_color = _interpolate(cache.theme_color, cache.light_active_color,
-                                                     kps.calc_kps_now(k_manager.get_keys()[i]), 2.0, 4.0);
-                    color brush_color_transparent = brush_color;
-                    auto now = kps::clock::now();
-                    auto down_alpha_param =
-                        std::chrono::duration_cast<decltype(0.0s)>(now - k_manager.previous_down_by_index(i));
-                    auto up_alpha_param =
-                        std::chrono::duration_cast<decltype(0.0s)>(now - k_manager.previous_up_by_index(i));
-                    color down_color;
-                    {
-                        brush_color.a = 0;
-                        brush_color_transparent.a = 0.675;
-                        down_color = _interpolate(brush_color, brush_color_transparent, down_alpha_param.count(),
-                                                  (0.01s).count(), (0.03s).count());
-                    }
-                    if (k_manager.down_by_index(i)) {
-                        brush_color = down_color;
-                    } else {
-                        color up_color;
-                        {
-                            brush_color.a = brush_color_transparent.a;
-                            brush_color_transparent.a = 0;
-                            up_color = _interpolate(brush_color, brush_color_transparent, up_alpha_param.count(),
-                                                    (0.05s).count(), (0.25s).count());
-                        }
-
-                        brush_color = up_color;
-                    }
-
-                    if (brush_color.a > 1e-6) {
-                        SharedComPtr<ID2D1SolidColorBrush> brush;
-                        pRenderTarget->CreateSolidColorBrush(brush_color, brush.reset_and_get_address());
-                        pRenderTarget->FillRoundedRectangle(draw_rounded_rect, brush);
-                    }
-                }
-
-                // 写字。
-                {
-                    auto s = cache.kc.to_short(k_manager.get_keys()[i]);
-                    auto str = ConvertCode::to_wstring(s.key);
-                    pRenderTarget->DrawTextW(
-                        str.c_str(), str.length(),
-                        s.need_MDL2 ? cache.text_format_key_name_MDL2
-                                    : (s.is_single ? cache.text_format_key_name : cache.text_format_key_name_small),
-                        key_name_rect, cache.theme_brush);
-                }
-                {
-                    double k_now = kps.calc_kps_now(k_manager.get_keys()[i]); // 当前框对应 kps。
-                    auto str = std::to_wstring(static_cast<int>(k_now));
-
-                    pRenderTarget->DrawTextW(str.c_str(), str.length(), cache.text_format_number, number_rect,
-                                             cache.theme_brush);
-                }
-
-                // 最外层的框。
-                {
-                    color text_color = _interpolate(cache.theme_color, cache.light_active_color,
-                                                    kps.calc_kps_now(k_manager.get_keys()[i]), 2.0, 4.0);
-                    SharedComPtr<ID2D1SolidColorBrush> brush;
-                    pRenderTarget->CreateSolidColorBrush(text_color, brush.reset_and_get_address());
-                    pRenderTarget->DrawRoundedRectangle(draw_rounded_rect, brush, stroke_width);
-                }
-            }
-            // 平移绘制区域，使得逻辑坐标从 (0, 0) 开始。
-            {
-                D2D1_MATRIX_3X2_F transform;
-                pRenderTarget->GetTransform(&transform);
-                auto move = D2D1::Matrix3x2F::Translation(0, (cy_button + cy_separator) * x);
-                pRenderTarget->SetTransform(transform * move);
-            }
+        OVERLAY_TIME_STAGE(frame_timing, overlay::frame_stage::snapshot);
+        snapshot = k_manager.snapshot();
+        keys = k_manager.get_keys();
+    }
+    overlay::frame_input input;
+    input.scale = dpi() * cfg.scale();
+    input.width = width();
+    input.show_buttons = cfg.show_buttons();
+    input.show_statistics = cfg.show_statistics();
+    input.show_graph = cfg.show_graph();
+    input.button_count = snapshot.button_count;
+    input.max_kps = snapshot.max_kps;
+    input.is_autoplay = snapshot.is_autoplay;
+    input.total_count = snapshot.total_count;
+    input.strings = &frame_strings;
+
+    // 需要发布时，即使不显示也要计算所有的值。
+    publish = publish && (state_broadcaster.subscriber_count() || shared_state);
+    const size_t count =
+        input.show_buttons || publish ? std::min(keys.size(), static_cast<size_t>(snapshot.button_count)) : 0;
+    std::array<double, keys_manager::max_key_count> column_kps{};
+    kps::stamped_history history;
+    {
+        OVERLAY_TIME_STAGE(frame_timing, overlay::frame_stage::calculator);
+        for (size_t i = 0; i < count; i++)
+            column_kps[i] = kps.calc_kps_now(keys[i]);
+        if (input.show_statistics || publish)
+            input.kps_now = kps.calc_kps_now(keys);
+        if (input.show_graph || publish) {
+            history = kps.calc_kps_recent_stamped({keys.begin(), keys.end()});
+            input.history = history.values;
+            input.history_first_second = history.first_second;
+            input.history_generation = history.generation;
         }
+    }
+    if (publish && state_broadcaster.subscriber_count()) {
+        broadcast::live_state state;
+        state.button_count = count;
+        for (size_t i = 0; i < count; i++)
+            state.columns[i] = {column_kps[i], snapshot.columns[i].times, snapshot.columns[i].down};
+        state.is_autoplay = snapshot.is_autoplay;
+        state.total_count = snapshot.total_count;
+        state.max_kps = snapshot.max_kps;
+        state.kps_now = input.kps_now;
+        state.history = history.values;
+        state.history_first_second = history.first_second;
+        state.history_generation = history.generation;
+        state_broadcaster.publish(state_encoder.encode(state));
+    }
+    if (publish && shared_state) {
+        auto& writer = shared_state->writer();
+        auto& state = writer.state();
+        auto to_us = [](kps::time_point t) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(t.time_since_epoch()).count();
+        };
+        state.button_count = static_cast<std::int32_t>(count);
+        for (size_t i = 0; i < count; i++) {
+            const auto& info = snapshot.columns[i];
+            auto& col = state.columns[i];
+            col.kps = column_kps[i];
+            col.previous_down_us = to_us(info.previous_down);
+            col.previous_up_us = to_us(info.previous_up);
+            col.times = info.times;
+            col.down = info.down;
+        }
+        state.total_count = snapshot.total_count;
+        state.is_autoplay = snapshot.is_autoplay;
+        state.max_kps = snapshot.max_kps;
+        state.kps_now = input.kps_now;
+        writer.set_history(history.values, history.first_second, history.generation);
+        writer.publish(to_us(kps::clock::now()));
+    }
 
-        // 画统计信息。
-        if (cfg.show_statistics()) {
-            auto kps_number_rect = D2D1::RectF(cx_gap * x, 0, (cx_gap + cx_kps_number) * x,
-                                               cy_statistics * x); // kps 数值矩形。
-            auto kps_text_rect =
-                D2D1::RectF(kps_number_rect.right + cx_gap * x, (cy_statistics - cy_statistics_small) * x,
-                            kps_number_rect.right + (cx_gap + cx_kps_text) * x,
-                            cy_statistics * x); // kps 文字矩形。
-            auto max_number_rect =
-                D2D1::RectF(kps_text_rect.right + cx_gap * x, 0, kps_text_rect.right + (cx_gap + cx_kps_number) * x,
-                            cy_statistics * x); // 最大 kps 数值矩形。
-            auto max_text_rect =
-                D2D1::RectF(max_number_rect.right + cx_gap * x, (cy_statistics - cy_statistics_small) * x,
-                            max_number_rect.right + (cx_gap + cx_kps_text) * x,
-                            cy_statistics * x); // 最大 kps 文字矩形。
-            auto icon_rect = D2D1::RectF(max_text_rect.right, (cy_statistics - cy_statistics_small) * x,
-                                         (cx_statistics - cx_gap) * x,
-                                         cy_statistics * x); // 图标矩形。
-            auto total_number_rect =
-                D2D1::RectF(max_text_rect.right + cx_gap * x, (cy_statistics - cy_statistics_small) * x,
-                            (cx_statistics - cx_gap) * x,
-                            cy_statistics * x); // 总按键数值矩形。
-
-            wchar_t buffer[256];
-            {
-                double kps_now = kps.calc_kps_now(k_manager.get_keys());
-                std::wstring str;
-                if (kps_now < 200)
-                    str = std::format(L"{0}", static_cast<int>(kps_now));
-                else
-                    str = L"\x221E";
-
-                color text_color = _interpolate(cache.theme_color, cache.active_color, kps_now, 6.0, 13.0);
-                SharedComPtr<ID2D1SolidColorBrush> brush;
-                pRenderTarget->CreateSolidColorBrush(text_color, brush.reset_and_get_address());
-                cache.text_format_statistics->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_TRAILING);
-                pRenderTarget->DrawTextW(str.c_str(), str.length(), cache.text_format_statistics, kps_number_rect,
-                                         brush);
-            }
-            {
-                std::swprintf(buffer, std::size(buffer), L"KPS");
-                auto str = std::wstring(buffer);
-
-                cache.text_format_statistics_small->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_LEADING);
-                pRenderTarget->DrawTextW(str.c_str(), str.length(), cache.text_format_statistics_small, kps_text_rect,
-                                         cache.theme_brush);
-            }
-            {
-                std::wstring str;
-                if (k_manager.get_max_kps() < 200)
-                    str = std::format(L"{0}", static_cast<int>(k_manager.get_max_kps()));
-                else
-                    str = L"\x221E";
-
-                cache.text_format_statistics->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_TRAILING);
-                pRenderTarget->DrawTextW(str.c_str(), str.length(), cache.text_format_statistics, max_number_rect,
-                                         k_manager.is_autoplay_display() ? cache.theme_half_trans_brush
-                                                                         : cache.theme_brush);
-            }
-            {
-                std::swprintf(buffer, std::size(buffer), lang["draw.statistics.max"].c_str());
-                auto str = std::wstring(buffer);
-
-                cache.text_format_statistics_small->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_LEADING);
-                pRenderTarget->DrawTextW(str.c_str(), str.length(), cache.text_format_statistics_small, max_text_rect,
-                                         cache.theme_brush);
-            }
-            if (k_manager.is_autoplay_display()) {
-                wchar_t ch = L'\xE116';
-                pRenderTarget->DrawTextW(&ch, 1, cache.text_format_statistics_MDL2, icon_rect,
-                                         cache.theme_half_trans_brush);
-            }
-            {
-                std::swprintf(buffer, std::size(buffer), L"%d", k_manager.get_total_count());
-                auto str = std::wstring(buffer);
-
-                cache.text_format_statistics_small->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_TRAILING);
-                pRenderTarget->DrawTextW(
-                    str.c_str(), str.length(), cache.text_format_statistics_small, total_number_rect,
-                    k_manager.is_autoplay_display() ? cache.theme_half_trans_brush : cache.theme_brush);
-            }
-
-            // 平移绘制区域，使得逻辑坐标从 (0, 0) 开始。
-            {
-                D2D1_MATRIX_3X2_F transform;
-                pRenderTarget->GetTransform(&transform);
-                auto move = D2D1::Matrix3x2F::Translation(0, (cy_statistics + 0.5 * cy_separator + cy_separator) * x);
-                pRenderTarget->SetTransform(transform * move);
+    std::array<overlay::column_input, keys_manager::max_key_count> columns;
+    if (input.show_buttons) {
+        auto now = kps::clock::now();
+        for (size_t i = 0; i < count; i++) {
+            auto& label = key_labels[i];
+            if (label.code != keys[i]) {
+                auto s = cache.kc.to_short(keys[i]);
+                label.code = keys[i];
+                label.text = ConvertCode::to_wstring(s.key);
+                label.style = s.need_MDL2 ? overlay::label_style::mdl2
+                              : s.is_single ? overlay::label_style::single
+                                            : overlay::label_style::small;
             }
+            auto& col = columns[i];
+            col.label = label.text;
+            col.style = label.style;
+            col.down = snapshot.columns[i].down;
+            col.kps = column_kps[i];
+            col.since_down =
+                std::chrono::duration_cast<decltype(0.0s)>(now - snapshot.columns[i].previous_down).count();
+            col.since_up = std::chrono::duration_cast<decltype(0.0s)>(now - snapshot.columns[i].previous_up).count();
         }
+        input.columns = std::span(columns).first(count);
+    }
 
-        // 画图
-        if (cfg.show_graph()) {
-            auto graph_rect = D2D1::RectF(cx_gap * x, 0, width() - cx_gap * x,
-                                          cy_graph * x); // 图形矩形。
-            double stroke_width = 1 * x;
-            auto draw_rect = graph_rect; // 使用 DrawRectangle 时对应的矩形。
-            draw_rect.left += stroke_width / 2;
-            draw_rect.right -= stroke_width / 2;
-            draw_rect.top += stroke_width / 2;
-            draw_rect.bottom -= stroke_width / 2;
-
-            auto text_rect = draw_rect; // 文字矩形。
-
-            auto value = kps.calc_kps_recent({k_manager.get_keys().cbegin(), k_manager.get_keys().cend()});
-            double max_value = *std::max_element(value.begin(), value.end());
-            double ceil_height = std::max(5.0, 1.25 * std::max(k_manager.get_max_kps(), max_value)); // 最高点对应的值。
-
-            // 刻度。
-            {
-                color line_color =
-                    _interpolate(cache.theme_color_half_trans, cache.theme_color_full_trans, ceil_height, 60.0, 120.0);
-                SharedComPtr<ID2D1SolidColorBrush> brush;
-                pRenderTarget->CreateSolidColorBrush(line_color, brush.reset_and_get_address());
-
-                for (double v = 5; v < max_value; v += 5) {
-                    double y = draw_rect.bottom - (draw_rect.bottom - draw_rect.top) * (v / ceil_height);
-                    pRenderTarget->DrawLine(D2D1::Point2F(draw_rect.left, y), D2D1::Point2F(draw_rect.right, y), brush,
-                                            0.75 * x, cache.dash_stroke);
-                }
-            }
-            // 具体图形。
-            {
-                SharedComPtr<ID2D1PathGeometry> geometry;
-                factory::d2d1()->CreatePathGeometry(geometry.reset_and_get_address());
-                SharedComPtr<ID2D1GeometrySink> sink;
-                geometry->Open(sink.reset_and_get_address());
-                {
-                    sink->BeginFigure(D2D1::Point2F(draw_rect.right, draw_rect.bottom), D2D1_FIGURE_BEGIN_FILLED);
-                    sink->AddLine(D2D1::Point2F(draw_rect.left, draw_rect.bottom));
-                    double graph_width = draw_rect.right - draw_rect.left;
-                    double graph_height = draw_rect.bottom - draw_rect.top;
-                    for (size_t i = 0; i < value.size(); i++) {
-                        sink->AddLine(D2D1::Point2F(draw_rect.left + graph_width * i / (value.size() - 1),
-                                                    draw_rect.bottom - graph_height * (value[i] / ceil_height)));
-                    }
-                    sink->AddLine(D2D1::Point2F(draw_rect.right, draw_rect.bottom));
-                    sink->EndFigure(D2D1_FIGURE_END_CLOSED);
-                }
-                sink->Close();
+    {
+        OVERLAY_TIME_STAGE(frame_timing, overlay::frame_stage::build);
+        frame_builder.build(input, out);
+    }
+#if OSU_KPS_FRAME_TIMING
+    if (show_frame_timing) {
+        const auto x = static_cast<float>(input.scale);
+        frame_timing.append_panel(out, {2 * x, 2 * x, 150 * x, 2 * x + 8 * 13 * x});
+    }
+#endif
+}
+void main_window::render_frame(const overlay::display_list& frame) {
+    if (!d2d_inited)
+        init_d2d();
 
-                pRenderTarget->FillGeometry(geometry, cache.graph_brush);
-            }
-            // 最大值指示和键数指示。
-            {
-                double y = draw_rect.bottom - (draw_rect.bottom - draw_rect.top) * (max_value / ceil_height);
-                pRenderTarget->DrawLine(D2D1::Point2F(draw_rect.left, y), D2D1::Point2F(draw_rect.right, y),
-                                        cache.theme_brush, 0.75 * x, cache.dash_stroke);
-
-                text_rect.left += 2 * x;
-                text_rect.bottom = y - 2 * x;
-                text_rect.right -= 2 * x;
-                std::wstring buffer;
-
-                buffer = std::vformat(lang["draw.graph.recent"], std::make_wformat_args(max_value));
-                cache.text_format_graph->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_LEADING);
-                pRenderTarget->DrawTextW(buffer.c_str(), buffer.length(), cache.text_format_graph, text_rect,
-                                         cache.theme_half_trans_brush);
-
-                buffer = std::vformat(lang["draw.graph.keys"], std::make_wformat_args(k_manager.get_button_count()));
-
-                cache.text_format_graph->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_TRAILING);
-                pRenderTarget->DrawTextW(buffer.c_str(), buffer.length(), cache.text_format_graph, text_rect,
-                                         cache.theme_half_trans_brush);
-            }
-            // 外边框。
-            { pRenderTarget->DrawRectangle(draw_rect, cache.theme_brush, stroke_width); }
-
-            // 平移绘制区域，使得逻辑坐标从 (0, 0) 开始。
-            {
-                D2D1_MATRIX_3X2_F transform;
-                pRenderTarget->GetTransform(&transform);
-                auto move = D2D1::Matrix3x2F::Translation(0, (cy_graph + cy_separator) * x);
-                pRenderTarget->SetTransform(transform * move);
-            }
-        }
+    auto& device = cache.backend.device;
+    device.target = pRenderTarget;
+    device.text_formats = {
+        cache.text_format_key_name,   cache.text_format_key_name_small,   cache.text_format_key_name_MDL2,
+        cache.text_format_number,     cache.text_format_statistics,       cache.text_format_statistics_small,
+        cache.text_format_statistics_MDL2, cache.text_format_graph,
+    };
+    device.dash_stroke = cache.dash_stroke;
+
+    {
+        OVERLAY_TIME_STAGE(frame_timing, overlay::frame_stage::replay);
+        pRenderTarget->BeginDraw();
+        cache.backend.replay(frame);
+    }
+    HRESULT hr;
+    {
+        OVERLAY_TIME_STAGE(frame_timing, overlay::frame_stage::end_draw);
+        hr = pRenderTarget->EndDraw();
     }
-    HRESULT hr = pRenderTarget->EndDraw();
     if (SUCCEEDED(hr))
         ValidateRect(hwnd, nullptr);
-    else
+    else {
         d2d_inited = false;
+        frame_scheduler.invalidate();
+    }
+}
+void main_window::OnFrameTick() {
+    OVERLAY_TIME_STAGE(frame_timing, overlay::frame_stage::frame);
+    if (state_broadcaster.accept_pending())
+        state_encoder.request_keyframe(); // 新的订阅者需要完整的历史记录。
+    build_frame(next_frame, true);
+    bool should_render;
+    {
+        OVERLAY_TIME_STAGE(frame_timing, overlay::frame_stage::schedule);
+        should_render = frame_scheduler.should_render(next_frame);
+    }
+    if (should_render)
+        render_frame(frame_scheduler.present(next_frame));
+}
+void main_window::OnPaint(HWND) {
+    // 窗口需要重绘时（如大小改变、被遮挡后恢复），总是生成新的一帧并绘制。
+    build_frame(next_frame);
+    render_frame(frame_scheduler.present(next_frame));
 }
 
 int APIENTRY wWinMain(_In_ HINSTANCE, _In_opt_ HINSTANCE, _In_ LPWSTR, _In_ int) {
@@ -0,0 +1,152 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace metrics {
+    inline constexpr size_t shard_count = 16;      // 每个计数器的分片数。多于该数目的线程会共享分片，但结果仍然正确。
+    inline constexpr size_t cache_line_size = 64; // 分片对齐到的字节数。
+
+    namespace detail {
+        /// <summary>
+        /// 当前线程使用的分片。每个线程第一次调用时依次分配。
+        /// </summary>
+        inline size_t this_thread_shard() {
+            static std::atomic<size_t> next{};
+            thread_local const size_t index = next.fetch_add(1, std::memory_order_relaxed) % shard_count;
+            return index;
+        }
+    } // namespace detail
+
+    /// <summary>
+    /// 按线程分片的计数器。每个线程只写自己的缓存行，在热路径上计数不会引起争用。
+    /// 读取时对所有分片求和，可以在任意线程调用。
+    /// </summary>
+    class sharded_counter {
+    private:
+        struct alignas(cache_line_size) shard {
+            std::atomic<std::uint64_t> value{};
+            std::array<std::byte, cache_line_size - sizeof(std::atomic<std::uint64_t>)> padding; // 独占一条缓存行。
+        };
+        static_assert(sizeof(shard) == cache_line_size);
+        std::array<shard, shard_count> shards;
+
+    public:
+        void add(std::uint64_t n = 1) noexcept {
+            shards[detail::this_thread_shard()].value.fetch_add(n, std::memory_order_relaxed);
+        }
+        std::uint64_t value() const noexcept {
+            std::uint64_t ret = 0;
+            for (const auto& s : shards)
+                ret += s.value.load(std::memory_order_relaxed);
+            return ret;
+        }
+    };
+
+    /// <summary>
+    /// 计数器的集合，以 Prometheus 文本格式输出。
+    /// 计数器注册后不会被移除，返回的引用在 registry 析构前一直有效。
+    /// </summary>
+    class registry {
+    private:
+        struct entry {
+            std::string name;
+            std::string help;
+            std::string labels;                       // 例如 monitor="dinput"。可以为空。
+            double scale;                             // 输出时乘以该系数。例如以纳秒计数、以秒输出时为 1e-9。
+            std::unique_ptr<sharded_counter> counter; // 单独分配，按缓存行对齐，entry 本身不必过对齐。
+        };
+        mutable std::mutex m;
+        std::deque<entry> entries; // deque 在末尾插入时不移动已有的元素。
+
+    public:
+        /// <summary>
+        /// 获取计数器。名称与标签相同的计数器只注册一次，之后返回同一个计数器。
+        /// 可以在任意线程调用，但应在热路径之外获取并保存引用。
+        /// </summary>
+        /// <param name="name">指标名。按惯例以 _total 结尾。</param>
+        /// <param name="help">说明。同名的计数器以第一次注册时的说明为准。</param>
+        /// <param name="labels">标签，不含大括号。</param>
+        /// <param name="scale">输出时乘以的系数。</param>
+        sharded_counter& counter(std::string_view name, std::string_view help, std::string_view labels = {},
+                                 double scale = 1) {
+            std::lock_guard _(m);
+            for (auto& e : entries)
+                if (e.name == name && e.labels == labels)
+                    return *e.counter;
+            auto& e = entries.emplace_back();
+            e.name = name;
+            e.help = help;
+            e.labels = labels;
+            e.scale = scale;
+            e.counter = std::make_unique<sharded_counter>();
+            return *e.counter;
+        }
+
+    public:
+        /// <summary>
+        /// 以 Prometheus 文本格式（0.0.4）输出所有计数器。同名的计数器放在一起。
+        /// </summary>
+        std::string expose() const {
+            std::lock_guard _(m);
+            std::string ret;
+            auto out = std::back_inserter(ret);
+            std::vector<bool> written(entries.size());
+            for (size_t i = 0; i < entries.size(); i++) {
+                if (written[i])
+                    continue;
+                const auto& first = entries[i];
+                std::format_to(out, "# HELP {} {}\n# TYPE {} counter\n", first.name, first.help, first.name);
+                for (size_t j = i; j < entries.size(); j++) {
+                    const auto& e = entries[j];
+                    if (e.name != first.name)
+                        continue;
+                    written[j] = true;
+                    const auto value = e.counter->value();
+                    if (e.labels.empty())
+                        std::format_to(out, "{}", e.name);
+                    else
+                        std::format_to(out, "{}{{{}}}", e.name, e.labels);
+                    if (e.scale == 1)
+                        std::format_to(out, " {}\n", value);
+                    else
+                        std::format_to(out, " {}\n", static_cast<double>(value) * e.scale);
+                }
+            }
+            return ret;
+        }
+        /// <summary>
+        /// 将 expose 的结果写入文件。
+        /// </summary>
+        bool write_to_file(const std::filesystem::path& path) const {
+            std::ofstream ofs(path, std::ios::binary);
+            if (!ofs)
+                return false;
+            ofs << expose();
+            return static_cast<bool>(ofs);
+        }
+    };
+
+    /// <summary>
+    /// 整个程序共用的计数器集合。
+    /// </summary>
+    inline registry& global() {
+        static registry instance;
+        return instance;
+    }
+} // namespace metrics
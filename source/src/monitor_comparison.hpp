@@ -0,0 +1,226 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "key_monitor_base.hpp"
+
+namespace kps {
+    /// <summary>
+    /// 比较模式下记录的一个事件。
+    /// </summary>
+    struct recorded_event {
+        size_t source{};
+        int key{};
+        bool down{};
+        time_point time{};
+    };
+
+    /// <summary>
+    /// 一种来源的比较结果。时间差以微秒为单位，为该来源减去参照来源（第一个来源）的时间。
+    /// </summary>
+    struct source_report {
+        std::wstring name;
+        size_t events{};     // 记录到的事件数。
+        size_t matched{};    // 出现了该来源的对齐后的事件数。
+        size_t missed{};     // 其他来源有而该来源没有的事件数。
+        size_t duplicates{}; // 同一个对齐后的事件中多出的事件数，例如抖动。
+        size_t offset_count{};
+        double offset_mean{};
+        double offset_p50{};
+        double offset_min{};
+        double offset_max{};
+    };
+
+    /// <summary>
+    /// 比较的结果。
+    /// </summary>
+    struct comparison_report {
+        std::vector<source_report> sources;
+        size_t aligned_events{}; // 对齐后的事件数。
+        size_t overflow{};       // 因记录已满而未记录的事件数。
+
+        /// <summary>
+        /// 以文本表格的形式输出，每个来源一行。
+        /// </summary>
+        std::wstring text() const {
+            std::wstring ret = std::format(L"{} aligned events, offsets relative to {} (us)\n", aligned_events,
+                                           sources.empty() ? L"-" : sources.front().name);
+            if (overflow)
+                std::format_to(std::back_inserter(ret), L"{} events not recorded because the log is full\n",
+                               overflow);
+            std::format_to(std::back_inserter(ret), L"{:<10}{:>8}{:>8}{:>8}{:>8}{:>10}{:>10}{:>10}{:>10}\n",
+                           L"source", L"events", L"matched", L"missed", L"dup", L"mean", L"p50", L"min", L"max");
+            for (const auto& s : sources)
+                std::format_to(std::back_inserter(ret),
+                               L"{:<10}{:>8}{:>8}{:>8}{:>8}{:>10.0f}{:>10.0f}{:>10.0f}{:>10.0f}\n", s.name, s.events,
+                               s.matched, s.missed, s.duplicates, s.offset_mean, s.offset_p50, s.offset_min,
+                               s.offset_max);
+            return ret;
+        }
+    };
+
+    /// <summary>
+    /// 按按键与时间对齐各来源的事件。
+    /// 同一按键、同一方向的事件按时间排序后分组：每组从最早的未分组事件开始，包括此后 window 内的所有事件。
+    /// 每组视为一个真实的事件。
+    /// </summary>
+    /// <param name="names">各来源的名称。第一个来源为计算时间差的参照。</param>
+    inline comparison_report align_events(std::span<const recorded_event> events, std::span<const std::wstring> names,
+                                          clock::duration window) {
+        comparison_report ret;
+        const size_t n = names.size();
+        ret.sources.resize(n);
+        for (size_t i = 0; i < n; i++)
+            ret.sources[i].name = names[i];
+
+        std::vector<recorded_event> sorted;
+        sorted.reserve(events.size());
+        for (const auto& e : events)
+            if (e.source < n) {
+                sorted.push_back(e);
+                ret.sources[e.source].events++;
+            }
+        std::ranges::sort(sorted, {}, [](const recorded_event& e) { return std::tuple(e.key, e.down, e.time); });
+
+        std::vector<size_t> counts(n);
+        std::vector<time_point> first(n);
+        std::vector<std::vector<double>> offsets(n);
+        for (size_t begin = 0; begin < sorted.size();) {
+            const auto& head = sorted[begin];
+            size_t end = begin;
+            std::ranges::fill(counts, 0);
+            while (end < sorted.size() && sorted[end].key == head.key && sorted[end].down == head.down &&
+                   sorted[end].time - head.time <= window) {
+                const auto& e = sorted[end++];
+                if (!counts[e.source]++)
+                    first[e.source] = e.time;
+            }
+            begin = end;
+            ret.aligned_events++;
+
+            for (size_t s = 0; s < n; s++) {
+                auto& r = ret.sources[s];
+                if (!counts[s]) {
+                    r.missed++;
+                    continue;
+                }
+                r.matched++;
+                r.duplicates += counts[s] - 1;
+                if (s && counts[0])
+                    offsets[s].push_back(std::chrono::duration<double, std::micro>(first[s] - first[0]).count());
+            }
+        }
+
+        for (size_t s = 0; s < n; s++) {
+            auto& o = offsets[s];
+            auto& r = ret.sources[s];
+            r.offset_count = o.size();
+            if (o.empty())
+                continue;
+            std::ranges::sort(o);
+            double total = 0;
+            for (double v : o)
+                total += v;
+            r.offset_mean = total / static_cast<double>(o.size());
+            r.offset_p50 = o[(o.size() - 1) / 2];
+            r.offset_min = o.front();
+            r.offset_max = o.back();
+        }
+        return ret;
+    }
+
+    /// <summary>
+    /// 同时运行多种按键监视器，记录它们的事件以便比较。与 kps 使用的监视器互不影响。
+    /// </summary>
+    class monitor_comparison {
+    public:
+        static constexpr size_t max_events = size_t{1} << 20; // 最多记录的事件数。
+
+    private:
+        std::vector<std::wstring> names;
+        std::vector<std::shared_ptr<key_monitor_base>> monitors;
+
+        mutable std::mutex m;
+        std::vector<recorded_event> events;
+        size_t overflow{};
+
+        void on_key(size_t source, int key, time_point time, bool down) {
+            std::lock_guard _(m);
+            if (events.size() < max_events)
+                events.push_back({source, key, down, time});
+            else
+                overflow++;
+        }
+
+    public:
+        /// <param name="sources">各来源的名称与监视器。第一个来源为计算时间差的参照。</param>
+        explicit monitor_comparison(std::vector<std::pair<std::wstring, std::shared_ptr<key_monitor_base>>> sources) {
+            for (auto& [name, monitor] : sources) {
+                names.push_back(std::move(name));
+                monitors.push_back(std::move(monitor));
+            }
+            for (size_t i = 0; i < monitors.size(); i++)
+                monitors[i]->set_callback(std::bind_front(&monitor_comparison::on_key, this, i));
+        }
+        monitor_comparison(const monitor_comparison&) = delete;
+        monitor_comparison& operator=(const monitor_comparison&) = delete;
+        ~monitor_comparison() {
+            // reset_callback 返回后，不会再有回调函数正在运行。
+            for (auto& monitor : monitors)
+                monitor->reset_callback();
+        }
+
+    public:
+        size_t source_count() const {
+            return monitors.size();
+        }
+        /// <summary>
+        /// 对齐目前记录的所有事件。可以在任意线程调用。
+        /// </summary>
+        /// <param name="window">同一个事件在各来源之间允许的最大时间差。</param>
+        comparison_report report(clock::duration window = std::chrono::milliseconds(50)) const {
+            std::vector<recorded_event> copy;
+            size_t copy_overflow;
+            {
+                std::lock_guard _(m);
+                copy = events;
+                copy_overflow = overflow;
+            }
+            auto ret = align_events(copy, names, window);
+            ret.overflow = copy_overflow;
+            return ret;
+        }
+        /// <summary>
+        /// 将 report 的结果和所有记录的事件写入文件。
+        /// </summary>
+        bool write_to_file(const std::filesystem::path& path,
+                           clock::duration window = std::chrono::milliseconds(50)) const {
+            std::wofstream ofs(path);
+            if (!ofs)
+                return false;
+            ofs << report(window).text() << L"\nsource,key,down,time_us\n";
+            std::lock_guard _(m);
+            for (const auto& e : events)
+                ofs << names[e.source] << L',' << e.key << L',' << e.down << L','
+                    << std::chrono::duration_cast<std::chrono::microseconds>(e.time.time_since_epoch()).count()
+                    << L'\n';
+            return static_cast<bool>(ofs);
+        }
+    };
+} // namespace kps
@@ -0,0 +1,182 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+#include "timing_statistics.hpp"
+
+namespace kps {
+    /// <summary>
+    /// 各按键监视方式从得知按键到交给计算器的延迟，以及轮询方式相邻两次轮询的间隔与抖动。
+    /// 来源的下标与 key_monitor_implement_type 相同。时间以微秒为单位。
+    /// 每个来源只允许一个线程（或在同一把锁下）写入，可以在任意线程读取。
+    /// </summary>
+    class monitor_latency {
+    public:
+        static constexpr size_t source_count = 4;
+        static constexpr std::array<std::wstring_view, source_count> source_names{
+            L"async",
+            L"hook",
+            L"dinput",
+            L"memory",
+        };
+
+        enum class metric {
+            latency,  // 事件的来源时刻（钩子被调用或轮询开始）到进入 notify_key_down。
+            interval, // 相邻两次轮询的间隔。只有轮询方式有。
+            jitter,   // 相邻两个轮询间隔之差的绝对值。
+        };
+        static constexpr size_t metric_count = 3;
+        static constexpr std::array<std::wstring_view, metric_count> metric_names{
+            L"latency",
+            L"interval",
+            L"jitter",
+        };
+
+        struct summary_t {
+            std::uint64_t count{};
+            double mean{};
+            double p50{};
+            double p99{};
+            double max{};
+        };
+
+    private:
+        struct channel {
+            log_histogram histogram;
+            std::atomic<std::uint64_t> count{};
+            std::atomic<std::uint64_t> total{};
+            std::atomic<std::uint64_t> max{};
+
+            void record(std::chrono::steady_clock::duration elapsed) {
+                auto us = static_cast<std::uint64_t>(std::max<std::int64_t>(
+                    0, std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+                histogram.record(us);
+                count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                total.store(total.load(std::memory_order_relaxed) + us, std::memory_order_relaxed);
+                if (us > max.load(std::memory_order_relaxed))
+                    max.store(us, std::memory_order_relaxed);
+            }
+            void clear() {
+                histogram.clear();
+                count.store(0, std::memory_order_relaxed);
+                total.store(0, std::memory_order_relaxed);
+                max.store(0, std::memory_order_relaxed);
+            }
+        };
+        struct source_t {
+            std::array<channel, metric_count> channels;
+            // 以下两个成员只由写入轮询的线程访问。
+            std::chrono::steady_clock::time_point previous_poll{};
+            std::chrono::steady_clock::duration previous_interval{};
+        };
+        std::array<source_t, source_count> sources;
+
+        channel& at(size_t source, metric which) {
+            return sources[source].channels[static_cast<size_t>(which)];
+        }
+        const channel& at(size_t source, metric which) const {
+            return sources[source].channels[static_cast<size_t>(which)];
+        }
+
+    public:
+        /// <summary>
+        /// 记录一个事件。
+        /// </summary>
+        /// <param name="source_time">监视器得知按键的时刻，即回调函数收到的时间。</param>
+        /// <param name="ingest_time">进入 notify_key_down 的时刻。</param>
+        void record_event(size_t source, std::chrono::steady_clock::time_point source_time,
+                          std::chrono::steady_clock::time_point ingest_time) {
+            if (source < source_count)
+                at(source, metric::latency).record(ingest_time - source_time);
+        }
+        /// <summary>
+        /// 记录一次轮询。第一次轮询只作为之后的起点。
+        /// </summary>
+        void record_poll(size_t source, std::chrono::steady_clock::time_point poll_time) {
+            if (source >= source_count)
+                return;
+            auto& s = sources[source];
+            if (s.previous_poll != std::chrono::steady_clock::time_point{}) {
+                const auto interval = poll_time - s.previous_poll;
+                at(source, metric::interval).record(interval);
+                if (s.previous_interval != std::chrono::steady_clock::duration{})
+                    at(source, metric::jitter)
+                        .record(interval > s.previous_interval ? interval - s.previous_interval
+                                                               : s.previous_interval - interval);
+                s.previous_interval = interval;
+            }
+            s.previous_poll = poll_time;
+        }
+        /// <summary>
+        /// 清空统计。不重置轮询的起点。
+        /// </summary>
+        void clear() {
+            for (auto& s : sources)
+                for (auto& c : s.channels)
+                    c.clear();
+        }
+
+    public:
+        summary_t summary(size_t source, metric which) const {
+            const auto& c = at(source, which);
+            summary_t ret;
+            ret.count = c.count.load(std::memory_order_relaxed);
+            if (!ret.count)
+                return ret;
+            ret.mean = static_cast<double>(c.total.load(std::memory_order_relaxed)) / static_cast<double>(ret.count);
+            const auto counts = c.histogram.snapshot();
+            ret.p50 = log_histogram::quantile(counts, 0.5);
+            ret.p99 = log_histogram::quantile(counts, 0.99);
+            ret.max = static_cast<double>(c.max.load(std::memory_order_relaxed));
+            return ret;
+        }
+        /// <summary>
+        /// 以文本表格的形式输出统计，每个来源的每项一行。没有数据的行被省略。
+        /// </summary>
+        std::wstring report() const {
+            std::wstring ret = std::format(L"{:<16}{:>10}{:>10}{:>10}{:>10}{:>10}\n", L"source (us)", L"count",
+                                           L"mean", L"p50", L"p99", L"max");
+            for (size_t i = 0; i < source_count; i++)
+                for (size_t j = 0; j < metric_count; j++) {
+                    auto s = summary(i, static_cast<metric>(j));
+                    if (!s.count)
+                        continue;
+                    std::format_to(std::back_inserter(ret), L"{:<16}{:>10}{:>10.1f}{:>10.1f}{:>10.1f}{:>10.0f}\n",
+                                   std::format(L"{} {}", source_names[i], metric_names[j]), s.count, s.mean, s.p50,
+                                   s.p99, s.max);
+                }
+            return ret;
+        }
+        /// <summary>
+        /// 将 report 的结果和各直方图的非空桶写入文件。
+        /// </summary>
+        bool write_to_file(const std::filesystem::path& path) const {
+            std::wofstream ofs(path);
+            if (!ofs)
+                return false;
+            ofs << report() << L"\nsource,metric,lower_bound_us,count\n";
+            for (size_t i = 0; i < source_count; i++)
+                for (size_t j = 0; j < metric_count; j++) {
+                    const auto counts = at(i, static_cast<metric>(j)).histogram.snapshot();
+                    for (size_t b = 0; b < counts.size(); b++)
+                        if (counts[b])
+                            ofs << source_names[i] << L',' << metric_names[j] << L','
+                                << log_histogram::lower_bound_of(b) << L',' << counts[b] << L'\n';
+                }
+            return static_cast<bool>(ofs);
+        }
+    };
+} // namespace kps
@@ -0,0 +1,80 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <cstdint>
+
+namespace overlay {
+    /// <summary>
+    /// 与绘图后端无关的颜色类。各分量在 [0, 1] 中。
+    /// </summary>
+    class color {
+    public:
+        float r{};
+        float g{};
+        float b{};
+        float a{1};
+
+    public:
+        static constexpr unsigned red_shift = 16;
+        static constexpr unsigned green_shift = 8;
+        static constexpr unsigned blue_shift = 0;
+        static constexpr unsigned alpha_shift = 24;
+        static constexpr unsigned red_mask = 0xff << red_shift;
+        static constexpr unsigned green_mask = 0xff << green_shift;
+        static constexpr unsigned blue_mask = 0xff << blue_shift;
+        static constexpr unsigned alpha_mask = 0xffu << alpha_shift;
+
+    public:
+        constexpr color() = default;
+        constexpr color(unsigned int rgb_or_argb, unsigned char a = 0)
+            : r{static_cast<float>((rgb_or_argb & red_mask) >> red_shift) / 255.f},
+              g{static_cast<float>((rgb_or_argb & green_mask) >> green_shift) / 255.f},
+              b{static_cast<float>((rgb_or_argb & blue_mask) >> blue_shift) / 255.f} {
+            if (a)
+                this->a = static_cast<float>(a / 255.f);
+            else
+                this->a = static_cast<float>((rgb_or_argb & alpha_mask) >> alpha_shift) / 255.f;
+        }
+        constexpr color(float r, float g, float b, float a = 1.f) : r(r), g(g), b(b), a(a) {}
+        constexpr color(unsigned r, unsigned g, unsigned b, unsigned a = 255)
+            : r(static_cast<float>(r) / 255.f), g(static_cast<float>(g) / 255.f), b(static_cast<float>(b) / 255.f),
+              a(static_cast<float>(a) / 255.f) {}
+
+    public:
+        static constexpr color linear_interpolation(const color& c0, const color& c1, float ratio) {
+            color ret;
+            ret.r = c0.r * (1 - ratio) + c1.r * ratio;
+            ret.g = c0.g * (1 - ratio) + c1.g * ratio;
+            ret.b = c0.b * (1 - ratio) + c1.b * ratio;
+            ret.a = c0.a * (1 - ratio) + c1.a * ratio;
+            return ret;
+        }
+
+        /// <summary>
+        /// 将各分量舍入到 8 位精度。屏幕上无法区分的颜色在舍入后相等。
+        /// </summary>
+        constexpr color quantized() const {
+            auto q = [](float v) {
+                v = v < 0 ? 0 : v > 1 ? 1 : v;
+                return static_cast<float>(static_cast<unsigned>(v * 255.f + 0.5f)) / 255.f;
+            };
+            return color(q(r), q(g), q(b), q(a));
+        }
+
+        /// <summary>
+        /// 按 8 位精度打包为 0xRRGGBBAA。
+        /// </summary>
+        constexpr std::uint32_t to_rgba8() const {
+            auto q = [](float v) {
+                v = v < 0 ? 0 : v > 1 ? 1 : v;
+                return static_cast<std::uint32_t>(v * 255.f + 0.5f);
+            };
+            return q(r) << 24 | q(g) << 16 | q(b) << 8 | q(a);
+        }
+
+    public:
+        constexpr bool operator==(const color&) const = default;
+    };
+} // namespace overlay
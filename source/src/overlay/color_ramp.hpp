@@ -0,0 +1,117 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+#include "color.hpp"
+
+namespace overlay {
+    /// <summary>
+    /// 将颜色根据参数进行插值。
+    /// crt 从 0 到 threshold 1 之间，总是 from。
+    /// crt 接近 threshold2 时，接近 to（0.9）。
+    /// crt 趋于正无穷时，为 to。当 crt 为负数时，行为未定义。
+    /// </summary>
+    /// <typeparam name="param_t"></typeparam>
+    /// <param name="from"></param>
+    /// <param name="to"></param>
+    /// <param name="crt">当前参数。</param>
+    /// <param name="threshold1">阈值 1。</param>
+    /// <returns></returns>
+    template <typename param_t>
+    color interpolate(color from, color to, param_t crt, param_t threshold1, param_t threshold2) {
+        if (crt < 0 || threshold1 < 0 || threshold2 < threshold1)
+            throw std::invalid_argument("invalid argument.");
+
+        double ratio{};
+        if (crt >= threshold1) {
+            crt -= threshold1;
+            auto sigmoid = [](double x) { return 1 / (1 + std::exp(-x)); };
+            constexpr double ratio_t2 = 0.9;
+            double a = -std::log(1 / ratio_t2 - 1) / std::log(std::exp(1)) / (threshold2 - threshold1);
+            ratio = (sigmoid(a * crt) - 0.5) * 2;
+        }
+        return color::linear_interpolation(from, to, static_cast<float>(ratio));
+    }
+
+    namespace detail {
+        inline constexpr size_t ramp_table_size = 256; // 表的区间个数。
+        inline constexpr double ramp_max_u = 8;        // u 超过该值时比例视为 1，误差小于 1e-7。
+
+        /// <summary>
+        /// 编译期计算 (9^u - 1) / (9^u + 1)，u = i * ramp_max_u / ramp_table_size。
+        /// </summary>
+        constexpr std::array<float, ramp_table_size + 1> make_ramp_table() {
+            constexpr double ln9 = 2.1972245773362196;
+            constexpr double x = ln9 * ramp_max_u / ramp_table_size;
+            // 用泰勒级数求 9 ^ (ramp_max_u / ramp_table_size) = e ^ x，x 很小，级数很快收敛。
+            double step = 1;
+            double term = 1;
+            for (int k = 1; k < 20; k++) {
+                term *= x / k;
+                step += term;
+            }
+            std::array<float, ramp_table_size + 1> ret{};
+            double power = 1; // 9 ^ u。
+            for (size_t i = 0; i <= ramp_table_size; i++) {
+                ret[i] = static_cast<float>((power - 1) / (power + 1));
+                power *= step;
+            }
+            return ret;
+        }
+        inline constexpr auto ramp_table = make_ramp_table();
+    } // namespace detail
+
+    /// <summary>
+    /// 查表实现的 interpolate。阈值在编译期确定。
+    /// 令 u = (crt - threshold1) / (threshold2 - threshold1)，interpolate 的比例为 (9^u - 1) / (9^u + 1)，
+    /// 与具体阈值无关，因此所有色阶共用一张表，表项之间线性插值。
+    /// </summary>
+    class color_ramp {
+    private:
+        static constexpr size_t table_size = detail::ramp_table_size;
+        static constexpr const auto& table = detail::ramp_table;
+
+        double threshold1;
+        double scale; // 把 crt - threshold1 换算为表的下标。
+
+    public:
+        constexpr color_ramp(double threshold1, double threshold2)
+            : threshold1(threshold1), scale(table_size / detail::ramp_max_u / (threshold2 - threshold1)) {
+            if (threshold1 < 0 || !(threshold2 > threshold1))
+                throw std::invalid_argument("invalid argument.");
+        }
+
+        /// <summary>
+        /// 求插值比例。crt 不超过 threshold1 时为 0。
+        /// </summary>
+        constexpr float ratio(double crt) const {
+            const double pos = (crt - threshold1) * scale;
+            if (!(pos > 0))
+                return 0;
+            if (pos >= table_size)
+                return 1;
+            const auto i = static_cast<size_t>(pos);
+            const auto t = static_cast<float>(pos - static_cast<double>(i));
+            return table[i] + (table[i + 1] - table[i]) * t;
+        }
+        constexpr color operator()(const color& from, const color& to, double crt) const {
+            return color::linear_interpolation(from, to, ratio(crt));
+        }
+    };
+
+    /// <summary>
+    /// 界面中使用的色阶。
+    /// </summary>
+    namespace ramps {
+        inline constexpr color_ramp button_kps{2.0, 4.0};       // 按键框颜色随该列 KPS 变化。
+        inline constexpr color_ramp kps_now{6.0, 13.0};         // 当前 KPS 数字颜色。
+        inline constexpr color_ramp key_down{0.01, 0.03};       // 按下后发光出现，以秒为单位。
+        inline constexpr color_ramp key_up{0.05, 0.25};         // 放开后发光消失，以秒为单位。
+        inline constexpr color_ramp graph_ceiling{60.0, 120.0}; // 图的刻度随上限变淡。
+    } // namespace ramps
+} // namespace overlay
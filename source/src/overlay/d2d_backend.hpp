@@ -0,0 +1,127 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <array>
+#include <span>
+#include <string_view>
+
+#include "../utils/d2d/SharedComPtr.hpp"
+#include "../utils/d2d_helper.hpp"
+
+#include "display_list.hpp"
+#include "renderer.hpp"
+
+namespace overlay {
+    /// <summary>
+    /// Direct2D 绘图设备。只负责创建资源和绘制，不做任何布局计算，也不缓存资源。
+    /// 文字通过 create_text_layout 预先排版，由 renderer 缓存排版。
+    /// 资源由窗口创建并持有，每帧重放前设置。
+    /// </summary>
+    struct d2d_device {
+        using brush_t = orange::SharedComPtr<ID2D1SolidColorBrush>;
+        using gradient_t = orange::SharedComPtr<ID2D1LinearGradientBrush>;
+        using geometry_t = orange::SharedComPtr<ID2D1PathGeometry>;
+        using layout_t = orange::SharedComPtr<IDWriteTextLayout>;
+
+        ID2D1RenderTarget* target{};
+        std::array<IDWriteTextFormat*, text_style_count> text_formats{}; // 按 text_style 索引。
+        ID2D1StrokeStyle* dash_stroke{};
+
+    private:
+        static D2D1_RECT_F to_d2d(const rect& r) {
+            return D2D1::RectF(r.left, r.top, r.right, r.bottom);
+        }
+        static D2D1_POINT_2F to_d2d(const point& p) {
+            return D2D1::Point2F(p.x, p.y);
+        }
+        static D2D1_COLOR_F to_d2d(const color& c) {
+            return D2D1::ColorF(c.r, c.g, c.b, c.a);
+        }
+        static DWRITE_TEXT_ALIGNMENT to_d2d(text_align align) {
+            switch (align) {
+            case text_align::center: return DWRITE_TEXT_ALIGNMENT_CENTER;
+            case text_align::trailing: return DWRITE_TEXT_ALIGNMENT_TRAILING;
+            default: return DWRITE_TEXT_ALIGNMENT_LEADING;
+            }
+        }
+
+    public:
+        brush_t create_solid_brush(const color& c) const {
+            brush_t brush;
+            target->CreateSolidColorBrush(to_d2d(c), brush.reset_and_get_address());
+            return brush;
+        }
+        gradient_t create_gradient(const std::array<gradient_stop, 3>& stops) const {
+            std::array<D2D1_GRADIENT_STOP, 3> d2d_stops;
+            for (size_t i = 0; i < stops.size(); i++)
+                d2d_stops[i] = {stops[i].position, to_d2d(stops[i].c)};
+            orange::SharedComPtr<ID2D1GradientStopCollection> collection;
+            target->CreateGradientStopCollection(d2d_stops.data(), static_cast<UINT32>(d2d_stops.size()),
+                                                 collection.reset_and_get_address());
+            gradient_t gradient;
+            target->CreateLinearGradientBrush(D2D1::LinearGradientBrushProperties({}, {}), D2D1::BrushProperties(),
+                                              collection, gradient.reset_and_get_address());
+            return gradient;
+        }
+        geometry_t create_geometry(std::span<const point> points) const {
+            geometry_t geometry;
+            d2d_helper::factory::d2d1()->CreatePathGeometry(geometry.reset_and_get_address());
+            orange::SharedComPtr<ID2D1GeometrySink> sink;
+            geometry->Open(sink.reset_and_get_address());
+            sink->BeginFigure(to_d2d(points[0]), D2D1_FIGURE_BEGIN_FILLED);
+            for (size_t i = 1; i < points.size(); i++)
+                sink->AddLine(to_d2d(points[i]));
+            sink->EndFigure(D2D1_FIGURE_END_CLOSED);
+            sink->Close();
+            return geometry;
+        }
+        layout_t create_text_layout(std::wstring_view str, text_style style, text_align align, const rect& box) const {
+            layout_t layout;
+            d2d_helper::factory::dwrite()->CreateTextLayout(str.data(), static_cast<UINT32>(str.size()),
+                                                            text_formats[static_cast<size_t>(style)],
+                                                            box.right - box.left, box.bottom - box.top,
+                                                            layout.reset_and_get_address());
+            layout->SetTextAlignment(to_d2d(align));
+            return layout;
+        }
+
+    public:
+        void clear(const color& c) const {
+            target->SetTransform(D2D1::IdentityMatrix());
+            target->Clear(to_d2d(c));
+        }
+        void fill_rounded_rect(const rect& r, float radius, const brush_t& brush) const {
+            target->FillRoundedRectangle(D2D1::RoundedRect(to_d2d(r), radius, radius), brush);
+        }
+        void stroke_rounded_rect(const rect& r, float radius, float width, const brush_t& brush) const {
+            target->DrawRoundedRectangle(D2D1::RoundedRect(to_d2d(r), radius, radius), brush, width);
+        }
+        void stroke_rect(const rect& r, float width, const brush_t& brush) const {
+            target->DrawRectangle(to_d2d(r), brush, width);
+        }
+        void line(const point& from, const point& to, float width, const brush_t& brush, bool dashed) const {
+            target->DrawLine(to_d2d(from), to_d2d(to), brush, width, dashed ? dash_stroke : nullptr);
+        }
+        void text(const rect& box, std::wstring_view str, text_style style, text_align align,
+                  const brush_t& brush) const {
+            auto* format = text_formats[static_cast<size_t>(style)];
+            format->SetTextAlignment(to_d2d(align));
+            target->DrawTextW(str.data(), static_cast<UINT32>(str.size()), format, to_d2d(box), brush);
+        }
+        void draw_text_layout(const layout_t& layout, const rect& box, const brush_t& brush) const {
+            target->DrawTextLayout(D2D1::Point2F(box.left, box.top), layout, brush);
+        }
+        void fill_geometry(const geometry_t& geometry, const gradient_t& gradient, const rect& gradient_box) const {
+            gradient->SetStartPoint(D2D1::Point2F(0, gradient_box.bottom));
+            gradient->SetEndPoint(D2D1::Point2F(0, gradient_box.top));
+            target->FillGeometry(geometry, gradient);
+        }
+    };
+
+    /// <summary>
+    /// 使用 Direct2D 重放显示列表的后端。
+    /// </summary>
+    using d2d_backend = renderer<d2d_device>;
+} // namespace overlay
@@ -0,0 +1,267 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <format>
+#include <iterator>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "color.hpp"
+
+namespace overlay {
+    struct point {
+        float x{};
+        float y{};
+
+        bool operator==(const point&) const = default;
+    };
+    struct rect {
+        float left{};
+        float top{};
+        float right{};
+        float bottom{};
+
+        bool operator==(const rect&) const = default;
+    };
+
+    /// <summary>
+    /// 文字的样式，对应后端的一种字体格式。竖直方向的对齐方式由样式决定。
+    /// </summary>
+    enum class text_style : std::uint8_t {
+        key_name,
+        key_name_small,
+        key_name_mdl2,
+        number,
+        statistics,
+        statistics_small,
+        statistics_mdl2,
+        graph,
+    };
+    inline constexpr size_t text_style_count = 8;
+    /// <summary>
+    /// 文字在水平方向的对齐方式。
+    /// </summary>
+    enum class text_align : std::uint8_t {
+        leading,
+        center,
+        trailing,
+    };
+
+    struct gradient_stop {
+        float position{};
+        color c;
+
+        bool operator==(const gradient_stop&) const = default;
+    };
+
+    /// <summary>
+    /// 显示列表中的绘图命令。坐标均以像素为单位，原点为窗口左上角。
+    /// </summary>
+    namespace command {
+        struct clear {
+            color c;
+
+            bool operator==(const clear&) const = default;
+        };
+        struct fill_rounded_rect {
+            rect r;
+            float radius{};
+            color c;
+
+            bool operator==(const fill_rounded_rect&) const = default;
+        };
+        struct stroke_rounded_rect {
+            rect r;
+            float radius{};
+            float width{};
+            color c;
+
+            bool operator==(const stroke_rounded_rect&) const = default;
+        };
+        struct stroke_rect {
+            rect r;
+            float width{};
+            color c;
+
+            bool operator==(const stroke_rect&) const = default;
+        };
+        struct line {
+            point from;
+            point to;
+            float width{};
+            color c;
+            bool dashed{};
+
+            bool operator==(const line&) const = default;
+        };
+        /// <summary>
+        /// 文字。内容为显示列表文字缓冲区中 [offset, offset + length) 的部分。
+        /// </summary>
+        struct text {
+            rect box;
+            std::uint32_t offset{};
+            std::uint32_t length{};
+            text_style style{};
+            text_align align{};
+            color c;
+
+            bool operator==(const text&) const = default;
+        };
+        /// <summary>
+        /// 以竖直方向的渐变色填充的多边形。顶点为显示列表顶点缓冲区中 [first, first + count) 的部分。
+        /// 渐变从 gradient_box 的底边（位置 0）到顶边（位置 1）。
+        /// </summary>
+        struct fill_polygon {
+            std::uint32_t first{};
+            std::uint32_t count{};
+            rect gradient_box;
+            std::array<gradient_stop, 3> stops{};
+
+            bool operator==(const fill_polygon&) const = default;
+        };
+    } // namespace command
+
+    using command_t = std::variant<command::clear, command::fill_rounded_rect, command::stroke_rounded_rect,
+                                   command::stroke_rect, command::line, command::text, command::fill_polygon>;
+
+    /// <summary>
+    /// 一帧的显示列表。与绘图后端无关，后端只需按顺序重放其中的命令。
+    /// 清空时保留已分配的内存，稳定后每帧不再分配内存。
+    /// </summary>
+    class display_list {
+    private:
+        std::vector<command_t> commands_;
+        std::vector<point> points_;
+        std::wstring text_;
+
+    public:
+        void clear() {
+            commands_.clear();
+            points_.clear();
+            text_.clear();
+        }
+        template <typename command_type>
+        void push(const command_type& cmd) {
+            commands_.emplace_back(cmd);
+        }
+
+        /// <summary>
+        /// 添加多边形的顶点，返回其在顶点缓冲区中的起始位置。
+        /// </summary>
+        std::uint32_t add_points(std::span<const point> points) {
+            auto first = static_cast<std::uint32_t>(points_.size());
+            points_.insert(points_.end(), points.begin(), points.end());
+            return first;
+        }
+        /// <summary>
+        /// 添加一个顶点。用于逐个生成顶点的情况。
+        /// </summary>
+        void add_point(point p) {
+            points_.push_back(p);
+        }
+        std::uint32_t point_count() const {
+            return static_cast<std::uint32_t>(points_.size());
+        }
+
+        void add_text(rect box, text_style style, text_align align, color c, std::wstring_view str) {
+            auto offset = static_cast<std::uint32_t>(text_.size());
+            text_.append(str);
+            push(command::text{box, offset, static_cast<std::uint32_t>(str.size()), style, align, c});
+        }
+        /// <summary>
+        /// 添加格式化的文字。直接格式化到文字缓冲区中。
+        /// </summary>
+        void add_vformatted_text(rect box, text_style style, text_align align, color c, std::wstring_view fmt,
+                                 std::wformat_args args) {
+            auto offset = static_cast<std::uint32_t>(text_.size());
+            std::vformat_to(std::back_inserter(text_), fmt, args);
+            push(command::text{box, offset, static_cast<std::uint32_t>(text_.size() - offset), style, align, c});
+        }
+        template <typename... Args>
+        void add_formatted_text(rect box, text_style style, text_align align, color c,
+                                std::wformat_string<Args...> fmt, Args&&... args) {
+            auto offset = static_cast<std::uint32_t>(text_.size());
+            std::format_to(std::back_inserter(text_), fmt, std::forward<Args>(args)...);
+            push(command::text{box, offset, static_cast<std::uint32_t>(text_.size() - offset), style, align, c});
+        }
+
+    public:
+        std::span<const command_t> commands() const {
+            return commands_;
+        }
+        std::span<const point> points(const command::fill_polygon& cmd) const {
+            return std::span(points_).subspan(cmd.first, cmd.count);
+        }
+        std::wstring_view text(const command::text& cmd) const {
+            return std::wstring_view(text_).substr(cmd.offset, cmd.length);
+        }
+
+    public:
+        bool operator==(const display_list&) const = default;
+
+        /// <summary>
+        /// 以文本形式描述显示列表，每条命令一行。用于比较两帧的差异。
+        /// </summary>
+        std::string to_string() const {
+            std::string ret;
+            auto out = std::back_inserter(ret);
+            auto format_color = [](const color& c) {
+                auto byte = [](float v) { return static_cast<unsigned>(v <= 0 ? 0 : v >= 1 ? 255 : v * 255 + 0.5f); };
+                return std::format("#{:02x}{:02x}{:02x}{:02x}", byte(c.r), byte(c.g), byte(c.b), byte(c.a));
+            };
+            auto format_rect = [](const rect& r) {
+                return std::format("({:.2f}, {:.2f}, {:.2f}, {:.2f})", r.left, r.top, r.right, r.bottom);
+            };
+            for (const auto& cmd : commands_) {
+                std::visit(
+                    [&](const auto& c) {
+                        using T = std::decay_t<decltype(c)>;
+                        if constexpr (std::is_same_v<T, command::clear>)
+                            std::format_to(out, "clear {}\n", format_color(c.c));
+                        else if constexpr (std::is_same_v<T, command::fill_rounded_rect>)
+                            std::format_to(out, "fill_rounded_rect {} r={:.2f} {}\n", format_rect(c.r), c.radius,
+                                           format_color(c.c));
+                        else if constexpr (std::is_same_v<T, command::stroke_rounded_rect>)
+                            std::format_to(out, "stroke_rounded_rect {} r={:.2f} w={:.2f} {}\n", format_rect(c.r),
+                                           c.radius, c.width, format_color(c.c));
+                        else if constexpr (std::is_same_v<T, command::stroke_rect>)
+                            std::format_to(out, "stroke_rect {} w={:.2f} {}\n", format_rect(c.r), c.width,
+                                           format_color(c.c));
+                        else if constexpr (std::is_same_v<T, command::line>)
+                            std::format_to(out, "line ({:.2f}, {:.2f}) ({:.2f}, {:.2f}) w={:.2f} {}{}\n", c.from.x,
+                                           c.from.y, c.to.x, c.to.y, c.width, format_color(c.c),
+                                           c.dashed ? " dashed" : "");
+                        else if constexpr (std::is_same_v<T, command::text>) {
+                            std::format_to(out, "text {} style={} align={} {} \"", format_rect(c.box),
+                                           static_cast<int>(c.style), static_cast<int>(c.align), format_color(c.c));
+                            for (wchar_t ch : text(c)) {
+                                if (0x20 <= ch && ch < 0x7F && ch != L'"' && ch != L'\\')
+                                    *out++ = static_cast<char>(ch);
+                                else
+                                    std::format_to(out, "\\u{:04x}", static_cast<unsigned>(ch));
+                            }
+                            std::format_to(out, "\"\n");
+                        } else if constexpr (std::is_same_v<T, command::fill_polygon>) {
+                            std::format_to(out, "fill_polygon {} stops=", format_rect(c.gradient_box));
+                            for (const auto& stop : c.stops)
+                                std::format_to(out, "{:.2f}:{} ", stop.position, format_color(stop.c));
+                            std::format_to(out, "points=");
+                            for (const auto& p : points(c))
+                                std::format_to(out, "({:.2f}, {:.2f})", p.x, p.y);
+                            std::format_to(out, "\n");
+                        }
+                    },
+                    cmd);
+            }
+            return ret;
+        }
+    };
+} // namespace overlay
@@ -0,0 +1,319 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "color.hpp"
+#include "color_ramp.hpp"
+#include "display_list.hpp"
+#include "graph_series.hpp"
+#include "text_runs.hpp"
+
+namespace overlay {
+    /// <summary>
+    /// 主题颜色。
+    /// </summary>
+    struct theme {
+        static constexpr auto theme_color = color(203u, 237u, 238u);
+        static constexpr auto theme_color_half_trans = color(203u, 237u, 238u, 191u);
+        static constexpr auto theme_color_full_trans = color(203u, 237u, 238u, 0u);
+        static constexpr auto light_active_color = color(227u, 172u, 181u);
+        static constexpr auto active_color = color(255u, 104u, 143u);
+        static constexpr auto background_color = color(0u, 0u, 0u);
+    };
+
+    /// <summary>
+    /// 绘图位置参数。计算时不考虑缩放，最后再乘以缩放。
+    /// </summary>
+    struct layout {
+        static constexpr double cx_button = 52.0;
+        static constexpr double cy_button = 72.0;
+        static constexpr double cx_gap = 8.0;
+        static constexpr double cy_separator = 8.0;
+        static constexpr double cx_statistics = 232.0;
+        static constexpr double cx_kps_number = 33.0;
+        static constexpr double cx_kps_text = 33.0;
+        static constexpr double cx_total_number = 40.0;
+        static constexpr double cy_statistics = 20.0;
+        static constexpr double cy_statistics_small = 15.0;
+        static constexpr double cy_graph = 80.0;
+    };
+
+    /// <summary>
+    /// 按键名的显示方式。
+    /// </summary>
+    enum class label_style {
+        single, // 单个字符。
+        small,  // 多个字符，使用小号字体。
+        mdl2,   // 使用 Segoe MDL2 Assets 中的图标。
+    };
+
+    /// <summary>
+    /// 一列按键在本帧的状态。
+    /// </summary>
+    struct column_input {
+        std::wstring_view label;
+        label_style style{};
+        bool down{};
+        double kps{};        // 该列当前的 KPS。
+        double since_down{}; // 距上一次按下的秒数。
+        double since_up{};   // 距上一次放开的秒数。
+    };
+
+    /// <summary>
+    /// 与语言相关的文字。只在切换语言时更新。
+    /// </summary>
+    struct frame_strings {
+        std::wstring max_caption;   // 最大 KPS 的说明文字。
+        std::wstring recent_format; // 图中最大值的格式，参数为最大值。
+        std::wstring keys_format;   // 图中键数的格式，参数为键数。
+    };
+
+    /// <summary>
+    /// 生成一帧所需的全部输入。
+    /// </summary>
+    struct frame_input {
+        double scale{1};  // 总比例因子。
+        double width{};   // 窗口宽度，以像素为单位。
+        bool show_buttons{};
+        bool show_statistics{};
+        bool show_graph{};
+
+        int button_count{};
+        std::span<const column_input> columns; // 仅在显示按键时需要。
+
+        double kps_now{};
+        double max_kps{};
+        bool is_autoplay{};
+        int total_count{};
+
+        std::span<const double> history;      // 最近的 KPS，一秒一个，按时间升序。
+        long long history_first_second{};     // history[0] 对应的秒数。
+        std::uint64_t history_generation{};   // 见 kps::stamped_history。为 0 时每帧完整计算图形。
+        const frame_strings* strings{};
+    };
+
+    /// <summary>
+    /// 根据输入生成显示列表。与绘图后端无关，不调用任何系统接口。
+    /// 插值得到的颜色均舍入到 8 位精度，因此看起来相同的两帧生成的显示列表也相同。
+    /// 图形的数据序列和格式化后的文字跨帧保存，以便增量更新和复用。
+    /// </summary>
+    class frame_builder {
+    private:
+        graph_series graph;
+        text_run_cache texts;
+
+    public:
+        void build(const frame_input& in, display_list& out) {
+            out.clear();
+            out.push(command::clear{theme::background_color});
+            double top = 0; // 当前区块的顶部。
+            if (in.show_buttons) {
+                build_buttons(in, top, out);
+                top += (layout::cy_button + layout::cy_separator) * in.scale;
+            }
+            if (in.show_statistics) {
+                build_statistics(in, top, out);
+                top += (layout::cy_statistics + 0.5 * layout::cy_separator + layout::cy_separator) * in.scale;
+            }
+            if (in.show_graph)
+                build_graph(in, top, out);
+        }
+
+    private:
+        static rect make_rect(double left, double top, double right, double bottom) {
+            return {static_cast<float>(left), static_cast<float>(top), static_cast<float>(right),
+                    static_cast<float>(bottom)};
+        }
+        static rect inflate(rect r, double d) {
+            auto f = static_cast<float>(d);
+            return {r.left - f, r.top - f, r.right + f, r.bottom + f};
+        }
+
+        void build_buttons(const frame_input& in, double top, display_list& out) {
+            const double x = in.scale;
+            for (size_t i = 0; i < in.columns.size(); i++) {
+                const auto& col = in.columns[i];
+                auto original_rect = make_rect(i * (layout::cx_button + layout::cx_gap) * x, top,
+                                               (i * (layout::cx_button + layout::cx_gap) + layout::cx_button) * x,
+                                               top + layout::cy_button * x); // 框对应矩形。
+                double stroke_width = 2 * x;
+                auto draw_rect = inflate(original_rect, -stroke_width / 2); // 描边时对应的矩形。
+                auto radius = static_cast<float>(4.0 * x);
+
+                auto key_name_rect = original_rect; // 每个框的键名对应的矩形。
+                key_name_rect.bottom -= (key_name_rect.bottom - key_name_rect.top) * 2 / 5;
+                auto number_rect = original_rect; // 每个框的数字对应的矩形。
+                number_rect.top += (number_rect.bottom - number_rect.top) * 2 / 5;
+
+                const color kps_color =
+                    ramps::button_kps(theme::theme_color, theme::light_active_color, col.kps).quantized();
+
+                // 按键的发光效果。
+                {
+                    color brush_color = kps_color;
+                    color brush_color_transparent = brush_color;
+                    color down_color;
+                    {
+                        brush_color.a = 0;
+                        brush_color_transparent.a = 0.675f;
+                        down_color = ramps::key_down(brush_color, brush_color_transparent, col.since_down);
+                    }
+                    if (col.down) {
+                        brush_color = down_color;
+                    } else {
+                        brush_color.a = brush_color_transparent.a;
+                        brush_color_transparent.a = 0;
+                        brush_color = ramps::key_up(brush_color, brush_color_transparent, col.since_up);
+                    }
+
+                    brush_color = brush_color.quantized();
+                    if (brush_color.a > 0)
+                        out.push(command::fill_rounded_rect{draw_rect, radius, brush_color});
+                }
+
+                // 写字。
+                {
+                    text_style style = col.style == label_style::mdl2     ? text_style::key_name_mdl2
+                                       : col.style == label_style::single ? text_style::key_name
+                                                                          : text_style::key_name_small;
+                    out.add_text(key_name_rect, style, text_align::center, theme::theme_color, col.label);
+                }
+                out.add_text(number_rect, text_style::number, text_align::center, theme::theme_color,
+                             texts.get(text_format::integer, static_cast<int>(col.kps)));
+
+                // 最外层的框。
+                out.push(
+                    command::stroke_rounded_rect{draw_rect, radius, static_cast<float>(stroke_width), kps_color});
+            }
+        }
+
+        void build_statistics(const frame_input& in, double top, display_list& out) {
+            const double x = in.scale;
+            using l = layout;
+            auto kps_number_rect =
+                make_rect(l::cx_gap * x, top, (l::cx_gap + l::cx_kps_number) * x,
+                          top + l::cy_statistics * x); // kps 数值矩形。
+            auto kps_text_rect = make_rect(kps_number_rect.right + l::cx_gap * x,
+                                           top + (l::cy_statistics - l::cy_statistics_small) * x,
+                                           kps_number_rect.right + (l::cx_gap + l::cx_kps_text) * x,
+                                           top + l::cy_statistics * x); // kps 文字矩形。
+            auto max_number_rect = make_rect(kps_text_rect.right + l::cx_gap * x, top,
+                                             kps_text_rect.right + (l::cx_gap + l::cx_kps_number) * x,
+                                             top + l::cy_statistics * x); // 最大 kps 数值矩形。
+            auto max_text_rect = make_rect(max_number_rect.right + l::cx_gap * x,
+                                           top + (l::cy_statistics - l::cy_statistics_small) * x,
+                                           max_number_rect.right + (l::cx_gap + l::cx_kps_text) * x,
+                                           top + l::cy_statistics * x); // 最大 kps 文字矩形。
+            auto icon_rect = make_rect(max_text_rect.right, top + (l::cy_statistics - l::cy_statistics_small) * x,
+                                       (l::cx_statistics - l::cx_gap) * x,
+                                       top + l::cy_statistics * x); // 图标矩形。
+            auto total_number_rect = make_rect(max_text_rect.right + l::cx_gap * x,
+                                               top + (l::cy_statistics - l::cy_statistics_small) * x,
+                                               (l::cx_statistics - l::cx_gap) * x,
+                                               top + l::cy_statistics * x); // 总按键数值矩形。
+            const color secondary = in.is_autoplay ? theme::theme_color_half_trans : theme::theme_color;
+
+            {
+                color text_color = ramps::kps_now(theme::theme_color, theme::active_color, in.kps_now).quantized();
+                if (in.kps_now < 200)
+                    out.add_text(kps_number_rect, text_style::statistics, text_align::trailing, text_color,
+                                 texts.get(text_format::integer, static_cast<int>(in.kps_now)));
+                else
+                    out.add_text(kps_number_rect, text_style::statistics, text_align::trailing, text_color,
+                                 L"\x221E");
+            }
+            out.add_text(kps_text_rect, text_style::statistics_small, text_align::leading, theme::theme_color,
+                         L"KPS");
+            if (in.max_kps < 200)
+                out.add_text(max_number_rect, text_style::statistics, text_align::trailing, secondary,
+                             texts.get(text_format::integer, static_cast<int>(in.max_kps)));
+            else
+                out.add_text(max_number_rect, text_style::statistics, text_align::trailing, secondary, L"\x221E");
+            if (in.strings)
+                out.add_text(max_text_rect, text_style::statistics_small, text_align::leading, theme::theme_color,
+                             in.strings->max_caption);
+            if (in.is_autoplay)
+                out.add_text(icon_rect, text_style::statistics_mdl2, text_align::leading,
+                             theme::theme_color_half_trans, L"\xE116");
+            // 总按键数几乎每次按键都不同，缓存没有意义。直接格式化到显示列表中，不会分配内存。
+            out.add_formatted_text(total_number_rect, text_style::statistics_small, text_align::trailing, secondary,
+                                   L"{}", in.total_count);
+        }
+
+        void build_graph(const frame_input& in, double top, display_list& out) {
+            const double x = in.scale;
+            auto graph_rect = make_rect(layout::cx_gap * x, top, in.width - layout::cx_gap * x,
+                                        top + layout::cy_graph * x); // 图形矩形。
+            double stroke_width = 1 * x;
+            auto draw_rect = inflate(graph_rect, -stroke_width / 2); // 描边时对应的矩形。
+            const double graph_width = draw_rect.right - draw_rect.left;
+            const double graph_height = draw_rect.bottom - draw_rect.top;
+
+            graph.update(in.history, in.history_first_second, in.history_generation,
+                         static_cast<size_t>(std::max(1.0, graph_width)));
+            double max_value = graph.max();
+            double ceil_height = std::max(5.0, 1.25 * std::max(in.max_kps, max_value)); // 最高点对应的值。
+            auto y_of = [&](double v) { return static_cast<float>(draw_rect.bottom - graph_height * (v / ceil_height)); };
+
+            // 刻度。
+            {
+                color line_color =
+                    ramps::graph_ceiling(theme::theme_color_half_trans, theme::theme_color_full_trans, ceil_height)
+                        .quantized();
+                for (double v = 5; v < max_value; v += 5) {
+                    float y = y_of(v);
+                    out.push(command::line{{draw_rect.left, y},
+                                           {draw_rect.right, y},
+                                           static_cast<float>(0.75 * x),
+                                           line_color,
+                                           true});
+                }
+            }
+            // 具体图形。
+            if (in.history.size() >= 2) {
+                command::fill_polygon polygon;
+                polygon.first = out.point_count();
+                out.add_point({draw_rect.right, draw_rect.bottom});
+                out.add_point({draw_rect.left, draw_rect.bottom});
+                const size_t n = in.history.size();
+                graph.for_each_point([&](size_t i, double v) {
+                    out.add_point({static_cast<float>(draw_rect.left + graph_width * i / (n - 1)), y_of(v)});
+                });
+                out.add_point({draw_rect.right, draw_rect.bottom});
+                polygon.count = out.point_count() - polygon.first;
+                polygon.gradient_box = graph_rect;
+                polygon.stops = {{{0.f, theme::theme_color}, {0.3f, theme::light_active_color}, {1.f, theme::active_color}}};
+                out.push(polygon);
+            }
+            // 最大值指示和键数指示。
+            {
+                float y = y_of(max_value);
+                out.push(command::line{
+                    {draw_rect.left, y}, {draw_rect.right, y}, static_cast<float>(0.75 * x), theme::theme_color, true});
+
+                auto text_rect = draw_rect; // 文字矩形。
+                text_rect.left += static_cast<float>(2 * x);
+                text_rect.bottom = static_cast<float>(y - 2 * x);
+                text_rect.right -= static_cast<float>(2 * x);
+                if (in.strings) {
+                    texts.set_format(text_format::recent, in.strings->recent_format);
+                    texts.set_format(text_format::keys, in.strings->keys_format);
+                    out.add_text(text_rect, text_style::graph, text_align::leading, theme::theme_color_half_trans,
+                                 texts.get(text_format::recent, static_cast<int>(std::llround(max_value * 10))));
+                    out.add_text(text_rect, text_style::graph, text_align::trailing, theme::theme_color_half_trans,
+                                 texts.get(text_format::keys, in.button_count));
+                }
+            }
+            // 外边框。
+            out.push(command::stroke_rect{draw_rect, static_cast<float>(stroke_width), theme::theme_color});
+        }
+    };
+} // namespace overlay
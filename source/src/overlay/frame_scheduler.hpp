@@ -0,0 +1,71 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+
+#include "../metrics/registry.hpp"
+#include "display_list.hpp"
+
+namespace overlay {
+    /// <summary>
+    /// 决定是否需要重绘。保存上一次呈现的显示列表，与新生成的一帧比较，二者相同时跳过重绘。
+    /// 只允许绘图线程调用除计数器以外的成员函数。计数器可以在任意线程读取。
+    /// </summary>
+    class frame_scheduler {
+    private:
+        display_list presented_;
+        bool dirty{true}; // 为真时，下一帧必须重绘。例如设备丢失后。
+
+        metrics::sharded_counter& rendered_;
+        metrics::sharded_counter& skipped_;
+
+    public:
+        /// <param name="reg">登记重绘与跳过帧数的计数器的位置。</param>
+        explicit frame_scheduler(metrics::registry& reg = metrics::global())
+            : rendered_(reg.counter("osu_kps_frames_rendered_total", "Frames drawn to the window.")),
+              skipped_(reg.counter("osu_kps_frames_skipped_total",
+                                   "Frames not drawn because they equal the last drawn frame.")) {}
+        frame_scheduler(const frame_scheduler&) = delete;
+        frame_scheduler& operator=(const frame_scheduler&) = delete;
+
+    public:
+        /// <summary>
+        /// 判断新生成的一帧是否需要重绘。不需要时计为跳过一帧。
+        /// </summary>
+        bool should_render(const display_list& next) {
+            if (dirty || next != presented_)
+                return true;
+            skipped_.add();
+            return false;
+        }
+        /// <summary>
+        /// 将新生成的一帧作为将要呈现的一帧，并计为重绘一帧。
+        /// 与 next 交换内容，以便复用已分配的内存。
+        /// </summary>
+        const display_list& present(display_list& next) {
+            std::swap(presented_, next);
+            dirty = false;
+            rendered_.add();
+            return presented_;
+        }
+        /// <summary>
+        /// 使下一帧必须重绘。
+        /// </summary>
+        void invalidate() {
+            dirty = true;
+        }
+
+    public:
+        /// <returns>重绘的帧数。同一 registry 中的 frame_scheduler 共享计数。</returns>
+        std::uint64_t rendered_count() const {
+            return rendered_.value();
+        }
+        /// <returns>因与上一帧相同而跳过的帧数。</returns>
+        std::uint64_t skipped_count() const {
+            return skipped_.value();
+        }
+    };
+} // namespace overlay
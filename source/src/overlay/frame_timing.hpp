@@ -0,0 +1,191 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+#include "../timing_statistics.hpp"
+#include "display_list.hpp"
+
+// 为真时，OVERLAY_TIME_STAGE 记录各阶段的耗时。默认关闭，由构建选项 OSU_KPS_FRAME_TIMING 打开。
+#ifndef OSU_KPS_FRAME_TIMING
+#define OSU_KPS_FRAME_TIMING 0
+#endif
+
+namespace overlay {
+    /// <summary>
+    /// 生成并呈现一帧的各个阶段。
+    /// </summary>
+    enum class frame_stage : std::uint8_t {
+        snapshot,   // 读取按键状态。包括等待 keys_manager 的锁。
+        calculator, // 查询 KPS 计算器。包括等待计算器的锁。
+        build,      // 生成显示列表。包括格式化文字。
+        schedule,   // 与上一次呈现的一帧比较。
+        replay,     // BeginDraw 并重放显示列表。
+        end_draw,   // EndDraw。
+        frame,      // 以上全部。
+    };
+    inline constexpr size_t frame_stage_count = 7;
+
+    /// <summary>
+    /// 各阶段耗时的统计。每个阶段一个对数分桶直方图，以微秒为单位。
+    /// 直方图与 timing_statistics 相同，相对误差不超过 1/16。
+    /// 只允许绘图线程记录，可以在任意线程读取。
+    /// </summary>
+    class frame_timing {
+    public:
+        static constexpr std::array<std::wstring_view, frame_stage_count> stage_names{
+            L"snapshot", L"calculator", L"build", L"schedule", L"replay", L"end_draw", L"frame",
+        };
+
+        struct stage_summary {
+            std::uint64_t count{};
+            double mean{}; // 以微秒为单位。
+            double p50{};
+            double p99{};
+            double max{};
+        };
+
+    private:
+        struct stage_t {
+            kps::log_histogram histogram;
+            std::atomic<std::uint64_t> count{};
+            std::atomic<std::uint64_t> total{}; // 以微秒为单位。
+            std::atomic<std::uint64_t> max{};
+        };
+        std::array<stage_t, frame_stage_count> stages;
+
+    private:
+        static size_t index(frame_stage stage) {
+            return static_cast<size_t>(stage);
+        }
+
+    public:
+        void record(frame_stage stage, std::chrono::steady_clock::duration elapsed) {
+            auto us = static_cast<std::uint64_t>(
+                std::max<std::int64_t>(0, std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+            auto& s = stages[index(stage)];
+            s.histogram.record(us);
+            s.count.store(s.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            s.total.store(s.total.load(std::memory_order_relaxed) + us, std::memory_order_relaxed);
+            if (us > s.max.load(std::memory_order_relaxed))
+                s.max.store(us, std::memory_order_relaxed);
+        }
+        void clear() {
+            for (auto& s : stages) {
+                s.histogram.clear();
+                s.count.store(0, std::memory_order_relaxed);
+                s.total.store(0, std::memory_order_relaxed);
+                s.max.store(0, std::memory_order_relaxed);
+            }
+        }
+
+    public:
+        stage_summary summary(frame_stage stage) const {
+            const auto& s = stages[index(stage)];
+            stage_summary ret;
+            ret.count = s.count.load(std::memory_order_relaxed);
+            if (!ret.count)
+                return ret;
+            ret.mean = static_cast<double>(s.total.load(std::memory_order_relaxed)) / static_cast<double>(ret.count);
+            const auto counts = s.histogram.snapshot();
+            ret.p50 = kps::log_histogram::quantile(counts, 0.5);
+            ret.p99 = kps::log_histogram::quantile(counts, 0.99);
+            ret.max = static_cast<double>(s.max.load(std::memory_order_relaxed));
+            return ret;
+        }
+        /// <summary>
+        /// 以文本表格的形式输出各阶段的统计，每个阶段一行。
+        /// </summary>
+        std::wstring report() const {
+            std::wstring ret = std::format(L"{:<12}{:>10}{:>10}{:>10}{:>10}{:>10}\n", L"stage (us)", L"count", L"mean",
+                                           L"p50", L"p99", L"max");
+            for (size_t i = 0; i < frame_stage_count; i++) {
+                auto s = summary(static_cast<frame_stage>(i));
+                std::format_to(std::back_inserter(ret), L"{:<12}{:>10}{:>10.1f}{:>10.1f}{:>10.1f}{:>10.0f}\n",
+                               stage_names[i], s.count, s.mean, s.p50, s.p99, s.max);
+            }
+            return ret;
+        }
+        /// <summary>
+        /// 将 report 的结果和各阶段直方图的非空桶写入文件。
+        /// </summary>
+        bool write_to_file(const std::filesystem::path& path) const {
+            std::wofstream ofs(path);
+            if (!ofs)
+                return false;
+            ofs << report() << L"\nstage,lower_bound_us,count\n";
+            for (size_t i = 0; i < frame_stage_count; i++) {
+                const auto counts = stages[i].histogram.snapshot();
+                for (size_t b = 0; b < counts.size(); b++)
+                    if (counts[b])
+                        ofs << stage_names[i] << L',' << kps::log_histogram::lower_bound_of(b) << L',' << counts[b]
+                            << L'\n';
+            }
+            return static_cast<bool>(ofs);
+        }
+        /// <summary>
+        /// 在显示列表末尾追加调试面板：半透明背景上每个阶段一行，显示 p50 与 p99。
+        /// </summary>
+        /// <param name="box">面板所在的矩形。</param>
+        void append_panel(display_list& out, rect box) const {
+            out.push(command::fill_rounded_rect{box, 2, color(0.f, 0.f, 0.f, 0.75f)});
+            const float line_height = (box.bottom - box.top) / (frame_stage_count + 1);
+            rect line{box.left + 2, box.top, box.right - 2, box.top + line_height};
+            auto next_line = [&] {
+                line.top += line_height;
+                line.bottom += line_height;
+            };
+            out.add_text(line, text_style::graph, text_align::leading, color(1.f, 1.f, 1.f), L"stage  p50 / p99 us");
+            for (size_t i = 0; i < frame_stage_count; i++) {
+                next_line();
+                auto s = summary(static_cast<frame_stage>(i));
+                out.add_text(line, text_style::graph, text_align::leading, color(1.f, 1.f, 1.f), stage_names[i]);
+                out.add_formatted_text(line, text_style::graph, text_align::trailing, color(1.f, 1.f, 1.f),
+                                       L"{:.0f} / {:.0f}", s.p50, s.p99);
+            }
+        }
+    };
+
+    /// <summary>
+    /// 在作用域结束时记录从构造起经过的时间。
+    /// </summary>
+    class scoped_stage_timer {
+    private:
+        frame_timing& timing;
+        frame_stage stage;
+        std::chrono::steady_clock::time_point start;
+
+    public:
+        scoped_stage_timer(frame_timing& timing, frame_stage stage)
+            : timing(timing), stage(stage), start(std::chrono::steady_clock::now()) {}
+        scoped_stage_timer(const scoped_stage_timer&) = delete;
+        scoped_stage_timer& operator=(const scoped_stage_timer&) = delete;
+        ~scoped_stage_timer() {
+            timing.record(stage, std::chrono::steady_clock::now() - start);
+        }
+    };
+} // namespace overlay
+
+#define OVERLAY_TIME_STAGE_CONCAT_IMPL(a, b) a##b
+#define OVERLAY_TIME_STAGE_CONCAT(a, b) OVERLAY_TIME_STAGE_CONCAT_IMPL(a, b)
+// 记录从此处到所在作用域结束的耗时。关闭 OSU_KPS_FRAME_TIMING 时不产生任何代码。
+#if OSU_KPS_FRAME_TIMING
+#define OVERLAY_TIME_STAGE(timing, stage)                                                                              \
+    ::overlay::scoped_stage_timer OVERLAY_TIME_STAGE_CONCAT(overlay_stage_timer_, __LINE__) {                          \
+        timing, stage                                                                                                  \
+    }
+#else
+#define OVERLAY_TIME_STAGE(timing, stage) static_cast<void>(0)
+#endif
@@ -0,0 +1,96 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include "soft_backend.hpp"
+
+namespace overlay {
+    /// <summary>
+    /// 使用 FreeType 渲染字形的 glyph_source。渲染过的字形会被缓存。
+    /// </summary>
+    class freetype_font : public glyph_source {
+    private:
+        FT_Library library{};
+        FT_Face face{};
+        std::vector<unsigned char> data; // FreeType 直接引用字体数据，需要与 face 一同保留。
+        std::unordered_map<char32_t, glyph_bitmap> glyphs;
+
+    public:
+        /// <param name="font_data">字体文件的内容。</param>
+        /// <param name="pixel_size">字号，以像素为单位。</param>
+        freetype_font(std::vector<unsigned char> font_data, float pixel_size) : data(std::move(font_data)) {
+            if (FT_Init_FreeType(&library))
+                throw std::runtime_error("fail to initialize FreeType.");
+            if (FT_New_Memory_Face(library, data.data(), static_cast<FT_Long>(data.size()), 0, &face)) {
+                FT_Done_FreeType(library);
+                throw std::runtime_error("fail to load font.");
+            }
+            if (FT_Set_Char_Size(face, 0, static_cast<FT_F26Dot6>(std::lround(pixel_size * 64)), 72, 72)) {
+                FT_Done_Face(face);
+                FT_Done_FreeType(library);
+                throw std::runtime_error("fail to set font size.");
+            }
+        }
+        freetype_font(const std::filesystem::path& path, float pixel_size)
+            : freetype_font(read_file(path), pixel_size) {}
+        freetype_font(const freetype_font&) = delete;
+        freetype_font& operator=(const freetype_font&) = delete;
+        ~freetype_font() override {
+            FT_Done_Face(face);
+            FT_Done_FreeType(library);
+        }
+
+    private:
+        static std::vector<unsigned char> read_file(const std::filesystem::path& path) {
+            std::ifstream ifs(path, std::ios::binary);
+            if (!ifs)
+                throw std::runtime_error("fail to open font file.");
+            return std::vector<unsigned char>(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+        }
+
+    public:
+        const glyph_bitmap* glyph(char32_t ch) override {
+            auto it = glyphs.find(ch);
+            if (it != glyphs.end())
+                return &it->second;
+
+            if (FT_Load_Char(face, ch, FT_LOAD_RENDER | FT_LOAD_TARGET_LIGHT))
+                return nullptr;
+            const auto* slot = face->glyph;
+            const auto& bitmap = slot->bitmap;
+            glyph_bitmap g;
+            g.left = slot->bitmap_left;
+            g.top = slot->bitmap_top;
+            g.width = static_cast<int>(bitmap.width);
+            g.height = static_cast<int>(bitmap.rows);
+            g.advance = static_cast<float>(slot->advance.x) / 64;
+            g.coverage.resize(static_cast<size_t>(g.width) * static_cast<size_t>(g.height));
+            for (int y = 0; y < g.height; y++) {
+                const auto* src = bitmap.buffer + static_cast<std::ptrdiff_t>(y) * bitmap.pitch;
+                std::copy_n(src, g.width, g.coverage.begin() + static_cast<std::ptrdiff_t>(y) * g.width);
+            }
+            return &glyphs.emplace(ch, std::move(g)).first->second;
+        }
+        float ascender() const override {
+            return static_cast<float>(face->size->metrics.ascender) / 64;
+        }
+        float line_height() const override {
+            return static_cast<float>(face->size->metrics.ascender - face->size->metrics.descender) / 64;
+        }
+    };
+} // namespace overlay
@@ -0,0 +1,258 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace overlay {
+    /// <summary>
+    /// KPS 图的数据序列。一秒一个值，按像素列抽稀，并在数据平移时增量更新。
+    /// 每 bucket_seconds 秒为一桶，桶按绝对秒数对齐，因此平移后旧桶的划分不变，只需重算两端的桶。
+    /// 每桶只保留最小值和最大值两个点，抽稀后折线的上下包络与原折线相同。
+    /// 每桶只有一秒时，输出的点与原数据一一对应。
+    /// </summary>
+    class graph_series {
+    public:
+        struct sample {
+            long long second{}; // 自时钟纪元起的秒数。
+            double value{};
+        };
+
+    private:
+        /// <summary>
+        /// 在队尾增删、在队首删除的队列。用 std::vector 实现，稳定后不再分配内存。
+        /// </summary>
+        template <typename T>
+        class window_queue {
+        private:
+            std::vector<T> items;
+            size_t head{};
+
+        public:
+            bool empty() const {
+                return head == items.size();
+            }
+            T& front() {
+                return items[head];
+            }
+            const T& front() const {
+                return items[head];
+            }
+            T& back() {
+                return items.back();
+            }
+            void push_back(const T& v) {
+                items.push_back(v);
+            }
+            void pop_back() {
+                items.pop_back();
+            }
+            void pop_front() {
+                // 队首空出一半以上时整体前移，均摊 O(1)。
+                if (++head * 2 >= items.size()) {
+                    items.erase(items.begin(), items.begin() + static_cast<std::ptrdiff_t>(head));
+                    head = 0;
+                }
+            }
+            void clear() {
+                items.clear();
+                head = 0;
+            }
+            size_t size() const {
+                return items.size() - head;
+            }
+            auto begin() const {
+                return items.begin() + static_cast<std::ptrdiff_t>(head);
+            }
+            auto end() const {
+                return items.end();
+            }
+        };
+
+        struct bucket {
+            long long id{};
+            sample min;
+            sample max;
+        };
+
+        std::vector<double> ring; // ring[(head + i) % ring.size()] 为第 first + i 秒的值。
+        size_t head{};
+        long long first{};
+        std::uint64_t generation{};
+        long long bucket_seconds{1};
+
+        window_queue<sample> max_queue; // 单调队列，值严格递减，队首为最大值。
+        window_queue<bucket> buckets;   // 按秒数升序。
+
+        std::uint64_t full_count_{};
+        std::uint64_t incremental_count_{};
+
+    private:
+        static long long floor_div(long long a, long long b) {
+            return a / b - (a % b != 0 && (a < 0) != (b < 0));
+        }
+        size_t size() const {
+            return ring.size();
+        }
+        long long last() const {
+            return first + static_cast<long long>(size()) - 1;
+        }
+        double& at(long long second) {
+            size_t i = head + static_cast<size_t>(second - first);
+            return ring[i < size() ? i : i - size()];
+        }
+        long long bucket_of(long long second) const {
+            return floor_div(second, bucket_seconds);
+        }
+
+        void push_max(sample s) {
+            while (!max_queue.empty() && max_queue.back().value <= s.value)
+                max_queue.pop_back();
+            max_queue.push_back(s);
+        }
+        void push_bucket(sample s) {
+            const long long id = bucket_of(s.second);
+            if (buckets.empty() || buckets.back().id != id) {
+                buckets.push_back({id, s, s});
+                return;
+            }
+            auto& b = buckets.back();
+            if (s.value < b.min.value)
+                b.min = s;
+            if (s.value > b.max.value)
+                b.max = s;
+        }
+        /// <summary>
+        /// 从 from 秒到最后一秒依次加入单调队列和桶。
+        /// </summary>
+        void push_range(long long from) {
+            for (long long s = from, id = bucket_of(from); s <= last(); id++) {
+                const long long end = std::min(last() + 1, (id + 1) * bucket_seconds);
+                if (buckets.empty() || buckets.back().id != id)
+                    buckets.push_back({id, {s, at(s)}, {s, at(s)}});
+                auto& b = buckets.back();
+                for (; s < end; s++) {
+                    const double v = at(s);
+                    push_max({s, v});
+                    if (v < b.min.value)
+                        b.min = {s, v};
+                    if (v > b.max.value)
+                        b.max = {s, v};
+                }
+            }
+        }
+
+        void rebuild(std::span<const double> values, long long first_second, std::uint64_t new_generation,
+                     long long new_bucket_seconds) {
+            ring.assign(values.begin(), values.end());
+            head = 0;
+            first = first_second;
+            generation = new_generation;
+            bucket_seconds = new_bucket_seconds;
+            max_queue.clear();
+            buckets.clear();
+            push_range(first);
+            full_count_++;
+        }
+        /// <summary>
+        /// 数据向后平移 shift 秒。原来的最后一秒可能增大，其余原有的值不变。
+        /// </summary>
+        void shift(std::span<const double> values, long long shift) {
+            const long long old_last = last();
+            head = (head + static_cast<size_t>(shift)) % size();
+            first += shift;
+            for (long long s = old_last; s <= last(); s++)
+                at(s) = values[static_cast<size_t>(s - first)];
+
+            // 原来的最后一秒只增不减，它一定是队尾，按新值重新入队即可。
+            while (!max_queue.empty() && max_queue.front().second < first)
+                max_queue.pop_front();
+            for (long long s = old_last; s <= last(); s++)
+                push_max({s, at(s)});
+
+            // 包含原来最后一秒的桶整个重算，过期的桶丢弃，部分过期的首个桶重算。
+            const long long changed = bucket_of(old_last);
+            while (!buckets.empty() && buckets.back().id >= changed)
+                buckets.pop_back();
+            while (!buckets.empty() && (buckets.front().id + 1) * bucket_seconds <= first)
+                buckets.pop_front();
+            if (!buckets.empty() && buckets.front().id * bucket_seconds < first) {
+                auto& b = buckets.front();
+                b.min = b.max = {first, at(first)};
+                for (long long s = first + 1; s < (b.id + 1) * bucket_seconds; s++) {
+                    const double v = at(s);
+                    if (v < b.min.value)
+                        b.min = {s, v};
+                    if (v > b.max.value)
+                        b.max = {s, v};
+                }
+            }
+            for (long long s = std::max(first, changed * bucket_seconds); s <= last(); s++)
+                push_bucket({s, at(s)});
+            incremental_count_++;
+        }
+
+    public:
+        /// <summary>
+        /// 更新数据。
+        /// </summary>
+        /// <param name="values">一秒一个值，按时间升序。</param>
+        /// <param name="first_second">values[0] 对应的秒数。</param>
+        /// <param name="new_generation">数据的代数。代数不同时完整重算。为 0 时总是完整重算。</param>
+        /// <param name="columns">绘图区域的像素列数。每列大约对应一桶。</param>
+        void update(std::span<const double> values, long long first_second, std::uint64_t new_generation,
+                    size_t columns) {
+            const long long new_bucket_seconds =
+                std::max<long long>(1, static_cast<long long>(values.size() / std::max<size_t>(1, columns)));
+            const long long n = static_cast<long long>(values.size());
+            const long long k = first_second - first;
+            const bool incremental = new_generation && new_generation == generation && values.size() == size() &&
+                                     n && new_bucket_seconds == bucket_seconds && 0 <= k && k < n &&
+                                     values[static_cast<size_t>(n - 1 - k)] >= at(last());
+            if (incremental)
+                shift(values, k);
+            else
+                rebuild(values, first_second, new_generation, new_bucket_seconds);
+        }
+
+        /// <returns>数据中的最大值。没有数据时为 0。</returns>
+        double max() const {
+            return max_queue.empty() ? 0 : max_queue.front().value;
+        }
+        /// <summary>
+        /// 按时间升序枚举抽稀后的点。
+        /// </summary>
+        /// <param name="f">参数为 (下标, 值)。下标为该点在原数据中的下标。</param>
+        template <typename func_t>
+        void for_each_point(func_t&& f) const {
+            for (const auto& b : buckets) {
+                const auto& l = b.min.second <= b.max.second ? b.min : b.max;
+                const auto& r = b.min.second <= b.max.second ? b.max : b.min;
+                f(static_cast<size_t>(l.second - first), l.value);
+                if (r.second != l.second)
+                    f(static_cast<size_t>(r.second - first), r.value);
+            }
+        }
+
+    public:
+        size_t bucket_count() const {
+            return buckets.size();
+        }
+        long long seconds_per_bucket() const {
+            return bucket_seconds;
+        }
+        /// <returns>完整重算的次数。</returns>
+        std::uint64_t full_count() const {
+            return full_count_;
+        }
+        /// <returns>增量更新的次数。</returns>
+        std::uint64_t incremental_count() const {
+            return incremental_count_;
+        }
+    };
+} // namespace overlay
@@ -0,0 +1,309 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "color.hpp"
+#include "display_list.hpp"
+
+namespace overlay {
+    /// <summary>
+    /// 有界的纯色画刷缓存。以 8 位精度的颜色为键，满时淘汰最久未使用的画刷。
+    /// </summary>
+    /// <typeparam name="brush_t">后端的画刷类型。</typeparam>
+    /// <typeparam name="capacity">最多缓存的画刷个数。</typeparam>
+    template <typename brush_t, size_t capacity>
+    class brush_palette {
+    private:
+        std::array<std::uint32_t, capacity> keys{};
+        std::array<brush_t, capacity> brushes{};
+        std::array<std::uint64_t, capacity> last_used{};
+        size_t size_{};
+        std::uint64_t clock{};
+
+        std::uint64_t created_{};
+        std::uint64_t evicted_{};
+
+    public:
+        /// <summary>
+        /// 获取颜色对应的画刷。未缓存时调用 create 创建。
+        /// </summary>
+        /// <param name="create">以 color 为参数、返回 brush_t 的函数。</param>
+        template <typename create_t>
+        const brush_t& get(const color& c, create_t&& create) {
+            const auto key = c.to_rgba8();
+            ++clock;
+            for (size_t i = 0; i < size_; i++) {
+                if (keys[i] == key) {
+                    last_used[i] = clock;
+                    return brushes[i];
+                }
+            }
+            size_t slot = size_;
+            if (size_ < capacity)
+                size_++;
+            else {
+                slot = static_cast<size_t>(std::min_element(last_used.begin(), last_used.end()) - last_used.begin());
+                evicted_++;
+            }
+            keys[slot] = key;
+            brushes[slot] = create(c);
+            last_used[slot] = clock;
+            created_++;
+            return brushes[slot];
+        }
+        void clear() {
+            for (size_t i = 0; i < size_; i++)
+                brushes[i] = brush_t();
+            size_ = 0;
+        }
+
+    public:
+        size_t size() const {
+            return size_;
+        }
+        std::uint64_t created_count() const {
+            return created_;
+        }
+        std::uint64_t evicted_count() const {
+            return evicted_;
+        }
+    };
+
+    /// <summary>
+    /// 有界的文字排版缓存。以文字、样式、对齐方式和文字框大小为键，满时淘汰最久未使用的排版。
+    /// 排版与文字框的位置无关，只移动位置的文字可以复用排版。
+    /// </summary>
+    /// <typeparam name="layout_t">后端的排版类型。</typeparam>
+    /// <typeparam name="capacity">最多缓存的排版个数。</typeparam>
+    template <typename layout_t, size_t capacity>
+    class text_layout_cache {
+    private:
+        struct key_t {
+            std::wstring text;
+            text_style style{};
+            text_align align{};
+            float width{};
+            float height{};
+        };
+        std::array<key_t, capacity> keys{};
+        std::array<layout_t, capacity> layouts{};
+        std::array<std::uint64_t, capacity> last_used{};
+        size_t size_{};
+        std::uint64_t clock{};
+
+        std::uint64_t created_{};
+
+    public:
+        /// <summary>
+        /// 获取文字对应的排版。未缓存时调用 create 创建。
+        /// </summary>
+        /// <param name="create">以 (文字, 样式, 对齐方式, 文字框) 为参数、返回 layout_t 的函数。</param>
+        template <typename create_t>
+        const layout_t& get(std::wstring_view text, text_style style, text_align align, const rect& box,
+                            create_t&& create) {
+            const float width = box.right - box.left;
+            const float height = box.bottom - box.top;
+            ++clock;
+            for (size_t i = 0; i < size_; i++) {
+                const auto& k = keys[i];
+                if (k.style == style && k.align == align && k.width == width && k.height == height &&
+                    k.text == text) {
+                    last_used[i] = clock;
+                    return layouts[i];
+                }
+            }
+            size_t slot = size_;
+            if (size_ < capacity)
+                size_++;
+            else
+                slot = static_cast<size_t>(std::min_element(last_used.begin(), last_used.end()) - last_used.begin());
+            auto& k = keys[slot];
+            k.text.assign(text); // 复用被淘汰的键的内存。
+            k.style = style;
+            k.align = align;
+            k.width = width;
+            k.height = height;
+            layouts[slot] = create(text, style, align, box);
+            last_used[slot] = clock;
+            created_++;
+            return layouts[slot];
+        }
+        void clear() {
+            for (size_t i = 0; i < size_; i++)
+                layouts[i] = layout_t();
+            size_ = 0;
+        }
+
+    public:
+        size_t size() const {
+            return size_;
+        }
+        std::uint64_t created_count() const {
+            return created_;
+        }
+    };
+
+    /// <summary>
+    /// 后端是否支持预先排版的文字。支持时，需要提供类型 layout_t、
+    /// create_text_layout(文字, 样式, 对齐方式, 文字框) 和 draw_text_layout(排版, 文字框, 画刷)。
+    /// </summary>
+    template <typename device_t>
+    concept supports_text_layout =
+        requires(device_t& device, std::wstring_view str, text_style style, text_align align, const rect& box,
+                 const typename device_t::layout_t& layout, const typename device_t::brush_t& brush) {
+            { device.create_text_layout(str, style, align, box) } -> std::convertible_to<typename device_t::layout_t>;
+            device.draw_text_layout(layout, box, brush);
+        };
+
+    /// <summary>
+    /// 不支持预先排版的后端使用的占位类型。
+    /// </summary>
+    struct no_text_layout {};
+    template <typename device_t>
+    struct text_layout_of {
+        using type = no_text_layout;
+    };
+    template <supports_text_layout device_t>
+    struct text_layout_of<device_t> {
+        using type = typename device_t::layout_t;
+    };
+
+    /// <summary>
+    /// 重放显示列表，并缓存重放所需的后端资源，使稳定后的帧不再创建资源。
+    /// 具体的绘制由 device_t 完成。device_t 需要提供：
+    /// <list type="bullet">
+    /// <item>类型 brush_t、gradient_t、geometry_t，可默认构造。</item>
+    /// <item>create_solid_brush(color)、create_gradient(stops)、create_geometry(points)。</item>
+    /// <item>clear、fill_rounded_rect、stroke_rounded_rect、stroke_rect、line、text、fill_geometry。</item>
+    /// </list>
+    /// 后端满足 supports_text_layout 时，文字改为使用缓存的排版绘制。
+    /// </summary>
+    template <typename device_t, size_t palette_capacity = 64, size_t layout_capacity = 64>
+    class renderer {
+    public:
+        device_t device;
+
+    private:
+        using brush_t = typename device_t::brush_t;
+        using gradient_t = typename device_t::gradient_t;
+        using geometry_t = typename device_t::geometry_t;
+
+        brush_palette<brush_t, palette_capacity> palette;
+
+        gradient_t gradient{};
+        std::optional<std::array<gradient_stop, 3>> gradient_stops; // gradient 对应的渐变。
+
+        geometry_t geometry{};
+        bool has_geometry{};
+        std::vector<point> geometry_points; // geometry 对应的顶点。
+
+        text_layout_cache<typename text_layout_of<device_t>::type, layout_capacity> layouts;
+
+    private:
+        const brush_t& brush(const color& c) {
+            return palette.get(c, [this](const color& c) { return device.create_solid_brush(c); });
+        }
+        const gradient_t& gradient_of(const std::array<gradient_stop, 3>& stops) {
+            if (gradient_stops != stops) {
+                gradient = device.create_gradient(stops);
+                gradient_stops = stops;
+            }
+            return gradient;
+        }
+        const geometry_t& geometry_of(std::span<const point> points) {
+            if (!has_geometry || !std::equal(points.begin(), points.end(), geometry_points.begin(),
+                                             geometry_points.end())) {
+                geometry = device.create_geometry(points);
+                geometry_points.assign(points.begin(), points.end());
+                has_geometry = true;
+            }
+            return geometry;
+        }
+
+    public:
+        /// <summary>
+        /// 释放所有缓存的资源。后端设备重建后必须调用。
+        /// </summary>
+        void reset() {
+            palette.clear();
+            gradient = gradient_t();
+            gradient_stops.reset();
+            geometry = geometry_t();
+            has_geometry = false;
+            layouts.clear();
+        }
+        /// <summary>
+        /// 释放缓存的排版。后端的文字格式改变后（例如缩放改变）必须调用。
+        /// </summary>
+        void reset_text_layouts() {
+            layouts.clear();
+        }
+        void replay(const display_list& list) {
+            for (const auto& cmd : list.commands()) {
+                std::visit(
+                    [&](const auto& c) {
+                        using T = std::decay_t<decltype(c)>;
+                        if constexpr (std::is_same_v<T, command::clear>)
+                            device.clear(c.c);
+                        else if constexpr (std::is_same_v<T, command::fill_rounded_rect>)
+                            device.fill_rounded_rect(c.r, c.radius, brush(c.c));
+                        else if constexpr (std::is_same_v<T, command::stroke_rounded_rect>)
+                            device.stroke_rounded_rect(c.r, c.radius, c.width, brush(c.c));
+                        else if constexpr (std::is_same_v<T, command::stroke_rect>)
+                            device.stroke_rect(c.r, c.width, brush(c.c));
+                        else if constexpr (std::is_same_v<T, command::line>)
+                            device.line(c.from, c.to, c.width, brush(c.c), c.dashed);
+                        else if constexpr (std::is_same_v<T, command::text>) {
+                            if constexpr (supports_text_layout<device_t>) {
+                                const auto& layout = layouts.get(
+                                    list.text(c), c.style, c.align, c.box,
+                                    [this](std::wstring_view str, text_style style, text_align align, const rect& box) {
+                                        return device.create_text_layout(str, style, align, box);
+                                    });
+                                device.draw_text_layout(layout, c.box, brush(c.c));
+                            } else
+                                device.text(c.box, list.text(c), c.style, c.align, brush(c.c));
+                        }
+                        else if constexpr (std::is_same_v<T, command::fill_polygon>) {
+                            auto points = list.points(c);
+                            if (points.empty())
+                                return;
+                            device.fill_geometry(geometry_of(points), gradient_of(c.stops), c.gradient_box);
+                        }
+                    },
+                    cmd);
+            }
+        }
+
+    public:
+        /// <returns>创建过的纯色画刷个数。</returns>
+        std::uint64_t brushes_created() const {
+            return palette.created_count();
+        }
+        /// <returns>因缓存已满而淘汰的纯色画刷个数。</returns>
+        std::uint64_t brushes_evicted() const {
+            return palette.evicted_count();
+        }
+        size_t palette_size() const {
+            return palette.size();
+        }
+        /// <returns>创建过的排版个数。后端不支持预先排版时为 0。</returns>
+        std::uint64_t text_layouts_created() const {
+            return layouts.created_count();
+        }
+    };
+} // namespace overlay
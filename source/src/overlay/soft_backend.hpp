@@ -0,0 +1,723 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "color.hpp"
+#include "display_list.hpp"
+#include "renderer.hpp"
+
+namespace overlay {
+    /// <summary>
+    /// 预乘 alpha 的 RGBA 图像。每个像素为一个 32 位整数，从低位到高位依次为 R、G、B、A，
+    /// 即在小端序下内存中的字节顺序为 RGBA。
+    /// </summary>
+    class rgba_image {
+    private:
+        size_t width_{};
+        size_t height_{};
+        std::vector<std::uint32_t> pixels_;
+
+    public:
+        rgba_image() = default;
+        rgba_image(size_t width, size_t height) {
+            resize(width, height);
+        }
+        /// <summary>
+        /// 改变大小。大小不变时保留原有内容。
+        /// </summary>
+        void resize(size_t width, size_t height) {
+            width_ = width;
+            height_ = height;
+            pixels_.resize(width * height);
+        }
+
+    public:
+        static constexpr std::uint32_t pack(unsigned r, unsigned g, unsigned b, unsigned a) {
+            return r | g << 8 | b << 16 | a << 24;
+        }
+        static constexpr std::array<unsigned, 4> unpack(std::uint32_t pixel) {
+            return {pixel & 0xff, pixel >> 8 & 0xff, pixel >> 16 & 0xff, pixel >> 24};
+        }
+
+    public:
+        size_t width() const {
+            return width_;
+        }
+        size_t height() const {
+            return height_;
+        }
+        std::span<std::uint32_t> pixels() {
+            return pixels_;
+        }
+        std::span<const std::uint32_t> pixels() const {
+            return pixels_;
+        }
+        std::uint32_t* row(size_t y) {
+            return pixels_.data() + y * width_;
+        }
+        std::uint32_t at(size_t x, size_t y) const {
+            return pixels_[y * width_ + x];
+        }
+
+    public:
+        /// <summary>
+        /// 以二进制 PPM (P6) 格式写入文件。只写入 RGB 分量，即叠加在黑色背景上的结果。
+        /// </summary>
+        bool write_ppm(const std::filesystem::path& path) const {
+            std::ofstream ofs(path, std::ios::binary);
+            if (!ofs)
+                return false;
+            ofs << "P6\n" << width_ << ' ' << height_ << "\n255\n";
+            std::vector<char> rgb(pixels_.size() * 3);
+            for (size_t i = 0; i < pixels_.size(); i++) {
+                auto [r, g, b, a] = unpack(pixels_[i]);
+                rgb[i * 3] = static_cast<char>(r);
+                rgb[i * 3 + 1] = static_cast<char>(g);
+                rgb[i * 3 + 2] = static_cast<char>(b);
+            }
+            ofs.write(rgb.data(), static_cast<std::streamsize>(rgb.size()));
+            return static_cast<bool>(ofs);
+        }
+        /// <summary>
+        /// 读取 write_ppm 写入的文件。各像素的 alpha 为 255。
+        /// </summary>
+        static std::optional<rgba_image> read_ppm(const std::filesystem::path& path) {
+            std::ifstream ifs(path, std::ios::binary);
+            std::string magic;
+            size_t width{}, height{};
+            unsigned max_value{};
+            if (!(ifs >> magic >> width >> height >> max_value) || magic != "P6" || max_value != 255)
+                return std::nullopt;
+            ifs.get(); // 头部之后的一个空白字符。
+            std::vector<char> rgb(width * height * 3);
+            if (!ifs.read(rgb.data(), static_cast<std::streamsize>(rgb.size())))
+                return std::nullopt;
+            rgba_image ret(width, height);
+            auto byte = [&](size_t i) { return static_cast<unsigned char>(rgb[i]); };
+            for (size_t i = 0; i < ret.pixels_.size(); i++)
+                ret.pixels_[i] = pack(byte(i * 3), byte(i * 3 + 1), byte(i * 3 + 2), 255);
+            return ret;
+        }
+    };
+
+    /// <summary>
+    /// 渲染好的字形。覆盖率为 8 位灰度，每行 width 个字节。
+    /// </summary>
+    struct glyph_bitmap {
+        int left{}; // 位图左边相对于笔位置的偏移。
+        int top{};  // 位图上边相对于基线的偏移，向上为正。
+        int width{};
+        int height{};
+        float advance{}; // 笔位置前进的像素数。
+        std::vector<std::uint8_t> coverage;
+    };
+
+    /// <summary>
+    /// 软件渲染时文字的字形来源。每个对象对应一种字体的一个字号。
+    /// </summary>
+    class glyph_source {
+    public:
+        virtual ~glyph_source() = default;
+
+    public:
+        /// <returns>字形。字体中没有该字符时返回字体的缺省字形或 nullptr。</returns>
+        virtual const glyph_bitmap* glyph(char32_t ch) = 0;
+        /// <returns>基线到行顶的像素数。</returns>
+        virtual float ascender() const = 0;
+        /// <returns>一行的像素数。</returns>
+        virtual float line_height() const = 0;
+    };
+
+    /// <summary>
+    /// 各文字样式在缩放为 1 时的字号，以像素为单位。与窗口创建的文字格式相同。
+    /// </summary>
+    inline constexpr std::array<float, text_style_count> text_style_sizes{24, 16, 24, 18, 20, 15, 12, 11};
+
+    /// <summary>
+    /// 将显示列表绘制到内存中的 RGBA 图像的设备。不依赖 GPU，可以在任意平台上使用。
+    /// 所有图形都按像素中心的覆盖率抗锯齿。文字由 fonts 提供字形，未设置字体的样式不绘制文字。
+    /// 图像和字体由使用者创建并持有，每帧重放前设置。
+    /// </summary>
+    struct soft_device {
+        /// <summary>
+        /// 预乘 alpha 的颜色，与 rgba_image 的像素格式相同。
+        /// </summary>
+        struct brush_t {
+            std::uint32_t pixel{};
+        };
+        using gradient_t = std::array<gradient_stop, 3>;
+        using geometry_t = std::vector<point>;
+
+        rgba_image* target{};
+        std::array<glyph_source*, text_style_count> fonts{}; // 按 text_style 索引。
+
+    private:
+        // 填充多边形时的覆盖率累加缓冲区。每次填充后都清零，只在变大时重新分配。
+        std::vector<float> coverage_;
+        // coverage_ 中每行被边写入过的块，每块 coverage_block 个单元，每行 touched_words_ 个字。
+        // 没有被写入的块中前缀和不变，可以整段跳过或填满。
+        static constexpr int coverage_block = 8;
+        std::vector<std::uint64_t> touched_;
+        size_t touched_words_{};
+        std::vector<float> along_; // 水平或竖直的线沿线方向各像素的覆盖率。
+
+    private:
+        static float saturate(float v) {
+            return v < 0 ? 0 : v > 1 ? 1 : v;
+        }
+        static brush_t premultiply(const color& c) {
+            const float a = saturate(c.a);
+            auto byte = [](float v) { return static_cast<unsigned>(v * 255 + 0.5f); };
+            return {rgba_image::pack(byte(saturate(c.r) * a), byte(saturate(c.g) * a), byte(saturate(c.b) * a),
+                                     byte(a))};
+        }
+        /// <summary>
+        /// 将像素的各分量乘以 scale / 256。两个分量一组同时计算。
+        /// </summary>
+        static std::uint32_t scale_pixel(std::uint32_t pixel, std::uint32_t scale) {
+            const std::uint32_t rb = (pixel & 0x00ff00ff) * scale >> 8 & 0x00ff00ff;
+            const std::uint32_t ga = (pixel >> 8 & 0x00ff00ff) * scale & 0xff00ff00;
+            return rb | ga;
+        }
+        /// <summary>
+        /// 以覆盖率 coverage 将 src 叠加到 dst 上。coverage 以 1/256 为单位，在 [0, 256] 中。
+        /// </summary>
+        static void blend(std::uint32_t& dst, const brush_t& src, std::uint32_t coverage) {
+            const std::uint32_t s = coverage >= 256 ? src.pixel : scale_pixel(src.pixel, coverage);
+            const std::uint32_t alpha = s >> 24;
+            dst = alpha == 255 ? s : s + scale_pixel(dst, 256 - alpha - (alpha >> 7));
+        }
+        static void blend(std::uint32_t& dst, const brush_t& src, float coverage) {
+            blend(dst, src, static_cast<std::uint32_t>(coverage * 256 + 0.5f));
+        }
+
+        /// <summary>
+        /// 图像中与 [left, right) × [top, bottom) 相交的整像素范围。
+        /// </summary>
+        struct pixel_span {
+            size_t x0{}, y0{}, x1{}, y1{};
+        };
+        pixel_span clip(float left, float top, float right, float bottom) const {
+            auto to_pixel = [](float v, size_t limit) {
+                return static_cast<size_t>(std::clamp(v, 0.f, static_cast<float>(limit)));
+            };
+            pixel_span ret;
+            ret.x0 = to_pixel(std::floor(left), target->width());
+            ret.x1 = to_pixel(std::ceil(right), target->width());
+            ret.y0 = to_pixel(std::floor(top), target->height());
+            ret.y1 = to_pixel(std::ceil(bottom), target->height());
+            return ret;
+        }
+        /// <summary>
+        /// 图像中中心不在 box 之外的像素范围。中心在 box 之外的像素覆盖率为 0 时用于跳过它们。
+        /// </summary>
+        pixel_span clip_centers(const rect& box) const {
+            return clip(std::floor(box.left + 0.5f), std::floor(box.top + 0.5f), std::ceil(box.right - 0.5f),
+                        std::ceil(box.bottom - 0.5f));
+        }
+        /// <summary>
+        /// 点到圆角矩形边界的有向距离，在内部为负。radius 为 0 时为直角矩形。
+        /// </summary>
+        static float rect_distance(const rect& r, float radius, float x, float y) {
+            const float qx = std::abs(x - (r.left + r.right) / 2) - ((r.right - r.left) / 2 - radius);
+            const float qy = std::abs(y - (r.top + r.bottom) / 2) - ((r.bottom - r.top) / 2 - radius);
+            if (radius <= 0 || qx <= 0 || qy <= 0)
+                return std::max(qx, qy) - radius;
+            return std::sqrt(qx * qx + qy * qy) - radius;
+        }
+        /// <summary>
+        /// 对中心在 box 内、hole 外的每个像素以 coverage_of(像素中心 x, y) 的覆盖率叠加 brush。
+        /// 中心在 box 外或在 hole 内的像素覆盖率必须为 0，box 应尽量贴近图形，hole 用于跳过描边的内部。
+        /// </summary>
+        template <typename coverage_t>
+        void shade(const rect& box, const brush_t& brush, coverage_t&& coverage_of, rect hole = {}) const {
+            auto span = clip_centers(box);
+            auto skip =
+                clip(std::ceil(hole.left), std::ceil(hole.top), std::floor(hole.right), std::floor(hole.bottom));
+            if (skip.x0 >= skip.x1)
+                skip.y0 = skip.y1 = 0;
+            auto shade_span = [&](std::uint32_t* row, float cy, size_t x0, size_t x1) {
+                // 像素中心逐个递增，避免 size_t 到浮点数较慢的转换。
+                float cx = static_cast<float>(static_cast<int>(x0)) + 0.5f;
+                for (size_t x = x0; x < x1; x++, cx++) {
+                    const float coverage = coverage_of(cx, cy);
+                    if (coverage > 0)
+                        blend(row[x], brush, coverage);
+                }
+            };
+            for (size_t y = span.y0; y < span.y1; y++) {
+                auto* row = target->row(y);
+                const float cy = static_cast<float>(static_cast<int>(y)) + 0.5f;
+                if (y >= skip.y0 && y < skip.y1) {
+                    shade_span(row, cy, span.x0, std::max(span.x0, skip.x0));
+                    shade_span(row, cy, std::min(span.x1, skip.x1), span.x1);
+                } else
+                    shade_span(row, cy, span.x0, span.x1);
+            }
+        }
+        static rect inflate(const rect& r, float d) {
+            return {r.left - d, r.top - d, r.right + d, r.bottom + d};
+        }
+
+        /// <summary>
+        /// 记录第 y 行的单元 [x0, x1] 被写入。
+        /// </summary>
+        void touch(int y, int x0, int x1) {
+            auto* mask = touched_.data() + static_cast<size_t>(y) * touched_words_;
+            for (int b = x0 / coverage_block; b <= x1 / coverage_block; b++)
+                mask[b / 64] |= std::uint64_t{1} << (b % 64);
+        }
+        /// <summary>
+        /// 将一条边的有向面积累加到 coverage_ 中。坐标已转换到缓冲区中，x 在 [0, width] 中。
+        /// 每一行中，边扫过的面积分配到所经过的像素和其右侧的一个像素上；之后逐行前缀求和即为覆盖率。
+        /// 坐标非负，下标均用 int 计算，避免浮点数与 size_t 之间较慢的转换。
+        /// </summary>
+        void accumulate_edge(point p0, point p1, int width, int height) {
+            if (std::abs(p1.x - p0.x) >= std::abs(p1.y - p0.y)) {
+                accumulate_rows(p0, p1, width, height);
+                return;
+            }
+            // 较陡的边在整数 x 处切开，每段只经过一列像素。图中的尖峰都是这样的边。
+            point from = p0;
+            if (p0.x < p1.x) {
+                for (int c = static_cast<int>(p0.x) + 1; static_cast<float>(c) < p1.x; c++) {
+                    const auto x = static_cast<float>(c);
+                    const point to{x, p0.y + (p1.y - p0.y) * (x - p0.x) / (p1.x - p0.x)};
+                    accumulate_column(from, to, width, height);
+                    from = to;
+                }
+            } else {
+                for (int c = static_cast<int>(std::ceil(p0.x)) - 1; static_cast<float>(c) > p1.x; c--) {
+                    const auto x = static_cast<float>(c);
+                    const point to{x, p0.y + (p1.y - p0.y) * (x - p0.x) / (p1.x - p0.x)};
+                    accumulate_column(from, to, width, height);
+                    from = to;
+                }
+            }
+            accumulate_column(from, p1, width, height);
+        }
+        /// <summary>
+        /// accumulate_edge 的特殊情况：边只经过一列像素。
+        /// </summary>
+        void accumulate_column(point p0, point p1, int width, int height) {
+            if (p0.y == p1.y)
+                return;
+            float dir = 1;
+            if (p0.y > p1.y) {
+                std::swap(p0, p1);
+                dir = -1;
+            }
+            const float dxdy = (p1.x - p0.x) / (p1.y - p0.y);
+            float x = p0.x;
+            float y0 = p0.y;
+            if (y0 < 0) {
+                x -= y0 * dxdy;
+                y0 = 0;
+            }
+            const float y1 = std::min(p1.y, static_cast<float>(height));
+            if (y0 >= y1)
+                return;
+            const int column = std::min(static_cast<int>(std::min(p0.x, p1.x)), width);
+            const float column_left = static_cast<float>(column);
+            const int stride = width + 2;
+            float* cells = coverage_.data() + column;
+            auto step = [&](int y, float dy) {
+                touch(y, column, column + 1);
+                const float x_next = x + dxdy * dy;
+                const float d = dy * dir;
+                const float xm = (x + x_next) / 2 - column_left;
+                cells[y * stride] += d - d * xm;
+                cells[y * stride + 1] += d * xm;
+                x = x_next;
+            };
+            const auto full_begin = static_cast<int>(std::ceil(y0));
+            const auto full_end = static_cast<int>(y1);
+            if (full_begin > full_end) {
+                step(full_end, y1 - y0);
+                return;
+            }
+            if (static_cast<float>(full_begin) > y0)
+                step(full_begin - 1, static_cast<float>(full_begin) - y0);
+            for (int y = full_begin; y < full_end; y++)
+                step(y, 1);
+            if (static_cast<float>(full_end) < y1)
+                step(full_end, y1 - static_cast<float>(full_end));
+        }
+        /// <summary>
+        /// accumulate_edge 的一般情况：逐行计算。
+        /// </summary>
+        void accumulate_rows(point p0, point p1, int width, int height) {
+            if (p0.y == p1.y)
+                return;
+            float dir = 1;
+            if (p0.y > p1.y) {
+                std::swap(p0, p1);
+                dir = -1;
+            }
+            const float dxdy = (p1.x - p0.x) / (p1.y - p0.y);
+            const float x_limit = static_cast<float>(width);
+            float x = p0.x;
+            float y0 = p0.y;
+            if (y0 < 0) {
+                x -= y0 * dxdy;
+                y0 = 0;
+            }
+            const float y1 = std::min(p1.y, static_cast<float>(height));
+            const int stride = width + 2;
+            for (int y = static_cast<int>(y0); static_cast<float>(y) < y1; y++) {
+                float* line = coverage_.data() + y * stride;
+                const float fy = static_cast<float>(y);
+                const float dy = std::min(fy + 1, y1) - std::max(fy, y0);
+                const float x_next = x + dxdy * dy;
+                const float d = dy * dir;
+                const float xa = std::max(0.f, std::min(x, x_next));
+                const float xb = std::min(x_limit, std::max(x, x_next));
+                const int ia = static_cast<int>(xa);
+                int ib = static_cast<int>(xb);
+                ib += static_cast<float>(ib) < xb;
+                const float xa_floor = static_cast<float>(ia);
+                touch(y, ia, std::max(ia + 1, ib));
+                if (ib <= ia + 1) {
+                    // 在同一个像素内。
+                    const float xm = (xa + xb) / 2 - xa_floor;
+                    line[ia] += d - d * xm;
+                    line[ia + 1] += d * xm;
+                } else {
+                    const float s = 1 / (xb - xa);
+                    const float fa = xa - xa_floor;
+                    const float a0 = 0.5f * s * (1 - fa) * (1 - fa);
+                    const float fb = xb - static_cast<float>(ib) + 1;
+                    const float am = 0.5f * s * fb * fb;
+                    line[ia] += d * a0;
+                    if (ib == ia + 2)
+                        line[ia + 1] += d * (1 - a0 - am);
+                    else {
+                        const float a1 = s * (1.5f - fa);
+                        line[ia + 1] += d * (a1 - a0);
+                        for (int i = ia + 2; i < ib - 1; i++)
+                            line[i] += d * s;
+                        const float a2 = a1 + static_cast<float>(ib - ia - 3) * s;
+                        line[ib - 1] += d * (1 - a2 - am);
+                    }
+                    line[ib] += d * am;
+                }
+                x = x_next;
+            }
+        }
+
+        static char32_t next_char(std::wstring_view str, size_t& i) {
+            char32_t ch = static_cast<char32_t>(str[i++]);
+            if constexpr (sizeof(wchar_t) == 2) {
+                if (ch >= 0xD800 && ch < 0xDC00 && i < str.size() && str[i] >= 0xDC00 && str[i] < 0xE000)
+                    ch = 0x10000 + ((ch - 0xD800) << 10) + (static_cast<char32_t>(str[i++]) - 0xDC00);
+            }
+            return ch;
+        }
+
+    public:
+        brush_t create_solid_brush(const color& c) const {
+            return premultiply(c);
+        }
+        gradient_t create_gradient(const std::array<gradient_stop, 3>& stops) const {
+            return stops;
+        }
+        geometry_t create_geometry(std::span<const point> points) const {
+            return geometry_t(points.begin(), points.end());
+        }
+
+    public:
+        void clear(const color& c) const {
+            std::fill(target->pixels().begin(), target->pixels().end(), premultiply(c).pixel);
+        }
+        void fill_rounded_rect(const rect& r, float radius, const brush_t& brush) const {
+            shade(inflate(r, 0.5f), brush,
+                  [&](float x, float y) { return saturate(0.5f - rect_distance(r, radius, x, y)); });
+        }
+        void stroke_rounded_rect(const rect& r, float radius, float width, const brush_t& brush) const {
+            shade(
+                inflate(r, width / 2 + 0.5f), brush,
+                [&](float x, float y) { return saturate(width / 2 + 0.5f - std::abs(rect_distance(r, radius, x, y))); },
+                inflate(r, -(width / 2 + 0.5f + radius)));
+        }
+        void stroke_rect(const rect& r, float width, const brush_t& brush) const {
+            stroke_rounded_rect(r, 0, width, brush);
+        }
+        /// <summary>
+        /// line 的特殊情况：水平或竖直的线。覆盖率是垂直于线与沿线两个方向的覆盖率之积，
+        /// 沿线的覆盖率（含虚线）只计算一次，之后逐行或逐列叠加。box 为 line 中覆盖率可能非 0 的范围。
+        /// </summary>
+        /// <param name="direction">沿线方向，为 1 或 -1。</param>
+        void axis_aligned_line(const point& from, float length, float direction, bool vertical, float width,
+                               bool dashed, const rect& box, const brush_t& brush) {
+            const auto span = clip_centers(box);
+            const int a0 = static_cast<int>(vertical ? span.y0 : span.x0);
+            const int a1 = static_cast<int>(vertical ? span.y1 : span.x1);
+            const int c0 = static_cast<int>(vertical ? span.x0 : span.y0);
+            const int c1 = static_cast<int>(vertical ? span.x1 : span.y1);
+            if (a0 >= a1 || c0 >= c1)
+                return;
+            const float from_along = vertical ? from.y : from.x;
+            const float from_across = vertical ? from.x : from.y;
+
+            along_.resize(static_cast<size_t>(a1 - a0));
+            const float dash = 2 * width;
+            const float period = 2 * dash;
+            // 当前像素所在的虚线周期为 [k * period, (k + 1) * period)。相邻像素的周期至多相差 1，逐步调整，不做除法。
+            int k = 0;
+            float period_begin = 0, period_end = period;
+            auto move_to = [&](int next) {
+                k = next;
+                period_begin = static_cast<float>(k) * period;
+                period_end = static_cast<float>(k + 1) * period;
+            };
+            for (int a = a0; a < a1; a++) {
+                const float t = (static_cast<float>(a) + 0.5f - from_along) * direction; // 沿直线的距离。
+                float coverage = saturate(std::min(t, length - t) + 0.5f);
+                if (dashed && coverage > 0) {
+                    const float u = t < 0 ? 0 : t;
+                    while (period_end <= u)
+                        move_to(k + 1);
+                    while (k > 0 && period_begin > u)
+                        move_to(k - 1);
+                    const float m = u - period_begin;
+                    const float inside = m < dash ? std::min(m, dash - m) : -std::min(m - dash, period - m);
+                    coverage *= saturate(inside + 0.5f);
+                }
+                along_[static_cast<size_t>(a - a0)] = coverage;
+            }
+
+            for (int c = c0; c < c1; c++) {
+                const float across = saturate(width / 2 + 0.5f - std::abs(static_cast<float>(c) + 0.5f - from_across));
+                if (across <= 0)
+                    continue;
+                for (int a = a0; a < a1; a++) {
+                    auto& pixel =
+                        vertical ? target->row(static_cast<size_t>(a))[c] : target->row(static_cast<size_t>(c))[a];
+                    const float coverage = across * along_[static_cast<size_t>(a - a0)];
+                    if (coverage > 0)
+                        blend(pixel, brush, coverage);
+                }
+            }
+        }
+        /// <summary>
+        /// 平头的直线。虚线与 Direct2D 的 D2D1_DASH_STYLE_DASH 相同：线宽的 2 倍长的线段，间隔线宽的 2 倍。
+        /// </summary>
+        void line(const point& from, const point& to, float width, const brush_t& brush, bool dashed) {
+            const float dx = to.x - from.x;
+            const float dy = to.y - from.y;
+            const float length = std::sqrt(dx * dx + dy * dy);
+            if (length <= 0)
+                return;
+            const float ux = dx / length;
+            const float uy = dy / length;
+            // 沿直线方向延伸 0.5、垂直方向延伸 width / 2 + 0.5 之外的覆盖率为 0。
+            const float ex = 0.5f * std::abs(ux) + (width / 2 + 0.5f) * std::abs(uy);
+            const float ey = 0.5f * std::abs(uy) + (width / 2 + 0.5f) * std::abs(ux);
+            const rect box{std::min(from.x, to.x) - ex, std::min(from.y, to.y) - ey, std::max(from.x, to.x) + ex,
+                           std::max(from.y, to.y) + ey};
+            if (dx == 0 || dy == 0) {
+                axis_aligned_line(from, length, dx == 0 ? uy : ux, dx == 0, width, dashed, box, brush);
+                return;
+            }
+            const float dash = 2 * width;
+            shade(box, brush, [&](float x, float y) {
+                const float rx = x - from.x;
+                const float ry = y - from.y;
+                const float t = rx * ux + ry * uy; // 沿直线的距离。
+                const float n = std::abs(rx * uy - ry * ux);
+                float coverage = saturate(width / 2 + 0.5f - n) * saturate(std::min(t, length - t) + 0.5f);
+                if (dashed && coverage > 0) {
+                    const float u = t < 0 ? 0 : t;
+                    const float m = u - std::floor(u / (2 * dash)) * (2 * dash); // 比 std::fmod 快得多。
+                    const float inside = m < dash ? std::min(m, dash - m) : -std::min(m - dash, 2 * dash - m);
+                    coverage *= saturate(inside + 0.5f);
+                }
+                return coverage;
+            });
+        }
+        void text(const rect& box, std::wstring_view str, text_style style, text_align align,
+                  const brush_t& brush) const {
+            auto* font = fonts[static_cast<size_t>(style)];
+            if (!font || str.empty())
+                return;
+
+            // 与窗口的文字格式相同：按键和数字竖直居中，图中文字和图标靠下，其余靠上。
+            float top = box.top;
+            switch (style) {
+            case text_style::key_name:
+            case text_style::key_name_small:
+            case text_style::key_name_mdl2:
+            case text_style::number: top = (box.top + box.bottom - font->line_height()) / 2; break;
+            case text_style::statistics_mdl2:
+            case text_style::graph: top = box.bottom - font->line_height(); break;
+            default: break;
+            }
+            const float baseline = std::round(top + font->ascender());
+
+            float width = 0;
+            for (size_t i = 0; i < str.size();)
+                if (auto* g = font->glyph(next_char(str, i)))
+                    width += g->advance;
+            float pen = box.left;
+            if (align == text_align::center)
+                pen = (box.left + box.right - width) / 2;
+            else if (align == text_align::trailing)
+                pen = box.right - width;
+
+            for (size_t i = 0; i < str.size();) {
+                auto* g = font->glyph(next_char(str, i));
+                if (!g)
+                    continue;
+                const auto left = static_cast<long long>(std::round(pen)) + g->left;
+                const auto top_row = static_cast<long long>(baseline) - g->top;
+                for (int gy = 0; gy < g->height; gy++) {
+                    const long long y = top_row + gy;
+                    if (y < 0 || y >= static_cast<long long>(target->height()))
+                        continue;
+                    auto* row = target->row(static_cast<size_t>(y));
+                    const auto* src = g->coverage.data() + static_cast<size_t>(gy) * static_cast<size_t>(g->width);
+                    for (int gx = 0; gx < g->width; gx++) {
+                        const long long x = left + gx;
+                        if (src[gx] && x >= 0 && x < static_cast<long long>(target->width()))
+                            blend(row[x], brush, static_cast<std::uint32_t>(src[gx] + (src[gx] >> 7)));
+                    }
+                }
+                pen += g->advance;
+            }
+        }
+        /// <summary>
+        /// 以非零环绕规则填充多边形。渐变从 gradient_box 的底边到顶边，超出的部分取两端的颜色。
+        /// </summary>
+        void fill_geometry(const geometry_t& geometry, const gradient_t& gradient, const rect& gradient_box) {
+            if (geometry.size() < 3)
+                return;
+            float left = geometry[0].x, top = geometry[0].y, right = left, bottom = top;
+            for (const auto& p : geometry) {
+                left = std::min(left, p.x);
+                right = std::max(right, p.x);
+                top = std::min(top, p.y);
+                bottom = std::max(bottom, p.y);
+            }
+            auto span = clip(left, top, right, bottom);
+            if (span.x0 >= span.x1 || span.y0 >= span.y1)
+                return;
+            const size_t width = span.x1 - span.x0;
+            const size_t height = span.y1 - span.y0;
+            const size_t stride = width + 2;
+            if (coverage_.size() < stride * height)
+                coverage_.resize(stride * height);
+            touched_words_ = (stride + 64 * coverage_block - 1) / (64 * coverage_block);
+            touched_.assign(touched_words_ * height, 0);
+
+            // 转换到缓冲区中。边在左右边界处切开，超出的部分压到边界上，不影响图像内的覆盖率。
+            const float x_limit = static_cast<float>(width);
+            auto clamped = [&](point p) {
+                p.x = std::clamp(p.x, 0.f, x_limit);
+                return p;
+            };
+            for (size_t i = 0; i < geometry.size(); i++) {
+                const auto& a = geometry[i];
+                const auto& b = geometry[(i + 1) % geometry.size()];
+                const point p0{a.x - static_cast<float>(span.x0), a.y - static_cast<float>(span.y0)};
+                const point p1{b.x - static_cast<float>(span.x0), b.y - static_cast<float>(span.y0)};
+                std::array<float, 4> cuts{0.f, 1.f, 1.f, 1.f}; // 切点在边上的参数，升序。
+                size_t cut_count = 1;
+                for (float bound : {0.f, x_limit})
+                    if ((p0.x < bound) != (p1.x < bound))
+                        cuts[cut_count++] = (bound - p0.x) / (p1.x - p0.x);
+                if (cut_count == 3 && cuts[1] > cuts[2])
+                    std::swap(cuts[1], cuts[2]);
+                cuts[cut_count] = 1;
+                auto at = [&](float t) { return point{p0.x + (p1.x - p0.x) * t, p0.y + (p1.y - p0.y) * t}; };
+                for (size_t c = 0; c < cut_count; c++)
+                    accumulate_edge(clamped(at(cuts[c])), clamped(at(cuts[c + 1])), static_cast<int>(width),
+                                    static_cast<int>(height));
+            }
+
+            const float gradient_height = gradient_box.bottom - gradient_box.top;
+            for (size_t y = 0; y < height; y++) {
+                // 本行的渐变色。
+                const float cy = static_cast<float>(span.y0 + y) + 0.5f;
+                const float position = gradient_height > 0 ? saturate((gradient_box.bottom - cy) / gradient_height) : 0;
+                color c = gradient[0].c;
+                for (size_t i = 1; i < gradient.size(); i++) {
+                    if (position <= gradient[i].position) {
+                        const float range = gradient[i].position - gradient[i - 1].position;
+                        const float ratio = range > 0 ? saturate((position - gradient[i - 1].position) / range) : 1;
+                        c = color::linear_interpolation(gradient[i - 1].c, gradient[i].c, ratio);
+                        break;
+                    }
+                    c = gradient[i].c;
+                }
+                const auto brush = premultiply(c);
+
+                float* line = coverage_.data() + y * stride;
+                auto* row = target->row(span.y0 + y) + span.x0;
+                const bool opaque = brush.pixel >> 24 == 255;
+                auto coverage_of = [](float sum) {
+                    return static_cast<int>(std::min(1.f, std::abs(sum)) * 256 + 0.5f);
+                };
+                // 以前缀和为 sum 的覆盖率绘制 [x0, x1)。
+                auto fill_run = [&](size_t x0, size_t x1, float sum) {
+                    const auto coverage = coverage_of(sum);
+                    if (coverage == 256 && opaque)
+                        std::fill(row + x0, row + x1, brush.pixel);
+                    else if (coverage)
+                        for (size_t x = x0; x < x1; x++)
+                            blend(row[x], brush, static_cast<std::uint32_t>(coverage));
+                };
+                const auto* mask = touched_.data() + y * touched_words_;
+                float sum = 0;
+                size_t x = 0;
+                while (x < stride) {
+                    // 找到从 x 所在块开始的下一个被写入的块，之前的单元都为 0。
+                    size_t block = x / coverage_block;
+                    size_t word = block / 64;
+                    std::uint64_t bits = mask[word] & (~std::uint64_t{0} << (block % 64));
+                    while (!bits && ++word < touched_words_)
+                        bits = mask[word];
+                    const size_t next =
+                        bits ? (word * 64 + static_cast<size_t>(std::countr_zero(bits))) * coverage_block : stride;
+                    if (x < width)
+                        fill_run(x, std::min(next, width), sum);
+                    x = next;
+                    // 逐个单元累加并清零。
+                    const size_t end = std::min(x + coverage_block, stride);
+                    for (; x < std::min(end, width); x++) {
+                        sum += line[x];
+                        line[x] = 0;
+                        const auto coverage = coverage_of(sum);
+                        if (coverage == 256 && opaque)
+                            row[x] = brush.pixel;
+                        else if (coverage)
+                            blend(row[x], brush, static_cast<std::uint32_t>(coverage));
+                    }
+                    for (; x < end; x++) {
+                        sum += line[x];
+                        line[x] = 0;
+                    }
+                }
+            }
+        }
+    };
+
+    /// <summary>
+    /// 使用软件渲染重放显示列表的后端。
+    /// </summary>
+    using soft_backend = renderer<soft_device>;
+} // namespace overlay
@@ -0,0 +1,86 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <format>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace overlay {
+    /// <summary>
+    /// 以整数为参数的文字格式。
+    /// </summary>
+    enum class text_format : std::uint8_t {
+        integer, // 整数本身。
+        recent,  // 图中最大值的说明。参数为最大值的十倍，格式化时除以 10。
+        keys,    // 图中键数的说明。参数为键数。
+    };
+    inline constexpr size_t text_format_count = 3;
+
+    /// <summary>
+    /// 格式化后文字的缓存。以 (格式, 整数参数) 为键，同一键只格式化一次，
+    /// 稳定后生成一帧不再分配字符串。
+    /// </summary>
+    class text_run_cache {
+    public:
+        static constexpr size_t max_runs_per_format = 1024; // 每种格式最多缓存的文字个数。超过时清空该格式。
+
+    private:
+        std::array<std::wstring, text_format_count> formats{L"{}", L"{0:.1f}", L"{}"};
+        std::array<std::unordered_map<int, std::wstring>, text_format_count> runs;
+
+        std::uint64_t formatted_{};
+
+    private:
+        static size_t index(text_format id) {
+            return static_cast<size_t>(id);
+        }
+
+    public:
+        /// <summary>
+        /// 设置格式。与原来的格式不同时，丢弃该格式已缓存的文字。
+        /// </summary>
+        void set_format(text_format id, std::wstring_view fmt) {
+            auto& f = formats[index(id)];
+            if (f == fmt)
+                return;
+            f = fmt;
+            runs[index(id)].clear();
+        }
+        /// <summary>
+        /// 获取格式化后的文字。返回值在下一次调用非 const 成员函数前有效。
+        /// </summary>
+        std::wstring_view get(text_format id, int value) {
+            auto& map = runs[index(id)];
+            auto it = map.find(value);
+            if (it != map.end())
+                return it->second;
+
+            if (map.size() >= max_runs_per_format)
+                map.clear();
+            const auto& fmt = formats[index(id)];
+            std::wstring str;
+            if (id == text_format::recent) {
+                double tenths = static_cast<double>(value) / 10;
+                str = std::vformat(fmt, std::make_wformat_args(tenths));
+            } else
+                str = std::vformat(fmt, std::make_wformat_args(value));
+            formatted_++;
+            return map.emplace(value, std::move(str)).first->second;
+        }
+        void clear() {
+            for (auto& map : runs)
+                map.clear();
+        }
+
+    public:
+        /// <returns>实际格式化的次数。</returns>
+        std::uint64_t formatted_count() const {
+            return formatted_;
+        }
+    };
+} // namespace overlay
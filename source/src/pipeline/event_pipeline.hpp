@@ -0,0 +1,321 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../key_event.hpp"
+#include "../metrics/registry.hpp"
+
+namespace pipeline {
+    using kps::clock;
+    using kps::key_event;
+    using kps::time_point;
+
+    /// <summary>
+    /// 变换阶段。接收一批事件，输出过滤、修改或补充后的一批事件。
+    /// 由 event_pipeline 加锁调用，同一时间只有一个线程使用。
+    /// </summary>
+    class transform {
+    public:
+        virtual ~transform() = default;
+
+    public:
+        /// <summary>
+        /// 每个输入事件最多产生的事件数。
+        /// </summary>
+        virtual size_t max_expansion() const {
+            return 1;
+        }
+        /// <summary>
+        /// flush 最多产生的事件数。
+        /// </summary>
+        virtual size_t max_pending() const {
+            return 0;
+        }
+        /// <summary>
+        /// 处理一批事件，将结果写入 out 的开头。out 的大小至少为 in 的 max_expansion 倍。
+        /// </summary>
+        /// <returns>写入的事件数。</returns>
+        virtual size_t process(std::span<const key_event> in, std::span<key_event> out) = 0;
+        /// <summary>
+        /// 输出在 now 之前应转发的、被推迟的事件。out 的大小至少为 max_pending。
+        /// </summary>
+        /// <returns>写入的事件数。</returns>
+        virtual size_t flush(time_point, std::span<key_event>) {
+            return 0;
+        }
+    };
+
+    /// <summary>
+    /// 汇点。接收经过所有变换阶段的一批事件。由 event_pipeline 加锁调用。
+    /// </summary>
+    class sink {
+    public:
+        virtual ~sink() = default;
+
+    public:
+        virtual void consume(std::span<const key_event> events) = 0;
+    };
+
+    /// <summary>
+    /// 调用函数的汇点。
+    /// </summary>
+    class function_sink final : public sink {
+    public:
+        using function_t = std::function<void(std::span<const key_event>)>;
+
+    private:
+        function_t func;
+
+    public:
+        explicit function_sink(function_t func) : func(std::move(func)) {}
+        void consume(std::span<const key_event> events) override {
+            func(events);
+        }
+    };
+
+    /// <summary>
+    /// 一个阶段的累计开销。
+    /// </summary>
+    struct stage_report {
+        std::string name;
+        std::uint64_t events{};  // 进入该阶段的事件数。
+        std::uint64_t batches{}; // 调用该阶段的次数。
+        double seconds{};        // 在该阶段内的总时间。
+    };
+
+    /// <summary>
+    /// 按键事件的处理管线：来源调用 push，事件依次经过各变换阶段后交给所有汇点。
+    /// 阶段在启动时添加，之后处理事件不分配内存。事件成批传递，每批最多 max_batch 个，更大的批被拆分。
+    /// 整条管线只有一把锁，各阶段的开销以 osu_kps_pipeline_stage_* 计数。
+    /// 读取时钟与原子计数的开销与单个事件的处理相当，所以只对每 timing_period 批计时，耗时按比例估计；
+    /// 事件数与批数先在锁内累计，在计时的批与 flush 时计入计数器，所以计数器最多落后 timing_period - 1 批。
+    /// </summary>
+    class event_pipeline {
+    private:
+        struct stage_metrics {
+            metrics::sharded_counter& events;
+            metrics::sharded_counter& batches;
+            metrics::sharded_counter& nanoseconds;
+        };
+        template <typename T>
+        struct stage {
+            std::string name;
+            std::unique_ptr<T> p;
+            stage_metrics counters;
+            std::uint64_t unpublished_events{}; // 尚未计入 counters 的事件数。
+            std::uint64_t unpublished_batches{};
+        };
+
+    public:
+        static constexpr std::uint64_t timing_period = 16;
+
+    private:
+        mutable std::recursive_mutex m; // 允许在 configure 中调用 flush。
+        metrics::registry& reg;
+        size_t max_batch;
+        std::uint64_t batch_count{}; // 决定哪些批被计时。
+        std::uint64_t clock_cost;    // 读取一次时钟的纳秒数，从各阶段的耗时中扣除。
+        size_t capacity;
+        std::vector<stage<transform>> transforms;
+        std::vector<stage<sink>> sinks;
+        std::array<std::vector<key_event>, 2> buffers; // 相邻的变换阶段交替使用。
+
+    private:
+        stage_metrics make_metrics(const std::string& name) {
+            const std::string labels = "stage=\"" + name + "\"";
+            return {reg.counter("osu_kps_pipeline_stage_events_total", "Key events entering each pipeline stage.",
+                                labels),
+                    reg.counter("osu_kps_pipeline_stage_batches_total", "Batches processed by each pipeline stage.",
+                                labels),
+                    reg.counter("osu_kps_pipeline_stage_seconds_total", "Time spent in each pipeline stage.", labels,
+                                1e-9)};
+        }
+        /// <summary>
+        /// 计数一个阶段处理的一批事件。计时的批在阶段的边界读取一次时钟，耗时乘以 timing_period 计入。
+        /// </summary>
+        template <typename T>
+        void account(stage<T>& s, size_t events, bool timed, time_point& last) const {
+            s.unpublished_events += events;
+            s.unpublished_batches++;
+            if (!timed)
+                return;
+            const auto now = clock::now();
+            const auto elapsed =
+                static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count());
+            s.counters.nanoseconds.add(timing_period * (elapsed > clock_cost ? elapsed - clock_cost : 0));
+            last = now;
+        }
+        /// <summary>
+        /// 将累计的事件数与批数计入计数器。需要持有锁。
+        /// </summary>
+        void publish() {
+            auto each = [](auto& s) {
+                if (!s.unpublished_batches)
+                    return;
+                s.counters.events.add(s.unpublished_events);
+                s.counters.batches.add(s.unpublished_batches);
+                s.unpublished_events = s.unpublished_batches = 0;
+            };
+            for (auto& t : transforms)
+                each(t);
+            for (auto& s : sinks)
+                each(s);
+        }
+        /// <returns>连续两次读取时钟的间隔的中位数。</returns>
+        static std::uint64_t measure_clock_cost() {
+            std::array<std::chrono::nanoseconds, 63> samples;
+            for (auto& each : samples) {
+                const auto a = clock::now();
+                const auto b = clock::now();
+                each = std::chrono::duration_cast<std::chrono::nanoseconds>(b - a);
+            }
+            std::ranges::nth_element(samples, samples.begin() + samples.size() / 2);
+            return static_cast<std::uint64_t>(samples[samples.size() / 2].count());
+        }
+        /// <summary>
+        /// 从第 first 个变换阶段开始处理。in 不能位于 buffers[which] 中。需要持有锁。
+        /// </summary>
+        /// <param name="start">timed 时为本批开始的时间。</param>
+        void run(size_t first, std::span<const key_event> in, size_t which, bool timed, time_point start) {
+            auto last = start;
+            for (size_t i = first; i < transforms.size() && !in.empty(); i++) {
+                auto& t = transforms[i];
+                auto& out = buffers[which];
+                const size_t n = t.p->process(in, out);
+                account(t, in.size(), timed, last);
+                in = std::span(out).first(n);
+                which ^= 1;
+            }
+            if (!in.empty())
+                for (auto& s : sinks) {
+                    s.p->consume(in);
+                    account(s, in.size(), timed, last);
+                }
+            if (timed)
+                publish(); // 在最后一次读取时钟之后，不计入任何阶段的耗时。
+        }
+
+    public:
+        /// <param name="max_batch">每批最多的事件数。</param>
+        /// <param name="reg">记录各阶段开销的计数器所在的集合。</param>
+        explicit event_pipeline(size_t max_batch = 64, metrics::registry& reg = metrics::global())
+            : reg(reg), max_batch(std::max<size_t>(max_batch, 1)), clock_cost(measure_clock_cost()),
+              capacity(this->max_batch) {
+            for (auto& b : buffers)
+                b.resize(capacity);
+        }
+        event_pipeline(const event_pipeline&) = delete;
+        event_pipeline& operator=(const event_pipeline&) = delete;
+
+    public:
+        /// <summary>
+        /// 在所有变换阶段之后添加一个变换阶段。应在启动时调用，会分配内存。
+        /// </summary>
+        /// <returns>添加的阶段，在管线析构前一直有效。修改其状态时应使用 configure。</returns>
+        template <typename T>
+        T& add_transform(std::string name, std::unique_ptr<T> p) {
+            if (!p)
+                throw std::invalid_argument("transform is null.");
+            std::lock_guard _(m);
+            T& ret = *p;
+            capacity = std::max(capacity * p->max_expansion(), p->max_pending());
+            for (auto& b : buffers)
+                b.resize(capacity);
+            auto counters = make_metrics(name);
+            transforms.push_back({std::move(name), std::move(p), counters});
+            return ret;
+        }
+        /// <summary>
+        /// 添加一个汇点。汇点按添加的顺序接收事件。应在启动时调用。
+        /// </summary>
+        template <typename T>
+        T& add_sink(std::string name, std::unique_ptr<T> p) {
+            if (!p)
+                throw std::invalid_argument("sink is null.");
+            std::lock_guard _(m);
+            T& ret = *p;
+            auto counters = make_metrics(name);
+            sinks.push_back({std::move(name), std::move(p), counters});
+            return ret;
+        }
+        /// <summary>
+        /// 添加调用 func 的汇点。
+        /// </summary>
+        function_sink& add_sink(std::string name, function_sink::function_t func) {
+            return add_sink(std::move(name), std::make_unique<function_sink>(std::move(func)));
+        }
+        /// <summary>
+        /// 持有管线的锁调用 func，用于修改阶段的状态。func 中可以调用 flush。
+        /// </summary>
+        template <typename F>
+        decltype(auto) configure(F&& func) {
+            std::lock_guard _(m);
+            return std::forward<F>(func)();
+        }
+
+    public:
+        /// <summary>
+        /// 处理一批事件。可以在任意线程调用。
+        /// </summary>
+        void push(std::span<const key_event> events) {
+            std::lock_guard _(m);
+            while (!events.empty()) {
+                const size_t n = std::min(events.size(), max_batch);
+                const bool timed = batch_count++ % timing_period == 0;
+                run(0, events.first(n), 0, timed, timed ? clock::now() : time_point{});
+                events = events.subspan(n);
+            }
+        }
+        /// <summary>
+        /// 让各变换阶段输出在 now 之前应转发的、被推迟的事件，并交给之后的阶段。应定期调用。
+        /// </summary>
+        void flush(time_point now) {
+            std::lock_guard _(m);
+            for (size_t i = 0; i < transforms.size(); i++) {
+                auto& t = transforms[i];
+                const bool timed = batch_count % timing_period == 0; // 空的 flush 不算作一批。
+                auto start = timed ? clock::now() : time_point{};
+                const size_t n = t.p->flush(now, buffers[0]);
+                if (!n)
+                    continue;
+                batch_count++;
+                account(t, 0, timed, start);
+                run(i + 1, std::span(buffers[0]).first(n), 1, timed, start);
+            }
+            publish();
+        }
+
+    public:
+        /// <summary>
+        /// 各阶段的累计开销，变换阶段在前，汇点在后。
+        /// </summary>
+        std::vector<stage_report> report() const {
+            std::lock_guard _(m);
+            std::vector<stage_report> ret;
+            auto add = [&ret](const auto& s) {
+                ret.push_back({s.name, s.counters.events.value() + s.unpublished_events,
+                               s.counters.batches.value() + s.unpublished_batches,
+                               static_cast<double>(s.counters.nanoseconds.value()) * 1e-9});
+            };
+            for (const auto& t : transforms)
+                add(t);
+            for (const auto& s : sinks)
+                add(s);
+            return ret;
+        }
+    };
+} // namespace pipeline
@@ -0,0 +1,138 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+#include "../debounce.hpp"
+#include "../key_remap.hpp"
+#include "../metrics/registry.hpp"
+#include "event_pipeline.hpp"
+
+namespace pipeline {
+    inline constexpr size_t key_count = 256;
+
+    /// <summary>
+    /// 只保留部分按键的事件。默认保留所有按键。
+    /// </summary>
+    class key_filter final : public transform {
+    private:
+        std::array<bool, key_count> pass;
+
+    public:
+        key_filter() {
+            pass.fill(true);
+        }
+
+    public:
+        void set(int key, bool whether) {
+            pass[static_cast<std::uint8_t>(key)] = whether;
+        }
+        void set_all(bool whether) {
+            pass.fill(whether);
+        }
+        size_t process(std::span<const key_event> in, std::span<key_event> out) override {
+            size_t n = 0;
+            for (const auto& e : in) {
+                out[n] = e;
+                n += pass[static_cast<std::uint8_t>(e.key)];
+            }
+            return n;
+        }
+    };
+
+    /// <summary>
+    /// 按表修改按键码，参见 kps::key_remap_table。映射到 dropped 的按键被丢弃。默认不修改。
+    /// </summary>
+    class remap_stage final : public transform {
+    public:
+        static constexpr int dropped = kps::key_remap_table::dropped;
+
+    private:
+        kps::key_remap_table table;
+
+    public:
+        void reset() {
+            table = kps::key_remap_table();
+        }
+        void set(int from, int to) {
+            table.set(from, to);
+        }
+        void set_table(const kps::key_remap_table& new_table) {
+            table = new_table;
+        }
+        int get(int from) const {
+            return table[from];
+        }
+        size_t process(std::span<const key_event> in, std::span<key_event> out) override {
+            size_t n = 0;
+            for (const auto& e : in) {
+                const int to = table[e.key];
+                out[n] = e;
+                out[n].key = to;
+                n += to != dropped;
+            }
+            return n;
+        }
+    };
+
+    /// <summary>
+    /// 将事件的来源设为指定的编号。
+    /// </summary>
+    class tag_stage final : public transform {
+    private:
+        std::uint8_t tag;
+
+    public:
+        explicit tag_stage(std::uint8_t tag = 0) : tag(tag) {}
+
+    public:
+        void set_tag(std::uint8_t new_tag) {
+            tag = new_tag;
+        }
+        std::uint8_t get_tag() const {
+            return tag;
+        }
+        size_t process(std::span<const key_event> in, std::span<key_event> out) override {
+            for (size_t i = 0; i < in.size(); i++) {
+                out[i] = in[i];
+                out[i].source = tag;
+            }
+            return in.size();
+        }
+    };
+
+    /// <summary>
+    /// 按键抖动过滤，参见 kps::debounce_filter。需要在 filter().next_deadline() 时调用管线的 flush。
+    /// </summary>
+    class debounce_stage final : public transform {
+    private:
+        kps::debounce_filter debounce;
+        metrics::sharded_counter& suppressed_counter{metrics::global().counter(
+            "osu_kps_debounce_suppressed_total", "Key events dropped by the debounce filter.")};
+
+    public:
+        kps::debounce_filter& filter() {
+            return debounce;
+        }
+        size_t max_expansion() const override {
+            return 2;
+        }
+        size_t max_pending() const override {
+            return kps::debounce_filter::key_count;
+        }
+        size_t process(std::span<const key_event> in, std::span<key_event> out) override {
+            const auto before = debounce.suppressed_count();
+            const size_t n = debounce.process(in, out);
+            if (const auto suppressed = debounce.suppressed_count() - before)
+                suppressed_counter.add(suppressed);
+            return n;
+        }
+        size_t flush(time_point now, std::span<key_event> out) override {
+            return debounce.flush(now, out);
+        }
+    };
+} // namespace pipeline
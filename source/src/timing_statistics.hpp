@@ -0,0 +1,246 @@
+// Copyright (c) UnnamedOrange. Licensed under the MIT Licence.
+// See the LICENSE file in the repository root for full licence text.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <string_view>
+
+#include "utils/SeqLock.hpp"
+
+namespace kps {
+    /// <summary>
+    /// HDR 风格的对数分桶直方图。值为非负整数（微秒）。
+    /// 小于 2 * sub_bucket_count 的值精确记录，更大的值按 2 的幂分段，每段再均分为 sub_bucket_count 个桶，
+    /// 相对误差不超过 1 / sub_bucket_count。内存固定。
+    /// 只允许一个线程写入，可以随时无锁读取。
+    /// </summary>
+    class log_histogram {
+    public:
+        static constexpr unsigned sub_bucket_bits = 4;
+        static constexpr std::uint64_t sub_bucket_count = std::uint64_t{1} << sub_bucket_bits;
+        static constexpr unsigned max_bits = 27; // 可记录的最大值约为 2^27 微秒，即 134 秒。更大的值记入最后一个桶。
+        static constexpr std::uint64_t max_value = (std::uint64_t{1} << max_bits) - 1;
+        static constexpr size_t bucket_count =
+            2 * sub_bucket_count + (max_bits - sub_bucket_bits - 1) * sub_bucket_count;
+        using counts_t = std::array<std::uint32_t, bucket_count>;
+
+    private:
+        std::array<std::atomic<std::uint32_t>, bucket_count> counts{};
+
+    public:
+        /// <summary>
+        /// 值所在的桶。
+        /// </summary>
+        static constexpr size_t index_of(std::uint64_t value) {
+            value = std::min(value, max_value);
+            if (value < 2 * sub_bucket_count)
+                return static_cast<size_t>(value);
+            unsigned shift = static_cast<unsigned>(std::bit_width(value)) - 1 - sub_bucket_bits;
+            auto sub = (value >> shift) - sub_bucket_count;
+            return static_cast<size_t>(2 * sub_bucket_count + (shift - 1) * sub_bucket_count + sub);
+        }
+        /// <summary>
+        /// 桶中最小的值。
+        /// </summary>
+        static constexpr std::uint64_t lower_bound_of(size_t index) {
+            if (index < 2 * sub_bucket_count)
+                return index;
+            auto shift = (index - 2 * sub_bucket_count) / sub_bucket_count + 1;
+            auto sub = (index - 2 * sub_bucket_count) % sub_bucket_count;
+            return (sub_bucket_count + sub) << shift;
+        }
+        /// <summary>
+        /// 桶中值的个数。
+        /// </summary>
+        static constexpr std::uint64_t width_of(size_t index) {
+            if (index < 2 * sub_bucket_count)
+                return 1;
+            return std::uint64_t{1} << ((index - 2 * sub_bucket_count) / sub_bucket_count + 1);
+        }
+        /// <summary>
+        /// 根据各桶计数估计分位数。取桶的中点。
+        /// </summary>
+        /// <param name="q">[0, 1] 中的分位。</param>
+        static double quantile(const counts_t& counts, double q) {
+            std::uint64_t total = 0;
+            for (auto c : counts)
+                total += c;
+            if (!total)
+                return 0;
+            auto rank = static_cast<std::uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * static_cast<double>(total)));
+            rank = std::max<std::uint64_t>(rank, 1);
+            std::uint64_t seen = 0;
+            for (size_t i = 0; i < counts.size(); i++) {
+                seen += counts[i];
+                if (seen >= rank)
+                    return static_cast<double>(lower_bound_of(i)) + static_cast<double>(width_of(i) - 1) / 2;
+            }
+            return static_cast<double>(max_value);
+        }
+
+    public:
+        void record(std::uint64_t value) {
+            auto& c = counts[index_of(value)];
+            c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        void clear() {
+            for (auto& c : counts)
+                c.store(0, std::memory_order_relaxed);
+        }
+        counts_t snapshot() const {
+            counts_t ret;
+            for (size_t i = 0; i < counts.size(); i++)
+                ret[i] = counts[i].load(std::memory_order_relaxed);
+            return ret;
+        }
+    };
+
+    /// <summary>
+    /// 使用 Welford 算法在线计算的均值与方差。
+    /// </summary>
+    struct running_moments {
+        std::uint64_t count{};
+        double mean{};
+        double m2{}; // 与均值之差的平方和。
+        double min{};
+        double max{};
+
+        void add(double value) {
+            count++;
+            double delta = value - mean;
+            mean += delta / static_cast<double>(count);
+            m2 += delta * (value - mean);
+            min = count == 1 ? value : std::min(min, value);
+            max = count == 1 ? value : std::max(max, value);
+        }
+        /// <returns>总体方差。</returns>
+        double variance() const {
+            return count ? m2 / static_cast<double>(count) : 0;
+        }
+        double stddev() const {
+            return std::sqrt(variance());
+        }
+    };
+
+    /// <summary>
+    /// 各列按键时长与按键间隔的流式统计。每次更新为 O(1)，内存固定。
+    /// 只允许一个线程（或在同一把锁下）写入，可以在任意线程无锁读取快照。
+    /// 时间以微秒为单位。
+    /// </summary>
+    template <size_t column_count>
+    class timing_statistics {
+    public:
+        enum class metric {
+            hold,     // 按下到放开的时长。
+            interval, // 相邻两次按下的间隔。
+        };
+        static constexpr size_t metric_count = 2;
+        static constexpr std::array<std::wstring_view, metric_count> metric_names{
+            L"hold",
+            L"interval",
+        };
+
+        struct snapshot_t {
+            running_moments moments;
+            log_histogram::counts_t counts{};
+
+            double quantile(double q) const {
+                return log_histogram::quantile(counts, q);
+            }
+        };
+
+    private:
+        struct channel {
+            log_histogram histogram;
+            running_moments moments;                        // 写者持有的副本。
+            orange::SeqLock<running_moments> moments_state; // 发布给读者的副本。
+        };
+        std::array<std::array<channel, metric_count>, column_count> channels;
+
+        channel& at(size_t column, metric which) {
+            return channels[column][static_cast<size_t>(which)];
+        }
+        const channel& at(size_t column, metric which) const {
+            return channels[column][static_cast<size_t>(which)];
+        }
+
+    public:
+        /// <summary>
+        /// 记录一个时长。负的时长视为 0。
+        /// </summary>
+        void record(size_t column, metric which, std::chrono::steady_clock::duration value) {
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(value).count();
+            auto v = static_cast<std::uint64_t>(std::max<decltype(us)>(us, 0));
+            auto& c = at(column, which);
+            c.histogram.record(v);
+            c.moments.add(static_cast<double>(v));
+            c.moments_state.store(c.moments);
+        }
+        void clear() {
+            for (auto& column : channels)
+                for (auto& c : column) {
+                    c.histogram.clear();
+                    c.moments = {};
+                    c.moments_state.store(c.moments);
+                }
+        }
+        snapshot_t snapshot(size_t column, metric which) const {
+            const auto& c = at(column, which);
+            snapshot_t ret;
+            ret.moments = c.moments_state.load();
+            ret.counts = c.histogram.snapshot();
+            return ret;
+        }
+
+    public:
+        /// <summary>
+        /// 生成各列的统计表，用于显示。省略没有样本的列。列号从 1 开始。
+        /// </summary>
+        std::wstring report() const {
+            std::wstring ret = std::format(L"{:<16}{:>10}{:>10}{:>10}{:>10}{:>10}{:>10}\n", L"column (us)", L"count",
+                                           L"mean", L"stddev", L"p50", L"p99", L"max");
+            for (size_t i = 0; i < column_count; i++)
+                for (size_t j = 0; j < metric_count; j++) {
+                    auto s = snapshot(i, static_cast<metric>(j));
+                    if (!s.moments.count)
+                        continue;
+                    std::format_to(std::back_inserter(ret),
+                                   L"{:<16}{:>10}{:>10.1f}{:>10.1f}{:>10.1f}{:>10.1f}{:>10.0f}\n",
+                                   std::format(L"{} {}", i + 1, metric_names[j]), s.moments.count, s.moments.mean,
+                                   s.moments.stddev(), s.quantile(0.5), s.quantile(0.99), s.moments.max);
+                }
+            return ret;
+        }
+        /// <summary>
+        /// 将 report 的结果和各直方图的非空桶写入文件。
+        /// </summary>
+        bool write_to_file(const std::filesystem::path& path) const {
+            std::wofstream ofs(path);
+            if (!ofs)
+                return false;
+            ofs << report() << L"\ncolumn,metric,lower_bound_us,count\n";
+            for (size_t i = 0; i < column_count; i++)
+                for (size_t j = 0; j < metric_count; j++) {
+                    const auto counts = at(i, static_cast<metric>(j)).histogram.snapshot();
+                    for (size_t b = 0; b < counts.size(); b++)
+                        if (counts[b])
+                            ofs << i + 1 << L',' << metric_names[j] << L',' << log_histogram::lower_bound_of(b) << L','
+                                << counts[b] << L'\n';
+                }
+            return static_cast<bool>(ofs);
+        }
+    };
+} // namespace kps
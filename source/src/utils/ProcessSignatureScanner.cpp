@@ -0,0 +1,134 @@
+/**
+ * @file ProcessSignatureScanner.cpp
+ * @author UnnamedOrange
+ * @brief Scan the memory of another process for a @ref SignaturePattern.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include "ProcessSignatureScanner.h"
+
+#include <utility>
+
+#include <TlHelp32.h>
+
+using namespace orange;
+
+using Self = ProcessSignatureScanner;
+
+Self Self::try_open(std::wstring_view exe_name) noexcept {
+    HANDLE hSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+    if (hSnapshot == INVALID_HANDLE_VALUE) {
+        return {};
+    }
+
+    DWORD process_id{};
+    PROCESSENTRY32W entry{};
+    entry.dwSize = sizeof(entry);
+    for (BOOL ok = Process32FirstW(hSnapshot, &entry); ok; ok = Process32NextW(hSnapshot, &entry)) {
+        if (exe_name == entry.szExeFile) {
+            process_id = entry.th32ProcessID;
+            break;
+        }
+    }
+    CloseHandle(hSnapshot);
+    if (!process_id) {
+        return {};
+    }
+
+    HANDLE hProcess = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ | SYNCHRONIZE, FALSE, process_id);
+    if (!hProcess) {
+        return {};
+    }
+    return {hProcess, process_id};
+}
+
+Self::ProcessSignatureScanner(Self&& other) noexcept : ProcessSignatureScanner() {
+    swap(*this, other);
+}
+Self& Self::operator=(Self other) noexcept {
+    swap(*this, other);
+    return *this;
+}
+Self::~ProcessSignatureScanner() {
+    reset();
+}
+Self::ProcessSignatureScanner(HANDLE hProcess, DWORD process_id) noexcept
+    : hProcess(hProcess), process_id(process_id) {}
+
+bool Self::empty() const noexcept {
+    return !hProcess;
+}
+DWORD Self::id() const noexcept {
+    return process_id;
+}
+bool Self::exited() const noexcept {
+    return !hProcess || WaitForSingleObject(hProcess, 0) != WAIT_TIMEOUT;
+}
+void Self::reset() noexcept {
+    if (hProcess) {
+        CloseHandle(hProcess);
+        hProcess = nullptr;
+        process_id = 0;
+    }
+}
+
+std::vector<SignatureRegion> Self::executable_regions() const {
+    std::vector<SignatureRegion> ret;
+    if (!hProcess) {
+        return ret;
+    }
+
+    constexpr DWORD executable_readable = PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY;
+    MEMORY_BASIC_INFORMATION info{};
+    for (std::uintptr_t address = 0;
+         VirtualQueryEx(hProcess, reinterpret_cast<LPCVOID>(address), &info, sizeof(info)) == sizeof(info);) {
+        const auto base = reinterpret_cast<std::uintptr_t>(info.BaseAddress);
+        const auto next = base + info.RegionSize;
+        if (info.State == MEM_COMMIT && !(info.Protect & (PAGE_GUARD | PAGE_NOACCESS)) &&
+            (info.Protect & executable_readable)) {
+            ret.push_back({base, info.RegionSize});
+        }
+        if (next <= address) {
+            break; // Wrapped around.
+        }
+        address = next;
+    }
+    return ret;
+}
+
+std::optional<std::uintptr_t> Self::scan(const SignaturePattern& pattern, unsigned thread_count) const {
+    if (!hProcess) {
+        return std::nullopt;
+    }
+    const auto regions = executable_regions();
+    return scan_regions(
+        regions, pattern,
+        [this](std::uintptr_t address, std::byte* buffer, std::size_t size) -> std::size_t {
+            SIZE_T got{};
+            if (!ReadProcessMemory(hProcess, reinterpret_cast<LPCVOID>(address), buffer, size, &got)) {
+                // Partial reads are reported through `got` as well.
+                if (GetLastError() != ERROR_PARTIAL_COPY) {
+                    return 0;
+                }
+            }
+            return got;
+        },
+        thread_count);
+}
+
+bool Self::verify(const SignaturePattern& pattern, std::uintptr_t address) const {
+    if (!hProcess) {
+        return false;
+    }
+    std::vector<std::byte> buffer(pattern.size());
+    SIZE_T got{};
+    if (!ReadProcessMemory(hProcess, reinterpret_cast<LPCVOID>(address), buffer.data(), buffer.size(), &got) ||
+        got != buffer.size()) {
+        return false;
+    }
+    return pattern.match_at(buffer.data());
+}
@@ -0,0 +1,86 @@
+/**
+ * @file ProcessSignatureScanner.h
+ * @author UnnamedOrange
+ * @brief Scan the memory of another process for a @ref SignaturePattern.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include <Windows.h>
+
+#include "SignatureScanner.hpp"
+
+namespace orange {
+    /**
+     * @brief Owns a read-only handle to a process and scans its memory.
+     *
+     * Only committed regions that are both readable and executable are scanned,
+     * since the signatures we look for live in JIT-compiled code.
+     */
+    class ProcessSignatureScanner final {
+        using Self = ProcessSignatureScanner;
+
+    private:
+        HANDLE hProcess{};
+        DWORD process_id{};
+
+    public:
+        /**
+         * @brief Open the first process whose executable name is `exe_name`.
+         *
+         * @return Self An empty object if no such process can be opened.
+         */
+        static Self try_open(std::wstring_view exe_name) noexcept;
+
+    public:
+        ProcessSignatureScanner() noexcept = default;
+        ProcessSignatureScanner(const Self&) = delete;
+        ProcessSignatureScanner(Self&& other) noexcept;
+        Self& operator=(Self other) noexcept;
+
+        ~ProcessSignatureScanner();
+
+        friend void swap(Self& a, Self& b) noexcept {
+            using std::swap;
+            swap(a.hProcess, b.hProcess);
+            swap(a.process_id, b.process_id);
+        }
+
+    private:
+        ProcessSignatureScanner(HANDLE hProcess, DWORD process_id) noexcept;
+
+    public:
+        bool empty() const noexcept;
+        DWORD id() const noexcept;
+        /**
+         * @brief Whether the process has exited or the handle is empty.
+         */
+        bool exited() const noexcept;
+        void reset() noexcept;
+
+    public:
+        /**
+         * @brief Committed, readable and executable regions of the process.
+         */
+        std::vector<SignatureRegion> executable_regions() const;
+        /**
+         * @brief Find the lowest address matching `pattern`.
+         * Regions are scanned in parallel.
+         */
+        std::optional<std::uintptr_t> scan(const SignaturePattern& pattern, unsigned thread_count = 0) const;
+        /**
+         * @brief Check whether `pattern` still matches at `address`.
+         */
+        bool verify(const SignaturePattern& pattern, std::uintptr_t address) const;
+    };
+} // namespace orange
@@ -0,0 +1,111 @@
+/**
+ * @file SeqLock.hpp
+ * @author UnnamedOrange
+ * @brief Publish a small trivially copyable value to lock-free readers.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <type_traits>
+
+namespace orange {
+    /**
+     * @brief Sequence lock.
+     *
+     * One writer at a time (the caller serializes writers), any number of readers.
+     * Readers never block the writer and retry if they overlap a write,
+     * so every @ref load returns a value that was stored as a whole.
+     *
+     * The value is kept as atomic words, so concurrent access is not a data race.
+     */
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    class SeqLock final {
+    private:
+        using word_t = std::uint64_t;
+        static constexpr std::size_t word_count = (sizeof(T) + sizeof(word_t) - 1) / sizeof(word_t);
+
+        std::atomic<std::uint64_t> sequence{}; // Odd while a write is in progress.
+        std::array<std::atomic<word_t>, word_count> words{};
+
+    public:
+        SeqLock() noexcept {
+            store(T{});
+        }
+        explicit SeqLock(const T& value) noexcept {
+            store(value);
+        }
+        SeqLock(const SeqLock&) = delete;
+        SeqLock& operator=(const SeqLock&) = delete;
+
+    public:
+        void store(const T& value) noexcept {
+            std::array<word_t, word_count> buffer{};
+            std::memcpy(buffer.data(), &value, sizeof(T));
+
+            const auto crt = sequence.load(std::memory_order_relaxed);
+            sequence.store(crt + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (std::size_t i = 0; i < word_count; i++)
+                words[i].store(buffer[i], std::memory_order_relaxed);
+            sequence.store(crt + 2, std::memory_order_release);
+        }
+
+        T load() const noexcept {
+            static_assert(std::is_default_constructible_v<T>);
+            std::array<word_t, word_count> buffer;
+            while (!try_read(buffer))
+                ;
+            return from_words(buffer);
+        }
+
+        /**
+         * @brief Like @ref load, but gives up after `attempts` reads that overlap a write.
+         *
+         * Use this when the writer may stop in the middle of a write,
+         * e.g. when the value lives in memory shared with another process.
+         */
+        std::optional<T> try_load(std::size_t attempts) const noexcept {
+            static_assert(std::is_default_constructible_v<T>);
+            std::array<word_t, word_count> buffer;
+            for (std::size_t i = 0; i < attempts; i++)
+                if (try_read(buffer))
+                    return from_words(buffer);
+            return std::nullopt;
+        }
+
+    private:
+        bool try_read(std::array<word_t, word_count>& buffer) const noexcept {
+            const auto before = sequence.load(std::memory_order_acquire);
+            if (before & 1)
+                return false;
+            for (std::size_t i = 0; i < word_count; i++)
+                buffer[i] = words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return sequence.load(std::memory_order_relaxed) == before;
+        }
+        static T from_words(const std::array<word_t, word_count>& buffer) noexcept {
+            T ret;
+            std::memcpy(static_cast<void*>(&ret), buffer.data(), sizeof(T));
+            return ret;
+        }
+
+    public:
+        /**
+         * @brief Even version of the current value. Changes whenever a value is stored.
+         */
+        std::uint64_t version() const noexcept {
+            return sequence.load(std::memory_order_acquire);
+        }
+    };
+} // namespace orange
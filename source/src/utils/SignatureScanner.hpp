@@ -0,0 +1,244 @@
+/**
+ * @file SignatureScanner.hpp
+ * @author UnnamedOrange
+ * @brief Wildcard byte signature matching with SIMD anchor filtering.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define ORANGE_SIGNATURE_SCANNER_SSE2 1
+#endif
+
+namespace orange {
+    /**
+     * @brief Byte pattern like `7D 15 A1 ?? ?? ?? ?? 85 C0`.
+     * `??` matches any byte.
+     *
+     * Candidates are filtered by the first and the last significant byte
+     * (the anchors) 16 positions at a time, and only the survivors
+     * are compared with the full mask.
+     */
+    class SignaturePattern final {
+    private:
+        std::vector<std::uint8_t> bytes;
+        std::vector<std::uint8_t> mask; // 0xFF for significant bytes, 0 for wildcards.
+        std::size_t anchor_first{};
+        std::size_t anchor_last{};
+        bool has_anchor{};
+
+    public:
+        /**
+         * @throws std::invalid_argument If the text is not a valid pattern.
+         */
+        explicit SignaturePattern(std::string_view text) {
+            auto hex = [](char ch) -> int {
+                if ('0' <= ch && ch <= '9')
+                    return ch - '0';
+                if ('a' <= ch && ch <= 'f')
+                    return ch - 'a' + 10;
+                if ('A' <= ch && ch <= 'F')
+                    return ch - 'A' + 10;
+                return -1;
+            };
+            for (std::size_t i = 0; i < text.size();) {
+                if (text[i] == ' ') {
+                    i++;
+                    continue;
+                }
+                if (i + 1 >= text.size())
+                    throw std::invalid_argument("incomplete byte in signature.");
+                if (text[i] == '?' && text[i + 1] == '?') {
+                    bytes.push_back(0);
+                    mask.push_back(0);
+                } else {
+                    int high = hex(text[i]);
+                    int low = hex(text[i + 1]);
+                    if (high < 0 || low < 0)
+                        throw std::invalid_argument("invalid byte in signature.");
+                    bytes.push_back(static_cast<std::uint8_t>(high << 4 | low));
+                    mask.push_back(0xFF);
+                }
+                i += 2;
+            }
+            if (bytes.empty())
+                throw std::invalid_argument("empty signature.");
+
+            for (std::size_t i = 0; i < mask.size(); i++) {
+                if (mask[i]) {
+                    if (!has_anchor)
+                        anchor_first = i;
+                    anchor_last = i;
+                    has_anchor = true;
+                }
+            }
+        }
+
+    public:
+        std::size_t size() const noexcept {
+            return bytes.size();
+        }
+
+        /**
+         * @brief Compare the pattern with the bytes starting at `p`.
+         * At least @ref size bytes must be readable.
+         */
+        bool match_at(const std::byte* p) const noexcept {
+            for (std::size_t i = 0; i < bytes.size(); i++)
+                if ((std::to_integer<std::uint8_t>(p[i]) & mask[i]) != bytes[i])
+                    return false;
+            return true;
+        }
+
+        /**
+         * @brief Find the first match without any filtering.
+         * Kept as the reference implementation.
+         */
+        std::optional<std::size_t> find_naive(std::span<const std::byte> data) const noexcept {
+            if (data.size() < size())
+                return std::nullopt;
+            for (std::size_t i = 0, last = data.size() - size(); i <= last; i++)
+                if (match_at(data.data() + i))
+                    return i;
+            return std::nullopt;
+        }
+
+        /**
+         * @brief Find the first match.
+         *
+         * @return The offset of the first match in `data`.
+         */
+        std::optional<std::size_t> find(std::span<const std::byte> data) const noexcept {
+            if (data.size() < size())
+                return std::nullopt;
+            if (!has_anchor)
+                return 0;
+
+            const std::size_t last = data.size() - size(); // Last valid start.
+            const auto* base = data.data();
+            std::size_t i = 0;
+#ifdef ORANGE_SIGNATURE_SCANNER_SSE2
+            // Loading 16 bytes at `i + anchor_last` must stay inside `data`,
+            // which holds as long as `i + 15 <= last`.
+            const __m128i first = _mm_set1_epi8(static_cast<char>(bytes[anchor_first]));
+            const __m128i second = _mm_set1_epi8(static_cast<char>(bytes[anchor_last]));
+            for (; last >= 15 && i <= last - 15; i += 16) {
+                const __m128i block_first =
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + i + anchor_first));
+                const __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + i + anchor_last));
+                auto candidates = static_cast<unsigned>(_mm_movemask_epi8(
+                    _mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, second))));
+                while (candidates) {
+                    const auto bit = static_cast<std::size_t>(std::countr_zero(candidates));
+                    if (match_at(base + i + bit))
+                        return i + bit;
+                    candidates &= candidates - 1;
+                }
+            }
+#endif
+            for (; i <= last; i++) {
+                if (std::to_integer<std::uint8_t>(base[i + anchor_first]) != bytes[anchor_first])
+                    continue;
+                if (match_at(base + i))
+                    return i;
+            }
+            return std::nullopt;
+        }
+    };
+
+    /**
+     * @brief A contiguous range of addresses in some address space.
+     */
+    struct SignatureRegion {
+        std::uintptr_t base{};
+        std::size_t size{};
+    };
+
+    /**
+     * @brief Scan regions for the lowest matching address using several threads.
+     *
+     * Regions are cut into chunks that overlap by `pattern.size() - 1` bytes
+     * so that matches across chunk borders are not lost.
+     * Chunks lying above an already found match are skipped.
+     *
+     * @param read Reads `size` bytes at `address` into `buffer`.
+     * Returns the number of bytes actually read. May be called concurrently.
+     * @param thread_count 0 means `std::thread::hardware_concurrency()`.
+     */
+    inline std::optional<std::uintptr_t> scan_regions(
+        std::span<const SignatureRegion> regions, const SignaturePattern& pattern,
+        const std::function<std::size_t(std::uintptr_t address, std::byte* buffer, std::size_t size)>& read,
+        unsigned thread_count = 0, std::size_t chunk_size = std::size_t{1} << 20) {
+        struct Chunk {
+            std::uintptr_t base;
+            std::size_t size;
+        };
+        std::vector<Chunk> chunks;
+        const std::size_t overlap = pattern.size() - 1;
+        chunk_size = std::max(chunk_size, pattern.size());
+        for (const auto& region : regions) {
+            for (std::size_t offset = 0; offset < region.size; offset += chunk_size) {
+                std::size_t size = std::min(region.size - offset, chunk_size + overlap);
+                if (size >= pattern.size())
+                    chunks.push_back({region.base + offset, size});
+            }
+        }
+        std::sort(chunks.begin(), chunks.end(), [](const Chunk& a, const Chunk& b) { return a.base < b.base; });
+
+        constexpr auto not_found = std::numeric_limits<std::uintptr_t>::max();
+        std::atomic<std::uintptr_t> best{not_found};
+        std::atomic<std::size_t> next{};
+        auto worker = [&] {
+            std::vector<std::byte> buffer(chunk_size + overlap);
+            for (std::size_t idx; (idx = next.fetch_add(1, std::memory_order_relaxed)) < chunks.size();) {
+                const auto& chunk = chunks[idx];
+                if (chunk.base >= best.load(std::memory_order_relaxed))
+                    break; // Chunks are sorted, so nothing lower remains.
+                std::size_t got = read(chunk.base, buffer.data(), chunk.size);
+                auto found = pattern.find(std::span(buffer.data(), std::min(got, chunk.size)));
+                if (!found)
+                    continue;
+                std::uintptr_t address = chunk.base + *found;
+                std::uintptr_t crt = best.load(std::memory_order_relaxed);
+                while (address < crt && !best.compare_exchange_weak(crt, address, std::memory_order_relaxed))
+                    ;
+            }
+        };
+
+        if (!thread_count)
+            thread_count = std::max(1u, std::thread::hardware_concurrency());
+        thread_count = static_cast<unsigned>(std::min<std::size_t>(thread_count, chunks.size()));
+        if (thread_count <= 1)
+            worker();
+        else {
+            std::vector<std::jthread> threads;
+            threads.reserve(thread_count);
+            for (unsigned i = 0; i < thread_count; i++)
+                threads.emplace_back(worker);
+        }
+
+        if (auto ret = best.load(); ret != not_found)
+            return ret;
+        return std::nullopt;
+    }
+} // namespace orange
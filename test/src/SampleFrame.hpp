@@ -0,0 +1,79 @@
+/**
+ * @file SampleFrame.hpp
+ * @author UnnamedOrange
+ * @brief The overlay frame shared by the frame builder, renderer and rasterizer tests and benchmarks.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include <overlay/frame_builder.hpp>
+
+namespace orange::test {
+    /**
+     * @brief A four-key frame with one pressed key, one fading key and a sawtooth KPS history.
+     * `input` points into the other members, so the fixture can be neither copied nor moved.
+     */
+    struct sample_frame {
+        static constexpr size_t max_button_count = 10;
+
+        overlay::frame_strings strings{L"max", L"{0:.1f} max KPS in recent 5 minutes.", L"({0} keys)"};
+        std::array<overlay::column_input, max_button_count> columns{{
+            {L"D", overlay::label_style::single, true, 5.0, 0.02, 0.5},
+            {L"F", overlay::label_style::single, false, 3.0, 0.3, 0.1},
+            {L"J", overlay::label_style::single, false, 0.0, 100.0, 100.0},
+            {L"K", overlay::label_style::single, false, 0.0, 100.0, 100.0},
+            {L"A", overlay::label_style::single, false, 0.0, 100.0, 100.0},
+            {L"S", overlay::label_style::single, false, 0.0, 100.0, 100.0},
+            {L"L", overlay::label_style::single, false, 0.0, 100.0, 100.0},
+            {L";", overlay::label_style::single, false, 0.0, 100.0, 100.0},
+            {L"V", overlay::label_style::single, false, 0.0, 100.0, 100.0},
+            {L"N", overlay::label_style::single, false, 0.0, 100.0, 100.0},
+        }};
+        std::vector<double> history;
+        overlay::frame_input input;
+
+        /**
+         * @param scale DPI scale. The frame is 232 logical pixels wide.
+         * @param history_size Number of seconds in the KPS history.
+         */
+        explicit sample_frame(double scale = 1, size_t history_size = 300) : history(history_size) {
+            for (size_t i = 0; i < history.size(); i++)
+                history[i] = static_cast<double>(i % 17);
+            input.scale = scale;
+            input.width = 232 * scale;
+            input.show_buttons = input.show_statistics = input.show_graph = true;
+            set_button_count(4);
+            input.kps_now = 8;
+            input.max_kps = 20;
+            input.history = history;
+            input.strings = &strings;
+        }
+        sample_frame(const sample_frame&) = delete;
+        sample_frame& operator=(const sample_frame&) = delete;
+
+        void set_button_count(int button_count) {
+            input.button_count = button_count;
+            input.columns = std::span(columns).first(static_cast<size_t>(button_count));
+        }
+        /**
+         * @brief Release every key long ago so that nothing fades any more.
+         */
+        void idle() {
+            for (auto& col : columns) {
+                col.down = false;
+                col.kps = 0;
+                col.since_down = col.since_up = 100;
+            }
+        }
+    };
+} // namespace orange::test
@@ -0,0 +1,73 @@
+/**
+ * @file TestColorRamp.cpp
+ * @author UnnamedOrange
+ * @brief Test the lookup-table `overlay::color_ramp` against `overlay::interpolate`.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include <overlay/color_ramp.hpp>
+
+using namespace overlay;
+
+namespace {
+    struct ramp_case {
+        const color_ramp& ramp;
+        double threshold1;
+        double threshold2;
+    };
+    const ramp_case all_ramps[] = {
+        {ramps::button_kps, 2.0, 4.0},     {ramps::kps_now, 6.0, 13.0},         {ramps::key_down, 0.01, 0.03},
+        {ramps::key_up, 0.05, 0.25},       {ramps::graph_ceiling, 60.0, 120.0},
+    };
+    constexpr color from(0.f, 0.f, 0.f, 0.f);
+    constexpr color to(1.f, 1.f, 1.f, 1.f);
+
+    // Evaluated at compile time.
+    static_assert(ramps::button_kps.ratio(0.0) == 0);
+    static_assert(ramps::button_kps.ratio(2.0) == 0);
+    static_assert(ramps::button_kps.ratio(1e9) == 1);
+    static_assert(ramps::key_up.ratio(0.25) > 0.79f && ramps::key_up.ratio(0.25) < 0.81f); // 阈值 2 处为 0.8。
+} // namespace
+
+TEST(TestColorRamp, test_ratio_matches_interpolate) {
+    for (const auto& c : all_ramps) {
+        const double span = c.threshold2 - c.threshold1;
+        for (int i = 0; i <= 20000; i++) {
+            const double crt = c.threshold1 + span * (i / 1000.0 - 2); // 从阈值 1 之前到远超阈值 2。
+            const double exact = interpolate(from, to, std::max(crt, 0.0), c.threshold1, c.threshold2).r;
+            EXPECT_NEAR(c.ramp.ratio(crt), exact, 2e-4) << "crt = " << crt;
+        }
+    }
+}
+
+TEST(TestColorRamp, test_quantized_colors_match_interpolate) {
+    const color a(203u, 237u, 238u, 191u);
+    const color b(255u, 104u, 143u, 0u);
+    for (const auto& c : all_ramps) {
+        const double span = c.threshold2 - c.threshold1;
+        for (int i = 0; i <= 4000; i++) {
+            const double crt = c.threshold1 + span * (i / 1000.0 - 1);
+            const auto expected = interpolate(a, b, std::max(crt, 0.0), c.threshold1, c.threshold2).quantized();
+            const auto actual = c.ramp(a, b, crt).quantized();
+            // Rounding to 8 bits may differ by one step near a boundary.
+            EXPECT_NEAR(actual.r, expected.r, 1.5f / 255);
+            EXPECT_NEAR(actual.g, expected.g, 1.5f / 255);
+            EXPECT_NEAR(actual.b, expected.b, 1.5f / 255);
+            EXPECT_NEAR(actual.a, expected.a, 1.5f / 255);
+        }
+    }
+}
+
+TEST(TestColorRamp, test_invalid_thresholds) {
+    EXPECT_THROW(color_ramp(-1.0, 1.0), std::invalid_argument);
+    EXPECT_THROW(color_ramp(2.0, 1.0), std::invalid_argument);
+    EXPECT_THROW(color_ramp(1.0, 1.0), std::invalid_argument);
+}
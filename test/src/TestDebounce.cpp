@@ -0,0 +1,184 @@
+/**
+ * @file TestDebounce.cpp
+ * @author UnnamedOrange
+ * @brief Test `kps::debounce_filter` in eager and deferred modes.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <debounce.hpp>
+
+using namespace kps;
+using namespace std::chrono_literals;
+
+namespace {
+    const time_point t0 = clock::now();
+
+    key_event ev(int key, bool down, clock::duration offset) {
+        return {key, down, 0, t0 + offset};
+    }
+    /// <summary>
+    /// 将一批事件送入过滤器。
+    /// </summary>
+    std::vector<key_event> batch(debounce_filter& filter, const std::vector<key_event>& in) {
+        std::vector<key_event> out(2 * in.size());
+        out.resize(filter.process(in, out));
+        return out;
+    }
+    /// <summary>
+    /// 将事件逐个送入过滤器，模拟监视器的回调。
+    /// </summary>
+    std::vector<key_event> one_by_one(debounce_filter& filter, const std::vector<key_event>& in) {
+        std::vector<key_event> out;
+        for (const auto& e : in) {
+            std::array<key_event, 2> buffer;
+            const size_t n = filter.process({&e, 1}, buffer);
+            out.insert(out.end(), buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(n));
+        }
+        return out;
+    }
+    std::vector<key_event> flush(debounce_filter& filter, clock::duration offset) {
+        std::vector<key_event> out(debounce_filter::key_count);
+        out.resize(filter.flush(t0 + offset, out));
+        return out;
+    }
+    void expect_events(const std::vector<key_event>& actual, const std::vector<key_event>& expected) {
+        ASSERT_EQ(actual.size(), expected.size());
+        for (size_t i = 0; i < actual.size(); i++) {
+            EXPECT_EQ(actual[i].key, expected[i].key) << i;
+            EXPECT_EQ(actual[i].down, expected[i].down) << i;
+            EXPECT_EQ(actual[i].time, expected[i].time) << i;
+        }
+    }
+} // namespace
+
+TEST(TestDebounce, test_off) {
+    debounce_filter filter;
+    filter.set_interval(10ms);
+    const std::vector<key_event> in{ev(68, true, 0ms), ev(68, false, 1ms), ev(68, true, 2ms)};
+    expect_events(batch(filter, in), in);
+    EXPECT_EQ(filter.suppressed_count(), 0u);
+}
+
+TEST(TestDebounce, test_eager) {
+    debounce_filter filter;
+    filter.set_mode(debounce_mode::eager);
+    filter.set_interval(5ms);
+    filter.set_interval(70, 0ms); // 该键不过滤。
+
+    // 按下时抖动一次，之后正常放开。
+    const std::vector<key_event> bounce{ev(68, true, 0ms), ev(68, false, 1ms), ev(68, true, 2ms),
+                                        ev(68, false, 80ms), ev(70, true, 81ms), ev(70, false, 82ms)};
+    expect_events(batch(filter, bounce),
+                  {ev(68, true, 0ms), ev(68, false, 80ms), ev(70, true, 81ms), ev(70, false, 82ms)});
+    EXPECT_EQ(filter.suppressed_count(), 2u);
+
+    // 比最小间隔还短的一次点按：放开被忽略，在最小间隔结束时由 flush 补上。
+    expect_events(one_by_one(filter, {ev(68, true, 200ms), ev(68, false, 203ms)}), {ev(68, true, 200ms)});
+    EXPECT_EQ(filter.suppressed_count(), 3u);
+    EXPECT_TRUE(flush(filter, 204ms).empty());
+    expect_events(flush(filter, 205ms), {ev(68, false, 203ms)});
+    expect_events(one_by_one(filter, {ev(68, true, 300ms)}), {ev(68, true, 300ms)});
+
+    // 未调用 flush 时，在该键的下一个事件前补上。补上的边沿不早于已转发的其他按键的事件。
+    expect_events(one_by_one(filter, {ev(68, false, 400ms), ev(68, true, 401ms), ev(70, true, 403ms),
+                                      ev(68, false, 500ms)}),
+                  {ev(68, false, 400ms), ev(70, true, 403ms), ev(68, true, 403ms), ev(68, false, 500ms)});
+    EXPECT_TRUE(flush(filter, 1s).empty());
+}
+
+TEST(TestDebounce, test_deferred) {
+    debounce_filter filter;
+    filter.set_mode(debounce_mode::deferred);
+    filter.set_interval(5ms);
+
+    // 按下时抖动：最初的按下与抖动的放开相互抵消，第二次按下稳定后才转发。
+    EXPECT_TRUE(one_by_one(filter, {ev(68, true, 0ms), ev(68, false, 1ms), ev(68, true, 2ms)}).empty());
+    EXPECT_EQ(filter.suppressed_count(), 2u);
+    EXPECT_TRUE(flush(filter, 6ms).empty()); // 尚未稳定。
+    expect_events(flush(filter, 7ms), {ev(68, true, 2ms)});
+
+    // 放开在下一个事件到来时转发。
+    expect_events(batch(filter, {ev(68, false, 80ms), ev(68, true, 200ms)}), {ev(68, false, 80ms)});
+    expect_events(flush(filter, 300ms), {ev(68, true, 200ms)});
+
+    // 切换模式会清空待定的边沿。
+    batch(filter, {ev(68, false, 400ms)});
+    filter.set_mode(debounce_mode::deferred);
+    EXPECT_TRUE(flush(filter, 1s).empty());
+
+    std::array<key_event, 1> small;
+    EXPECT_THROW(filter.flush(t0, small), std::invalid_argument);
+}
+
+TEST(TestDebounce, test_deferred_keeps_time_order) {
+    debounce_filter filter;
+    filter.set_mode(debounce_mode::deferred);
+    filter.set_interval(0ms);
+    filter.set_interval(68, 20ms);
+
+    // 70 的边沿先稳定，但要等更早的 68 的待定边沿确定后才转发。
+    EXPECT_TRUE(one_by_one(filter, {ev(68, true, 0ms), ev(70, true, 5ms), ev(70, false, 6ms)}).empty());
+    EXPECT_TRUE(flush(filter, 10ms).empty());
+    expect_events(flush(filter, 20ms), {ev(68, true, 0ms), ev(70, true, 5ms), ev(70, false, 6ms)});
+
+    // 被抵消的待定边沿不阻塞之后的边沿。
+    EXPECT_TRUE(one_by_one(filter, {ev(68, false, 30ms), ev(68, true, 31ms), ev(70, true, 32ms)}).empty());
+    expect_events(flush(filter, 32ms), {ev(70, true, 32ms)});
+    EXPECT_EQ(filter.suppressed_count(), 2u);
+}
+
+TEST(TestDebounce, test_deferred_full_queue) {
+    debounce_filter filter;
+    filter.set_mode(debounce_mode::deferred);
+    filter.set_interval(0ms);
+    filter.set_interval(68, 1s);
+
+    // 68 的待定边沿阻塞队列，70 的边沿在其后积压，直到写满队列。
+    // 此时提前转发 68 的边沿以腾出位置，不丢弃任何边沿，也不打乱顺序。
+    std::vector<key_event> in{ev(68, true, 0ms)};
+    for (size_t i = 0; i < debounce_filter::queue_capacity; i++)
+        in.push_back(ev(70, i % 2 == 0, 1ms + std::chrono::microseconds(i)));
+    auto out = one_by_one(filter, in);
+    ASSERT_FALSE(out.empty());
+    EXPECT_EQ(out.front().key, 68);
+    for (auto crt = flush(filter, 2s); !crt.empty(); crt = flush(filter, 2s))
+        out.insert(out.end(), crt.begin(), crt.end());
+    expect_events(out, in);
+    EXPECT_EQ(filter.suppressed_count(), 0u);
+}
+
+TEST(TestDebounce, test_next_deadline) {
+    debounce_filter filter;
+    filter.set_interval(5ms);
+    batch(filter, {ev(68, true, 0ms)});
+    EXPECT_FALSE(filter.next_deadline()); // off 模式不推迟任何边沿。
+
+    // eager：被忽略的边沿在上一个转发的边沿的最小间隔结束时转发。
+    filter.set_mode(debounce_mode::eager);
+    batch(filter, {ev(68, true, 10ms), ev(68, false, 12ms)});
+    EXPECT_EQ(filter.next_deadline(), t0 + 15ms);
+    flush(filter, 15ms);
+    EXPECT_FALSE(filter.next_deadline());
+
+    // deferred：待定边沿在保持最小间隔后转发，取各按键中最早的一个。
+    filter.set_mode(debounce_mode::deferred);
+    filter.set_interval(70, 2ms);
+    batch(filter, {ev(68, true, 20ms), ev(70, true, 21ms)});
+    EXPECT_EQ(filter.next_deadline(), t0 + 23ms);
+    flush(filter, 23ms);
+    EXPECT_EQ(filter.next_deadline(), t0 + 25ms);
+    flush(filter, 25ms);
+    EXPECT_FALSE(filter.next_deadline());
+}
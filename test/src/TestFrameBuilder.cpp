@@ -0,0 +1,92 @@
+/**
+ * @file TestFrameBuilder.cpp
+ * @author UnnamedOrange
+ * @brief Test `overlay::frame_builder` and `overlay::display_list`.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <variant>
+
+#include <gtest/gtest.h>
+
+#include <overlay/frame_builder.hpp>
+
+#include "SampleFrame.hpp"
+
+using namespace overlay;
+using orange::test::sample_frame;
+
+namespace {
+    template <typename T>
+    size_t count_of(const display_list& list) {
+        size_t ret = 0;
+        for (const auto& cmd : list.commands())
+            ret += std::holds_alternative<T>(cmd);
+        return ret;
+    }
+} // namespace
+
+TEST(TestFrameBuilder, test_deterministic) {
+    sample_frame sample(1.5);
+    frame_builder builder;
+    display_list a, b;
+    builder.build(sample.input, a);
+    builder.build(sample.input, b);
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a.to_string(), b.to_string());
+
+    sample.columns[1].down = true;
+    sample.columns[1].since_down = 0.02;
+    builder.build(sample.input, b);
+    EXPECT_NE(a, b);
+    EXPECT_NE(a.to_string(), b.to_string());
+}
+TEST(TestFrameBuilder, test_commands) {
+    sample_frame sample(1.5);
+    frame_builder builder;
+    display_list list;
+    builder.build(sample.input, list);
+
+    ASSERT_FALSE(list.commands().empty());
+    EXPECT_TRUE(std::holds_alternative<command::clear>(list.commands().front()));
+    // Only the pressed column and the one still fading out glow; every column has its outline.
+    EXPECT_EQ(count_of<command::fill_rounded_rect>(list), 2u);
+    EXPECT_EQ(count_of<command::stroke_rounded_rect>(list), 4u);
+    // Label and number per column, five statistics texts and two graph captions.
+    EXPECT_EQ(count_of<command::text>(list), 4u * 2 + 5 + 2);
+    EXPECT_EQ(count_of<command::fill_polygon>(list), 1u);
+    EXPECT_EQ(count_of<command::stroke_rect>(list), 1u);
+
+    for (const auto& cmd : list.commands()) {
+        if (const auto* polygon = std::get_if<command::fill_polygon>(&cmd)) {
+            EXPECT_EQ(list.points(*polygon).size(), sample.history.size() + 3);
+        }
+        if (const auto* text = std::get_if<command::text>(&cmd)) {
+            if (text->style == text_style::graph && text->align == text_align::trailing) {
+                EXPECT_EQ(list.text(*text), L"(4 keys)");
+            }
+        }
+    }
+}
+TEST(TestFrameBuilder, test_hidden_blocks) {
+    sample_frame sample(1.5);
+    sample.input.show_buttons = false;
+    sample.input.show_graph = false;
+    frame_builder builder;
+    display_list list;
+    builder.build(sample.input, list);
+    EXPECT_EQ(count_of<command::stroke_rounded_rect>(list), 0u);
+    EXPECT_EQ(count_of<command::fill_polygon>(list), 0u);
+    EXPECT_EQ(count_of<command::text>(list), 5u);
+
+    // Statistics move to the top when the buttons are hidden.
+    for (const auto& cmd : list.commands()) {
+        if (const auto* text = std::get_if<command::text>(&cmd)) {
+            EXPECT_LT(text->box.top, 20 * 1.5);
+        }
+    }
+}
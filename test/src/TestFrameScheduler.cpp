@@ -0,0 +1,89 @@
+/**
+ * @file TestFrameScheduler.cpp
+ * @author UnnamedOrange
+ * @brief Test `overlay::frame_scheduler` with frames from `overlay::frame_builder`.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <gtest/gtest.h>
+
+#include <overlay/frame_builder.hpp>
+#include <overlay/frame_scheduler.hpp>
+
+#include "SampleFrame.hpp"
+
+using namespace overlay;
+
+namespace {
+    struct idle_overlay : orange::test::sample_frame {
+        frame_builder builder;
+
+        idle_overlay() {
+            idle();
+        }
+        /// Advance every fade phase by `dt` seconds.
+        void advance(double dt) {
+            for (auto& col : columns) {
+                col.since_down += dt;
+                col.since_up += dt;
+            }
+        }
+        /// Returns whether the frame was rendered.
+        bool tick(frame_scheduler& scheduler, display_list& next) {
+            builder.build(input, next);
+            if (!scheduler.should_render(next))
+                return false;
+            scheduler.present(next);
+            return true;
+        }
+    };
+} // namespace
+
+TEST(TestFrameScheduler, test_idle_frames_are_skipped) {
+    idle_overlay overlay;
+    metrics::registry reg;
+    frame_scheduler scheduler(reg);
+    display_list next;
+    EXPECT_TRUE(overlay.tick(scheduler, next)); // The first frame is always rendered.
+    for (int i = 0; i < 144; i++) {
+        overlay.advance(1.0 / 144);
+        EXPECT_FALSE(overlay.tick(scheduler, next));
+    }
+    EXPECT_EQ(scheduler.rendered_count(), 1u);
+    EXPECT_EQ(scheduler.skipped_count(), 144u);
+
+    scheduler.invalidate();
+    EXPECT_TRUE(overlay.tick(scheduler, next));
+}
+TEST(TestFrameScheduler, test_keypress_and_fade_out) {
+    idle_overlay overlay;
+    frame_scheduler scheduler;
+    display_list next;
+    overlay.tick(scheduler, next);
+
+    // A keypress is rendered on the very next tick.
+    overlay.columns[0].down = true;
+    overlay.columns[0].since_down = 0;
+    overlay.columns[0].kps = 1;
+    EXPECT_TRUE(overlay.tick(scheduler, next));
+
+    // After release the glow fades out, then rendering stops completely.
+    overlay.columns[0].down = false;
+    overlay.columns[0].since_up = 0;
+    int rendered = 0, trailing_skipped = 0;
+    for (int i = 0; i < 2 * 144; i++) {
+        overlay.advance(1.0 / 144);
+        if (overlay.tick(scheduler, next)) {
+            rendered++;
+            trailing_skipped = 0;
+        } else
+            trailing_skipped++;
+    }
+    EXPECT_GT(rendered, 10);
+    EXPECT_LT(rendered, 144); // The fade lasts well under a second.
+    EXPECT_GT(trailing_skipped, 144);
+}
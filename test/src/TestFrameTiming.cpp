@@ -0,0 +1,82 @@
+/**
+ * @file TestFrameTiming.cpp
+ * @author UnnamedOrange
+ * @brief Test `overlay::frame_timing`.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <chrono>
+#include <string>
+#include <variant>
+
+#include <gtest/gtest.h>
+
+#include <overlay/frame_timing.hpp>
+
+using namespace overlay;
+using namespace std::chrono_literals;
+
+TEST(TestFrameTiming, test_summary) {
+    frame_timing timing;
+    for (int i = 1; i <= 100; i++)
+        timing.record(frame_stage::build, std::chrono::microseconds(i));
+    timing.record(frame_stage::replay, -5us); // 时钟回退时记为 0。
+
+    auto build = timing.summary(frame_stage::build);
+    EXPECT_EQ(build.count, 100u);
+    EXPECT_DOUBLE_EQ(build.mean, 50.5);
+    EXPECT_NEAR(build.p50, 50, 50.0 / 16);
+    EXPECT_NEAR(build.p99, 99, 99.0 / 16);
+    EXPECT_EQ(build.max, 100);
+
+    auto replay = timing.summary(frame_stage::replay);
+    EXPECT_EQ(replay.count, 1u);
+    EXPECT_EQ(replay.max, 0);
+    EXPECT_EQ(timing.summary(frame_stage::snapshot).count, 0u);
+
+    timing.clear();
+    EXPECT_EQ(timing.summary(frame_stage::build).count, 0u);
+    EXPECT_EQ(timing.summary(frame_stage::build).max, 0);
+}
+
+TEST(TestFrameTiming, test_report_and_panel) {
+    frame_timing timing;
+    timing.record(frame_stage::end_draw, 1234us);
+
+    auto report = timing.report();
+    for (auto name : frame_timing::stage_names)
+        EXPECT_NE(report.find(name), std::wstring::npos);
+    EXPECT_NE(report.find(L"1234"), std::wstring::npos);
+
+    display_list list;
+    timing.append_panel(list, {0, 0, 150, 112});
+    size_t texts = 0;
+    bool found = false;
+    for (const auto& cmd : list.commands())
+        if (auto text = std::get_if<command::text>(&cmd)) {
+            texts++;
+            found |= list.text(*text) == L"end_draw";
+        }
+    EXPECT_EQ(texts, 1 + 2 * frame_stage_count);
+    EXPECT_TRUE(found);
+}
+
+TEST(TestFrameTiming, test_scoped_timer) {
+    frame_timing timing;
+    {
+        scoped_stage_timer timer(timing, frame_stage::schedule);
+    }
+    EXPECT_EQ(timing.summary(frame_stage::schedule).count, 1u);
+
+    {
+        OVERLAY_TIME_STAGE(timing, frame_stage::frame);
+        OVERLAY_TIME_STAGE(timing, frame_stage::build);
+    }
+    const std::uint64_t expected = OSU_KPS_FRAME_TIMING ? 1 : 0;
+    EXPECT_EQ(timing.summary(frame_stage::frame).count, expected);
+    EXPECT_EQ(timing.summary(frame_stage::build).count, expected);
+}
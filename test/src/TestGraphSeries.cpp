@@ -0,0 +1,134 @@
+/**
+ * @file TestGraphSeries.cpp
+ * @author UnnamedOrange
+ * @brief Test `overlay::graph_series`.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <overlay/graph_series.hpp>
+
+using namespace overlay;
+
+namespace {
+    std::vector<std::pair<size_t, double>> points_of(const graph_series& series) {
+        std::vector<std::pair<size_t, double>> ret;
+        series.for_each_point([&](size_t i, double v) { ret.emplace_back(i, v); });
+        return ret;
+    }
+    std::vector<double> random_values(size_t n, unsigned seed) {
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<int> dist(0, 30);
+        std::vector<double> ret(n);
+        for (auto& v : ret)
+            v = dist(gen);
+        return ret;
+    }
+} // namespace
+
+TEST(TestGraphSeries, test_keeps_every_point_when_wide_enough) {
+    auto values = random_values(300, 1);
+    graph_series series;
+    series.update(values, 1000, 0, 1000);
+
+    auto points = points_of(series);
+    ASSERT_EQ(points.size(), values.size());
+    for (size_t i = 0; i < points.size(); i++) {
+        EXPECT_EQ(points[i].first, i);
+        EXPECT_EQ(points[i].second, values[i]);
+    }
+    EXPECT_EQ(series.max(), *std::max_element(values.begin(), values.end()));
+}
+
+TEST(TestGraphSeries, test_decimation_keeps_envelope) {
+    auto values = random_values(30000, 2);
+    const size_t columns = 216;
+    graph_series series;
+    series.update(values, -12345, 0, columns);
+
+    auto points = points_of(series);
+    EXPECT_LE(points.size(), 2 * (columns + 2));
+    for (size_t i = 1; i < points.size(); i++)
+        EXPECT_LT(points[i - 1].first, points[i].first);
+
+    // 每桶的最小值和最大值都被保留。
+    const auto per_bucket = static_cast<size_t>(series.seconds_per_bucket());
+    size_t p = 0;
+    for (long long id = -12345 / static_cast<long long>(per_bucket) - 1; p < points.size(); id++) {
+        const long long begin = std::max(0LL, id * static_cast<long long>(per_bucket) + 12345);
+        const long long end =
+            std::min(static_cast<long long>(values.size()), (id + 1) * static_cast<long long>(per_bucket) + 12345);
+        if (end <= begin)
+            continue;
+        auto [lo, hi] = std::minmax_element(values.begin() + begin, values.begin() + end);
+        double seen_lo = 1e9;
+        double seen_hi = -1e9;
+        for (; p < points.size() && static_cast<long long>(points[p].first) < end; p++) {
+            seen_lo = std::min(seen_lo, points[p].second);
+            seen_hi = std::max(seen_hi, points[p].second);
+        }
+        EXPECT_EQ(seen_lo, *lo);
+        EXPECT_EQ(seen_hi, *hi);
+    }
+    EXPECT_EQ(series.max(), *std::max_element(values.begin(), values.end()));
+}
+
+TEST(TestGraphSeries, test_incremental_matches_full_rebuild) {
+    for (size_t n : {300u, 3000u}) {
+        auto stream = random_values(n + 2000, 3);
+        std::mt19937 gen(4);
+        std::uniform_int_distribution<int> step(0, 3);
+
+        graph_series incremental;
+        graph_series full;
+        std::vector<double> window(n);
+        size_t offset = 0;
+        for (int round = 0; round < 500; round++) {
+            const auto shift = static_cast<size_t>(step(gen));
+            offset += shift;
+            // 进入新的一秒时，最后一秒尚未结束，先给出一部分，再给出完整的值。
+            for (double part : {shift ? 0.5 : 1.0, 1.0}) {
+                std::copy_n(stream.begin() + static_cast<std::ptrdiff_t>(offset), n, window.begin());
+                window.back() = static_cast<double>(static_cast<int>(window.back() * part));
+                incremental.update(window, static_cast<long long>(offset), 1, 216);
+                full.update(window, static_cast<long long>(offset), 0, 216);
+                ASSERT_EQ(points_of(incremental), points_of(full));
+                ASSERT_EQ(incremental.max(), full.max());
+                ASSERT_EQ(incremental.max(), *std::max_element(window.begin(), window.end()));
+            }
+        }
+        EXPECT_EQ(incremental.full_count(), 1u);
+        EXPECT_GT(incremental.incremental_count(), 0u);
+    }
+}
+
+TEST(TestGraphSeries, test_rebuilds_on_new_generation_or_decrease) {
+    std::vector<double> values(300, 5.0);
+    graph_series series;
+    series.update(values, 0, 1, 216);
+    series.update(values, 1, 1, 216);
+    EXPECT_EQ(series.full_count(), 1u);
+
+    std::fill(values.begin(), values.end(), 0.0);
+    series.update(values, 1, 2, 216);
+    EXPECT_EQ(series.full_count(), 2u);
+    EXPECT_EQ(series.max(), 0.0);
+
+    values.back() = 3;
+    series.update(values, 1, 2, 216);
+    values.back() = 1; // 同一秒内的值减小，说明数据已被替换。
+    series.update(values, 1, 2, 216);
+    EXPECT_EQ(series.full_count(), 3u);
+    EXPECT_EQ(series.max(), 1.0);
+}
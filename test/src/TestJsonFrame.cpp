@@ -0,0 +1,81 @@
+/**
+ * @file TestJsonFrame.cpp
+ * @author UnnamedOrange
+ * @brief Test `broadcast::json_encoder`.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <broadcast/json_frame.hpp>
+
+using namespace broadcast;
+
+TEST(TestJsonFrame, test_encode) {
+    std::array<double, 4> history{1, 2, 3, 4.5};
+    live_state state;
+    state.button_count = 2;
+    state.columns[0] = {5.0, 12, true};
+    state.columns[1] = {0.25, 3, false};
+    state.total_count = 15;
+    state.max_kps = 12.5;
+    state.kps_now = 5.25;
+    state.history = history;
+    state.history_first_second = 1000;
+    state.history_generation = 1;
+
+    json_encoder encoder;
+    EXPECT_EQ(encoder.encode(state),
+              R"({"seq":1,"autoplay":false,"total":15,"max":12.5,"kps":5.25,)"
+              R"("columns":[{"kps":5,"times":12,"down":true},{"kps":0.25,"times":3,"down":false}],)"
+              R"("history":{"first":1000,"reset":true,"values":[1,2,3,4.5]}})");
+
+    // 平移 1 秒，只发送最后 2 个值。
+    history = {2, 3, 4.5, 6};
+    state.history_first_second = 1001;
+    state.is_autoplay = true;
+    state.button_count = 0;
+    EXPECT_EQ(encoder.encode(state), R"({"seq":2,"autoplay":true,"total":15,"max":12.5,"kps":5.25,"columns":[],)"
+                                     R"("history":{"first":1001,"reset":false,"values":[4.5,6]}})");
+
+    const std::vector<key_edge> edges{{68, true, 100}, {68, false, 250}};
+    EXPECT_EQ(encoder.with_edges(edges),
+              R"({"seq":2,"autoplay":true,"total":15,"max":12.5,"kps":5.25,"columns":[],)"
+              R"("history":{"first":1001,"reset":false,"values":[4.5,6]},)"
+              R"("edges":[{"key":68,"down":true,"t":100},{"key":68,"down":false,"t":250}]})");
+    EXPECT_EQ(encoder.with_edges({}).substr(encoder.with_edges({}).size() - 12), R"(,"edges":[]})");
+
+    encoder.request_keyframe();
+    EXPECT_NE(encoder.encode(state).find(R"("reset":true,"values":[2,3,4.5,6])"), std::string::npos);
+}
+
+TEST(TestJsonFrame, test_key_edge_queue) {
+    key_edge_queue queue;
+    std::vector<key_edge> out;
+    queue.push({1, true, 0}); // 未启用时不记录。
+    queue.take(out);
+    EXPECT_TRUE(out.empty());
+
+    queue.enable(true);
+    queue.push({1, true, 10});
+    queue.push({1, false, 20});
+    queue.take(out);
+    ASSERT_EQ(out.size(), 2u);
+    EXPECT_EQ(out[1].time_us, 20);
+    EXPECT_FALSE(out[1].down);
+    queue.take(out);
+    EXPECT_TRUE(out.empty());
+
+    for (size_t i = 0; i < key_edge_queue::capacity + 10; i++)
+        queue.push({2, true, 0});
+    queue.take(out);
+    EXPECT_EQ(out.size(), key_edge_queue::capacity);
+}
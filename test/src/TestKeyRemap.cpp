@@ -0,0 +1,61 @@
+/**
+ * @file TestKeyRemap.cpp
+ * @author UnnamedOrange
+ * @brief Test `kps::key_remap_table` and the remap stage built on it.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <key_remap.hpp>
+#include <pipeline/stages.hpp>
+
+using namespace kps;
+
+TEST(TestKeyRemap, test_build) {
+    const key_remap_table identity;
+    EXPECT_EQ(identity[68], 68);
+    EXPECT_EQ(identity[-1], key_remap_table::dropped);
+    EXPECT_EQ(identity[256], key_remap_table::dropped);
+
+    // 模拟扫描码到虚拟键码的转换：只有 0x20 (D) 与 0x21 (F) 有对应的虚拟键码。
+    int calls = 0;
+    const auto table = key_remap_table::build([&calls](int code) {
+        calls++;
+        return code == 0x20 ? 'D' : code == 0x21 ? 'F' : 0;
+    });
+    EXPECT_EQ(calls, 256);
+    EXPECT_EQ(table[0x20], 'D');
+    EXPECT_EQ(table[0x21], 'F');
+    EXPECT_EQ(table[0x22], key_remap_table::dropped);
+    EXPECT_EQ(table[0], key_remap_table::dropped);
+}
+
+TEST(TestKeyRemap, test_osu_keys) {
+    const auto table = key_remap_table::osu_keys();
+    EXPECT_EQ(table.translate_osu_key('D'), 'D');
+    EXPECT_EQ(table.translate_osu_key(0x10000 | 'D'), 'D'); // Keys.Shift | Keys.D。
+    EXPECT_EQ(table.translate_osu_key(0), key_remap_table::dropped);
+    EXPECT_EQ(table.translate_osu_key(0x1FF), key_remap_table::dropped);
+}
+
+TEST(TestKeyRemap, test_remap_stage) {
+    pipeline::remap_stage stage;
+    auto table = key_remap_table::build([](int code) { return code == 'Z' ? 'D' : code; });
+    table.set('X', -1);
+    stage.set_table(table);
+    const std::vector<key_event> in{{'Z', true, 0, {}}, {'X', true, 0, {}}, {'F', false, 0, {}}};
+    std::vector<key_event> out(in.size());
+    ASSERT_EQ(stage.process(in, out), 2u);
+    EXPECT_EQ(out[0].key, 'D');
+    EXPECT_EQ(out[1].key, 'F');
+    EXPECT_FALSE(out[1].down);
+}
@@ -0,0 +1,128 @@
+/**
+ * @file TestKpsCalculator.cpp
+ * @author UnnamedOrange
+ * @brief Test the subscriber registry of `kps::kps_interface` and switching methods of `kps::kps_calculator`.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kps_calculator.hpp>
+#include <metrics/registry.hpp>
+
+using namespace kps;
+
+namespace {
+    /// <summary>
+    /// 可以直接通知按键的计算器。
+    /// </summary>
+    class test_calculator final : public kps_calculator {
+    public:
+        using kps_calculator::kps_calculator;
+        void press(int key) {
+            notify_key_down(key, clock::now());
+        }
+    };
+} // namespace
+
+TEST(TestKpsCalculator, test_multiple_subscribers) {
+    test_calculator calc;
+    const size_t base = calc.callback_count(); // 计算方法本身也是一个订阅者。
+    std::vector<int> a, b;
+    calc.register_callback([&a](int key, time_point) { a.push_back(key); }, 1);
+    calc.register_callback([&b](int key, time_point) { b.push_back(key); }, 2);
+    EXPECT_EQ(calc.callback_count(), base + 2);
+
+    calc.press(68);
+    EXPECT_EQ(a, std::vector{68});
+    EXPECT_EQ(b, std::vector{68});
+
+    EXPECT_FALSE(calc.unregister_callback(3));
+    EXPECT_TRUE(calc.unregister_callback(1));
+    EXPECT_FALSE(calc.unregister_callback(1)); // 已取消注册的 id 不能再次取消注册。
+    calc.press(70);
+    EXPECT_EQ(a, std::vector{68});
+    EXPECT_EQ(b, (std::vector{68, 70}));
+
+    // 相同 id 的回调函数被替换，而不是重复调用。
+    calc.register_callback([&b](int key, time_point) { b.push_back(-key); }, 2);
+    calc.press(72);
+    EXPECT_EQ(b, (std::vector{68, 70, -72}));
+}
+
+TEST(TestKpsCalculator, test_subscribe_during_dispatch) {
+    test_calculator calc;
+    int late = 0;
+    calc.register_callback(
+        [&](int, time_point) {
+            calc.register_callback([&late](int, time_point) { late++; }, 2);
+            calc.unregister_callback(1); // 正在遍历的列表不受影响。
+        },
+        1);
+    calc.press(68);
+    EXPECT_EQ(late, 0); // 注册后的下一次按键开始生效。
+    calc.press(68);
+    calc.press(68);
+    EXPECT_EQ(late, 2);
+}
+
+TEST(TestKpsCalculator, test_change_implement_type_keeps_counts) {
+    test_calculator calc;
+    const size_t base = calc.callback_count();
+    for (int i = 0; i < 3; i++)
+        calc.press(68);
+    EXPECT_DOUBLE_EQ(calc.calc_kps_now(68), 3);
+
+    // 旧的计算方法在析构时取消注册，不会留下多余的订阅者。
+    calc.change_implement_type(kps_implement_type::kps_implement_type_sensitive);
+    calc.change_implement_type(kps_implement_type::kps_implement_type_hard);
+    EXPECT_EQ(calc.callback_count(), base);
+    calc.press(68);
+    EXPECT_DOUBLE_EQ(calc.calc_kps_now(68), 4);
+}
+
+TEST(TestKpsCalculator, test_hot_standby) {
+    test_calculator calc;
+    auto& sensitive_events = metrics::global().counter("osu_kps_calculator_maintenance_events_total", "",
+                                                       R"(method="sensitive")");
+    const auto sensitive_before = sensitive_events.value();
+    const int keys[] = {68};
+    calc.set_max_kps_keys(keys);
+    for (int i = 0; i < 3; i++)
+        calc.press(68);
+    EXPECT_EQ(sensitive_events.value() - sensitive_before, 3u); // 未显示的计算方法同样被维护。
+    const double hard_max = calc.get_max_kps();
+    EXPECT_DOUBLE_EQ(hard_max, 3);
+
+    // 切换只改变显示的计算方法。最大 KPS 属于各计算方法自己。
+    calc.change_implement_type(kps_implement_type::kps_implement_type_sensitive);
+    const double sensitive_max = calc.get_max_kps();
+    calc.change_implement_type(kps_implement_type::kps_implement_type_hard);
+    EXPECT_DOUBLE_EQ(calc.get_max_kps(), hard_max);
+    calc.change_implement_type(kps_implement_type::kps_implement_type_sensitive);
+    EXPECT_DOUBLE_EQ(calc.get_max_kps(), sensitive_max);
+
+    calc.clear_max_kps();
+    calc.change_implement_type(kps_implement_type::kps_implement_type_hard);
+    EXPECT_DOUBLE_EQ(calc.get_max_kps(), 0); // 清空最大 KPS 对所有计算方法生效。
+    EXPECT_DOUBLE_EQ(calc.calc_kps_now(68), 3);
+
+    // 关闭热备后只保留正在显示的计算方法，此后未显示的计算方法不再被维护。
+    const size_t with_standby = calc.callback_count();
+    calc.set_hot_standby(false);
+    EXPECT_EQ(calc.callback_count(), with_standby - 1);
+    const auto sensitive_idle = sensitive_events.value();
+    calc.press(68);
+    EXPECT_EQ(sensitive_events.value(), sensitive_idle);
+    calc.set_hot_standby(true);
+    EXPECT_EQ(calc.callback_count(), with_standby);
+    calc.change_implement_type(kps_implement_type::kps_implement_type_sensitive);
+    calc.change_implement_type(kps_implement_type::kps_implement_type_hard);
+    EXPECT_DOUBLE_EQ(calc.calc_kps_now(68), 4);
+}
@@ -0,0 +1,115 @@
+/**
+ * @file TestKpsDigest.cpp
+ * @author UnnamedOrange
+ * @brief Test `kps_digest`.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <kps_digest.hpp>
+
+using namespace kps;
+
+namespace {
+    double exact_quantile(std::vector<double> values, double q) {
+        std::sort(values.begin(), values.end());
+        auto idx = static_cast<size_t>(q * static_cast<double>(values.size() - 1));
+        return values[idx];
+    }
+} // namespace
+
+TEST(TestKpsDigest, test_empty) {
+    kps_digest digest;
+    EXPECT_EQ(digest.quantile(0.5), 0.0);
+    digest.add(7);
+    EXPECT_EQ(digest.quantile(0.01), 7.0);
+    EXPECT_EQ(digest.quantile(0.99), 7.0);
+}
+TEST(TestKpsDigest, test_quantile) {
+    kps_digest digest;
+    std::vector<double> values;
+    std::mt19937 rng(1919810);
+    std::gamma_distribution<double> dist(4, 2.5);
+    for (int i = 0; i < 200000; i++) {
+        double v = dist(rng);
+        values.push_back(v);
+        digest.add(v);
+    }
+    EXPECT_LE(digest.centroids().size(), kps_digest::capacity);
+    EXPECT_EQ(digest.count(), 200000.0);
+    for (double q : {0.5, 0.95, 0.99}) {
+        double exact = exact_quantile(values, q);
+        EXPECT_NEAR(digest.quantile(q), exact, 0.01 * exact) << "q = " << q;
+    }
+    EXPECT_EQ(digest.quantile(0), *std::min_element(values.begin(), values.end()));
+    EXPECT_EQ(digest.quantile(1), *std::max_element(values.begin(), values.end()));
+}
+TEST(TestKpsDigest, test_merge) {
+    kps_digest a, b, all;
+    std::vector<double> values;
+    std::mt19937 rng(114514);
+    std::uniform_real_distribution<double> low(0, 10), high(5, 30);
+    for (int i = 0; i < 50000; i++) {
+        double x = low(rng), y = high(rng);
+        a.add(x);
+        b.add(y);
+        values.push_back(x);
+        values.push_back(y);
+    }
+    a.merge(b);
+    EXPECT_EQ(a.count(), 100000.0);
+    for (double q : {0.5, 0.95, 0.99})
+        EXPECT_NEAR(a.quantile(q), exact_quantile(values, q), 0.1) << "q = " << q;
+
+    // Rebuild from exported centroids.
+    kps_digest restored;
+    for (const auto& c : a.centroids())
+        restored.add(c.mean, c.weight);
+    for (double q : {0.5, 0.95, 0.99})
+        EXPECT_NEAR(restored.quantile(q), a.quantile(q), 0.1) << "q = " << q;
+}
+TEST(TestKpsDigest, test_merge_self) {
+    kps_digest digest;
+    for (int i = 1; i <= 1000; i++)
+        digest.add(i % 20);
+    const double median = digest.quantile(0.5);
+    digest.add(5); // Leave a sample in the buffer.
+    digest.merge(digest);
+    EXPECT_EQ(digest.count(), 2002.0);
+    EXPECT_NEAR(digest.quantile(0.5), median, 0.5);
+    EXPECT_EQ(digest.min(), 0);
+    EXPECT_EQ(digest.max(), 19);
+}
+TEST(TestKpsDigest, test_serialize) {
+    kps_digest a;
+    std::mt19937 rng(1919);
+    std::uniform_real_distribution<double> dist(0.5, 25);
+    for (int i = 0; i < 20000; i++)
+        a.add(dist(rng));
+
+    // Another session merges the exported text.
+    kps_digest b;
+    b.add(100);
+    ASSERT_TRUE(b.merge_serialized(a.serialize()));
+    EXPECT_EQ(b.count(), a.count() + 1);
+    EXPECT_EQ(b.min(), a.min());
+    EXPECT_EQ(b.max(), 100);
+    EXPECT_NEAR(b.quantile(0.5), a.quantile(0.5), 0.1);
+
+    kps_digest empty;
+    EXPECT_EQ(empty.serialize(), "");
+    EXPECT_TRUE(b.merge_serialized(""));
+    EXPECT_FALSE(b.merge_serialized("1,2\n3\n"));
+    EXPECT_FALSE(b.merge_serialized("1,2\n3,-1\n"));
+    EXPECT_FALSE(b.merge_serialized("1,2\n"));
+    EXPECT_EQ(b.count(), a.count() + 1); // Malformed text changes nothing.
+}
@@ -0,0 +1,75 @@
+/**
+ * @file TestMetrics.cpp
+ * @author UnnamedOrange
+ * @brief Test `metrics::sharded_counter` and the Prometheus exposition of `metrics::registry`.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <cstdint>
+#include <format>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <metrics/registry.hpp>
+
+TEST(TestMetrics, test_sharded_counter) {
+    metrics::sharded_counter counter;
+    EXPECT_EQ(counter.value(), 0u);
+    counter.add();
+    counter.add(41);
+    EXPECT_EQ(counter.value(), 42u);
+
+    // 线程多于分片时，共享分片的线程也不会丢失计数。
+    constexpr int thread_count = 2 * static_cast<int>(metrics::shard_count);
+    constexpr int per_thread = 10000;
+    std::vector<std::jthread> threads;
+    for (int i = 0; i < thread_count; i++)
+        threads.emplace_back([&] {
+            for (int j = 0; j < per_thread; j++)
+                counter.add();
+        });
+    threads.clear();
+    EXPECT_EQ(counter.value(), 42u + static_cast<std::uint64_t>(thread_count) * per_thread);
+}
+
+TEST(TestMetrics, test_cache_line_alignment) {
+    // 各分片独占缓存行的前提是计数器本身按缓存行对齐，包括 registry 中分配的计数器。
+    EXPECT_EQ(alignof(metrics::sharded_counter), metrics::cache_line_size);
+    EXPECT_EQ(sizeof(metrics::sharded_counter), metrics::shard_count * metrics::cache_line_size);
+    metrics::registry r;
+    for (int i = 0; i < 4; i++) {
+        const auto& counter = r.counter("osu_kps_events_total", "Key edges.", std::format("index=\"{}\"", i));
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(&counter) % metrics::cache_line_size, 0u);
+    }
+}
+
+TEST(TestMetrics, test_registry) {
+    metrics::registry r;
+    auto& dinput = r.counter("osu_kps_events_total", "Key edges.", R"(monitor="dinput")");
+    auto& frames = r.counter("osu_kps_frames_total", "Frames.");
+    auto& async = r.counter("osu_kps_events_total", "Ignored.", R"(monitor="async")");
+    auto& seconds = r.counter("osu_kps_query_seconds_total", "Query time.", {}, 1e-9);
+    EXPECT_EQ(&r.counter("osu_kps_events_total", "Key edges.", R"(monitor="dinput")"), &dinput);
+    EXPECT_NE(&async, &dinput);
+
+    dinput.add(3);
+    async.add();
+    frames.add(7);
+    seconds.add(1500000000);
+    EXPECT_EQ(r.expose(), "# HELP osu_kps_events_total Key edges.\n"
+                          "# TYPE osu_kps_events_total counter\n"
+                          "osu_kps_events_total{monitor=\"dinput\"} 3\n"
+                          "osu_kps_events_total{monitor=\"async\"} 1\n"
+                          "# HELP osu_kps_frames_total Frames.\n"
+                          "# TYPE osu_kps_frames_total counter\n"
+                          "osu_kps_frames_total 7\n"
+                          "# HELP osu_kps_query_seconds_total Query time.\n"
+                          "# TYPE osu_kps_query_seconds_total counter\n"
+                          "osu_kps_query_seconds_total 1.5\n");
+}
@@ -0,0 +1,110 @@
+/**
+ * @file TestMonitorComparison.cpp
+ * @author UnnamedOrange
+ * @brief Test `kps::monitor_comparison` with fake monitors that inject drops, delays and bounces.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <monitor_comparison.hpp>
+
+using namespace kps;
+using namespace std::chrono_literals;
+
+namespace {
+    /// <summary>
+    /// 按给定的时间报告按键的监视器。
+    /// </summary>
+    class fake_monitor final : public key_monitor_base {
+    public:
+        fake_monitor() : key_monitor_base("fake") {}
+        void press(int key, time_point time) {
+            _on_llkey_down(key, time);
+        }
+        void release(int key, time_point time) {
+            _on_llkey_up(key, time);
+        }
+    };
+} // namespace
+
+TEST(TestMonitorComparison, test_drops_delays_and_duplicates) {
+    auto reference = std::make_shared<fake_monitor>();
+    auto delayed = std::make_shared<fake_monitor>(); // 晚 3 ms，丢失第 5 次按下与放开。
+    auto bouncy = std::make_shared<fake_monitor>();  // 早 1 ms，第 2 次按下时抖动。
+    monitor_comparison comparison({{L"reference", reference}, {L"delayed", delayed}, {L"bouncy", bouncy}});
+    ASSERT_EQ(comparison.source_count(), 3u);
+
+    const auto t0 = clock::now();
+    for (int i = 0; i < 10; i++) {
+        const auto down = t0 + i * 200ms;
+        const auto up = down + 80ms;
+        reference->press(68, down);
+        reference->release(68, up);
+        if (i != 5) {
+            delayed->press(68, down + 3ms);
+            delayed->release(68, up + 3ms);
+        }
+        bouncy->press(68, down - 1ms);
+        if (i == 2) {
+            bouncy->release(68, down + 2ms);
+            bouncy->press(68, down + 4ms);
+        }
+        bouncy->release(68, up - 1ms);
+    }
+
+    // 20 次真实的按下与放开，加上 bouncy 多出的放开。
+    auto report = comparison.report(20ms);
+    EXPECT_EQ(report.aligned_events, 21u);
+    ASSERT_EQ(report.sources.size(), 3u);
+
+    const auto& r = report.sources[0];
+    EXPECT_EQ(r.events, 20u);
+    EXPECT_EQ(r.missed, 1u); // bouncy 多出的放开。
+    EXPECT_EQ(r.duplicates, 0u);
+
+    const auto& d = report.sources[1];
+    EXPECT_EQ(d.events, 18u);
+    EXPECT_EQ(d.matched, 18u);
+    EXPECT_EQ(d.missed, 3u);
+    EXPECT_EQ(d.offset_count, 18u);
+    EXPECT_DOUBLE_EQ(d.offset_mean, 3000);
+    EXPECT_DOUBLE_EQ(d.offset_max, 3000);
+
+    const auto& b = report.sources[2];
+    EXPECT_EQ(b.events, 22u);
+    EXPECT_EQ(b.missed, 0u);
+    EXPECT_EQ(b.duplicates, 1u); // 多出的按下与同一次按下对齐。多出的放开离真实的放开太远，单独成为一个事件。
+    EXPECT_DOUBLE_EQ(b.offset_p50, -1000);
+    EXPECT_DOUBLE_EQ(b.offset_min, -1000);
+
+    auto text = report.text();
+    EXPECT_NE(text.find(L"delayed"), std::wstring::npos);
+}
+
+TEST(TestMonitorComparison, test_align_events) {
+    const auto t0 = clock::now();
+    const std::vector<std::wstring> names{L"a", L"b"};
+    const std::vector<recorded_event> events{
+        {0, 1, true, t0},         {1, 1, true, t0 + 5ms},  // 对齐。
+        {1, 1, false, t0 + 9ms},                           // a 漏掉。
+        {0, 2, true, t0 + 1ms},   {1, 2, true, t0 + 60ms}, // 超出窗口，各自成为一个事件。
+        {7, 1, true, t0},                                  // 未知的来源被忽略。
+    };
+    auto report = align_events(events, names, 50ms);
+    EXPECT_EQ(report.aligned_events, 4u);
+    EXPECT_EQ(report.sources[0].missed, 2u);
+    EXPECT_EQ(report.sources[1].missed, 1u);
+    EXPECT_EQ(report.sources[1].offset_count, 1u);
+    EXPECT_DOUBLE_EQ(report.sources[1].offset_mean, 5000);
+}
@@ -0,0 +1,76 @@
+/**
+ * @file TestMonitorLatency.cpp
+ * @author UnnamedOrange
+ * @brief Test `kps::monitor_latency` with synthetic events and polls.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <chrono>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <monitor_latency.hpp>
+
+using namespace kps;
+using namespace std::chrono_literals;
+
+namespace {
+    constexpr size_t async_source = 0;
+    constexpr size_t hook_source = 1;
+    constexpr size_t dinput_source = 2;
+} // namespace
+
+TEST(TestMonitorLatency, test_event_latency) {
+    monitor_latency latency;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 1; i <= 100; i++)
+        latency.record_event(hook_source, t0, t0 + std::chrono::microseconds(i));
+    latency.record_event(async_source, t0, t0 - 3us); // 时钟回退时记为 0。
+    latency.record_event(monitor_latency::source_count, t0, t0 + 1s); // 未知的来源被忽略。
+
+    auto hook = latency.summary(hook_source, monitor_latency::metric::latency);
+    EXPECT_EQ(hook.count, 100u);
+    EXPECT_DOUBLE_EQ(hook.mean, 50.5);
+    EXPECT_NEAR(hook.p50, 50, 50.0 / 16);
+    EXPECT_NEAR(hook.p99, 99, 99.0 / 16);
+    EXPECT_EQ(hook.max, 100);
+    EXPECT_EQ(latency.summary(async_source, monitor_latency::metric::latency).max, 0);
+    EXPECT_EQ(latency.summary(dinput_source, monitor_latency::metric::latency).count, 0u);
+    EXPECT_EQ(latency.summary(hook_source, monitor_latency::metric::interval).count, 0u);
+}
+
+TEST(TestMonitorLatency, test_poll_jitter) {
+    monitor_latency latency;
+    // 间隔依次为 10、12、10、10 毫秒，抖动为 2、2、0 毫秒。
+    auto t = std::chrono::steady_clock::now();
+    latency.record_poll(dinput_source, t);
+    for (auto interval : {10ms, 12ms, 10ms, 10ms}) {
+        t += interval;
+        latency.record_poll(dinput_source, t);
+    }
+
+    auto interval = latency.summary(dinput_source, monitor_latency::metric::interval);
+    EXPECT_EQ(interval.count, 4u);
+    EXPECT_DOUBLE_EQ(interval.mean, 10500);
+    EXPECT_EQ(interval.max, 12000);
+    auto jitter = latency.summary(dinput_source, monitor_latency::metric::jitter);
+    EXPECT_EQ(jitter.count, 3u);
+    EXPECT_NEAR(jitter.mean, 4000.0 / 3, 1);
+    EXPECT_EQ(jitter.max, 2000);
+
+    auto report = latency.report();
+    EXPECT_NE(report.find(L"dinput interval"), std::wstring::npos);
+    EXPECT_NE(report.find(L"dinput jitter"), std::wstring::npos);
+    EXPECT_EQ(report.find(L"hook"), std::wstring::npos); // 没有数据的行被省略。
+
+    // 清空后继续以上一次轮询为起点。
+    latency.clear();
+    latency.record_poll(dinput_source, t + 10ms);
+    EXPECT_EQ(latency.summary(dinput_source, monitor_latency::metric::interval).count, 1u);
+    EXPECT_EQ(latency.summary(dinput_source, monitor_latency::metric::jitter).count, 1u);
+}
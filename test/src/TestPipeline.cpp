@@ -0,0 +1,112 @@
+/**
+ * @file TestPipeline.cpp
+ * @author UnnamedOrange
+ * @brief Test `pipeline::event_pipeline` with filter, remap, tag and debounce stages.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <pipeline/event_pipeline.hpp>
+#include <pipeline/stages.hpp>
+
+using namespace pipeline;
+using namespace std::chrono_literals;
+
+namespace {
+    const time_point t0 = clock::now();
+
+    key_event ev(int key, bool down, clock::duration offset) {
+        return {key, down, 0, t0 + offset};
+    }
+} // namespace
+
+TEST(TestPipeline, test_stages_and_sinks) {
+    metrics::registry reg;
+    event_pipeline pipe(2, reg); // 每批最多 2 个，5 个事件被拆为 3 批。
+    auto& filter = pipe.add_transform("filter", std::make_unique<key_filter>());
+    auto& remap = pipe.add_transform("remap", std::make_unique<remap_stage>());
+    pipe.add_transform("tag", std::make_unique<tag_stage>(std::uint8_t{3}));
+    filter.set(65, false);
+    remap.set(68, 90);
+    remap.set(70, -1);
+
+    std::vector<key_event> first, second;
+    size_t batches = 0;
+    pipe.add_sink("first", [&](std::span<const key_event> events) {
+        first.insert(first.end(), events.begin(), events.end());
+        batches++;
+    });
+    pipe.add_sink("second", [&](std::span<const key_event> events) {
+        second.insert(second.end(), events.begin(), events.end());
+    });
+
+    const std::vector<key_event> in{ev(65, true, 0ms), ev(68, true, 1ms), ev(70, true, 2ms), ev(75, false, 3ms),
+                                    ev(68, false, 4ms)};
+    pipe.push(in);
+    ASSERT_EQ(first.size(), 3u);
+    EXPECT_EQ(first[0].key, 90);
+    EXPECT_EQ(first[1].key, 75);
+    EXPECT_EQ(first[2].key, 90);
+    EXPECT_FALSE(first[2].down);
+    EXPECT_EQ(first[2].time, t0 + 4ms);
+    for (const auto& e : first)
+        EXPECT_EQ(e.source, 3);
+    EXPECT_EQ(second.size(), first.size());
+    EXPECT_EQ(batches, 3u);
+
+    const auto report = pipe.report();
+    ASSERT_EQ(report.size(), 5u);
+    EXPECT_EQ(report[0].name, "filter");
+    EXPECT_EQ(report[0].events, 5u);
+    EXPECT_EQ(report[0].batches, 3u);
+    EXPECT_EQ(report[1].events, 4u); // 65 被过滤。
+    EXPECT_EQ(report[2].events, 3u); // 70 被丢弃。
+    EXPECT_EQ(report[3].name, "first");
+    EXPECT_EQ(report[3].events, 3u);
+    pipe.flush(t0); // 计数器在计时的批与 flush 时更新。
+    EXPECT_NE(reg.expose().find("osu_kps_pipeline_stage_events_total{stage=\"remap\"} 4"), std::string::npos);
+}
+
+TEST(TestPipeline, test_flush_passes_through_later_stages) {
+    metrics::registry reg;
+    event_pipeline pipe(1, reg);
+    auto& debounce = pipe.add_transform("debounce", std::make_unique<debounce_stage>());
+    auto& remap = pipe.add_transform("remap", std::make_unique<remap_stage>());
+    pipe.configure([&] {
+        debounce.filter().set_mode(kps::debounce_mode::deferred);
+        debounce.filter().set_interval(5ms);
+        remap.set(68, 90);
+    });
+
+    std::vector<key_event> out;
+    pipe.add_sink("out", [&](std::span<const key_event> events) {
+        out.insert(out.end(), events.begin(), events.end());
+    });
+
+    pipe.push(std::vector{ev(68, true, 0ms), ev(68, false, 1ms), ev(68, true, 2ms)});
+    EXPECT_TRUE(out.empty());
+    pipe.flush(t0 + 10ms);
+    ASSERT_EQ(out.size(), 1u);
+    EXPECT_EQ(out[0].key, 90);
+    EXPECT_EQ(out[0].time, t0 + 2ms);
+
+    // 修改设置前转发待定的边沿。
+    pipe.push(std::vector{ev(68, false, 100ms)});
+    pipe.configure([&] {
+        pipe.flush(time_point::max());
+        debounce.filter().set_mode(kps::debounce_mode::off);
+    });
+    ASSERT_EQ(out.size(), 2u);
+    EXPECT_FALSE(out[1].down);
+}
@@ -0,0 +1,191 @@
+/**
+ * @file TestRenderer.cpp
+ * @author UnnamedOrange
+ * @brief Test resource caching of `overlay::renderer` with a counting device.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include <overlay/frame_builder.hpp>
+#include <overlay/renderer.hpp>
+
+#include "SampleFrame.hpp"
+
+using namespace overlay;
+using orange::test::sample_frame;
+
+namespace {
+    /**
+     * @brief Device that only counts resource creations and draw calls.
+     */
+    struct counting_device {
+        struct brush_t {
+            std::uint32_t rgba{};
+        };
+        struct gradient_t {};
+        struct geometry_t {};
+
+        size_t brushes_created{};
+        size_t gradients_created{};
+        size_t geometries_created{};
+        size_t draw_calls{};
+
+        brush_t create_solid_brush(const color& c) {
+            brushes_created++;
+            return {c.to_rgba8()};
+        }
+        gradient_t create_gradient(const std::array<gradient_stop, 3>&) {
+            gradients_created++;
+            return {};
+        }
+        geometry_t create_geometry(std::span<const point>) {
+            geometries_created++;
+            return {};
+        }
+        size_t resources_created() const {
+            return brushes_created + gradients_created + geometries_created;
+        }
+
+        void clear(const color&) {
+            draw_calls++;
+        }
+        void fill_rounded_rect(const rect&, float, const brush_t&) {
+            draw_calls++;
+        }
+        void stroke_rounded_rect(const rect&, float, float, const brush_t&) {
+            draw_calls++;
+        }
+        void stroke_rect(const rect&, float, const brush_t&) {
+            draw_calls++;
+        }
+        void line(const point&, const point&, float, const brush_t&, bool) {
+            draw_calls++;
+        }
+        void text(const rect&, std::wstring_view, text_style, text_align, const brush_t&) {
+            draw_calls++;
+        }
+        void fill_geometry(const geometry_t&, const gradient_t&, const rect&) {
+            draw_calls++;
+        }
+    };
+} // namespace
+
+TEST(TestRenderer, test_steady_state_creates_nothing) {
+    sample_frame sample;
+    frame_builder builder;
+    display_list list;
+    builder.build(sample.input, list);
+
+    renderer<counting_device> r;
+    r.replay(list);
+    const auto warm = r.device.resources_created();
+    EXPECT_GT(warm, 0u);
+    EXPECT_EQ(r.device.gradients_created, 1u);
+    EXPECT_EQ(r.device.geometries_created, 1u);
+    // Far fewer brushes than colored commands: equal colors share one brush.
+    EXPECT_LT(r.device.brushes_created, list.commands().size() / 2);
+
+    for (int i = 0; i < 100; i++) {
+        builder.build(sample.input, list);
+        r.replay(list);
+    }
+    EXPECT_EQ(r.device.resources_created(), warm);
+}
+TEST(TestRenderer, test_reset_drops_resources) {
+    sample_frame sample;
+    frame_builder builder;
+    display_list list;
+    builder.build(sample.input, list);
+
+    renderer<counting_device> r;
+    r.replay(list);
+    const auto warm = r.device.resources_created();
+    r.reset();
+    EXPECT_EQ(r.palette_size(), 0u);
+    r.replay(list);
+    EXPECT_EQ(r.device.resources_created(), 2 * warm);
+}
+TEST(TestRenderer, test_palette_is_bounded) {
+    renderer<counting_device, 16> r;
+    display_list list;
+    for (unsigned i = 0; i < 100; i++)
+        list.push(command::stroke_rect{{}, 1, color(i, 0u, 0u)});
+    r.replay(list);
+    EXPECT_EQ(r.device.brushes_created, 100u);
+    EXPECT_EQ(r.palette_size(), 16u);
+    EXPECT_EQ(r.brushes_evicted(), 100u - 16);
+
+    // Recently used colors stay cached.
+    display_list recent;
+    for (unsigned i = 90; i < 100; i++)
+        recent.push(command::stroke_rect{{}, 1, color(i, 0u, 0u)});
+    r.replay(recent);
+    EXPECT_EQ(r.device.brushes_created, 100u);
+}
+
+namespace {
+    /**
+     * @brief Counting device that also prepares text layouts.
+     */
+    struct layout_device : counting_device {
+        struct layout_t {
+            std::wstring text;
+        };
+
+        size_t layouts_created{};
+        size_t texts_drawn{};
+
+        layout_t create_text_layout(std::wstring_view str, text_style, text_align, const rect&) {
+            layouts_created++;
+            return {std::wstring(str)};
+        }
+        void draw_text_layout(const layout_t&, const rect&, const brush_t&) {
+            texts_drawn++;
+        }
+        void text(const rect&, std::wstring_view, text_style, text_align, const brush_t&) {
+            ADD_FAILURE() << "Text should be drawn with a prepared layout.";
+        }
+    };
+} // namespace
+
+TEST(TestRenderer, test_text_layouts_are_reused) {
+    static_assert(supports_text_layout<layout_device>);
+    static_assert(!supports_text_layout<counting_device>);
+
+    sample_frame sample;
+    frame_builder builder;
+    display_list list;
+    builder.build(sample.input, list);
+
+    renderer<layout_device> r;
+    r.replay(list);
+    const auto warm = r.device.layouts_created;
+    EXPECT_GT(warm, 0u);
+    EXPECT_EQ(r.text_layouts_created(), warm);
+
+    for (int i = 0; i < 100; i++) {
+        builder.build(sample.input, list);
+        r.replay(list);
+    }
+    EXPECT_EQ(r.device.layouts_created, warm);
+
+    // A new number needs one new layout; the others are reused.
+    sample.input.kps_now = 9;
+    builder.build(sample.input, list);
+    r.replay(list);
+    EXPECT_EQ(r.device.layouts_created, warm + 1);
+
+    r.reset_text_layouts();
+    r.replay(list);
+    EXPECT_EQ(r.device.layouts_created, 2 * warm + 1);
+}
@@ -0,0 +1,111 @@
+/**
+ * @file TestSharedState.cpp
+ * @author UnnamedOrange
+ * @brief Test `broadcast::shared_state_writer` and `broadcast::shared_state_reader` on process-local memory.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include <broadcast/shared_state.hpp>
+
+using namespace broadcast;
+
+namespace {
+    /**
+     * @brief Memory standing in for the file mapping.
+     */
+    struct segment_memory {
+        std::unique_ptr<std::uint64_t[]> words = std::make_unique<std::uint64_t[]>(sizeof(shared_segment) / 8 + 1);
+        void* data() const {
+            return words.get();
+        }
+    };
+} // namespace
+
+TEST(TestSharedState, test_publish_and_read) {
+    segment_memory memory;
+    shared_state_writer writer(memory.data());
+    shared_state_reader reader(memory.data(), sizeof(shared_segment));
+    const auto version = reader.version();
+
+    auto& state = writer.state();
+    state.button_count = 2;
+    state.total_count = 42;
+    state.max_kps = 11.5;
+    state.columns[1].down = 1;
+    state.columns[1].times = 7;
+    state.columns[1].previous_down_us = 1'000'000;
+    writer.publish(2'000'000);
+    EXPECT_NE(reader.version(), version);
+
+    auto snapshot = reader.read();
+    ASSERT_TRUE(snapshot);
+    EXPECT_EQ(snapshot->frame, 1u);
+    EXPECT_EQ(snapshot->time_us, 2'000'000);
+    EXPECT_EQ(snapshot->button_count, 2);
+    EXPECT_EQ(snapshot->total_count, 42);
+    EXPECT_DOUBLE_EQ(snapshot->max_kps, 11.5);
+    EXPECT_EQ(snapshot->columns[1].down, 1);
+    EXPECT_EQ(snapshot->columns[1].times, 7);
+    EXPECT_EQ(snapshot->columns[1].previous_down_us, 1'000'000);
+}
+
+TEST(TestSharedState, test_history_ring) {
+    segment_memory memory;
+    shared_state_writer writer(memory.data());
+    shared_state_reader reader(memory.data(), sizeof(shared_segment));
+
+    std::array<double, shared_history_capacity> history{};
+    for (size_t i = 0; i < history.size(); i++)
+        history[i] = static_cast<double>(i);
+    writer.set_history(history, 1000, 1);
+    writer.publish(0);
+    EXPECT_EQ(reader.read()->history_at(1000), 0.f);
+    EXPECT_EQ(reader.read()->history_at(1299), 299.f);
+    EXPECT_EQ(reader.read()->history_at(1300), 0.f); // 超出范围。
+
+    // 平移 2 秒，只有最后 3 个值可能不同。
+    for (size_t i = 0; i < history.size(); i++)
+        history[i] = static_cast<double>(i + 2);
+    history[299] = 1000;
+    writer.set_history(history, 1002, 1);
+    writer.publish(0);
+    auto snapshot = reader.read();
+    ASSERT_TRUE(snapshot);
+    EXPECT_EQ(snapshot->history_first_second, 1002);
+    EXPECT_EQ(snapshot->history_count, shared_history_capacity);
+    for (long long s = 1002; s < 1301; s++)
+        EXPECT_EQ(snapshot->history_at(s), static_cast<float>(s - 1000));
+    EXPECT_EQ(snapshot->history_at(1301), 1000.f);
+    EXPECT_EQ(snapshot->history_at(1001), 0.f);
+}
+
+TEST(TestSharedState, test_reader_never_blocks) {
+    segment_memory memory;
+    EXPECT_THROW(shared_state_reader(memory.data(), sizeof(shared_segment)), std::runtime_error); // 尚未初始化。
+
+    shared_state_writer writer(memory.data());
+    shared_state_reader reader(memory.data(), sizeof(shared_segment));
+    EXPECT_THROW(shared_state_reader(memory.data(), sizeof(shared_segment) - 1), std::runtime_error);
+    writer.publish(0);
+
+    // 模拟写者在写入过程中退出：序号停留在奇数。序号位于偏移 16 处。
+    std::uint64_t sequence;
+    auto* bytes = static_cast<unsigned char*>(memory.data());
+    std::memcpy(&sequence, bytes + 16, sizeof(sequence));
+    EXPECT_EQ(sequence, reader.version());
+    sequence++;
+    std::memcpy(bytes + 16, &sequence, sizeof(sequence));
+    EXPECT_FALSE(reader.read(16));
+}
@@ -0,0 +1,83 @@
+/**
+ * @file TestSignatureScanner.cpp
+ * @author UnnamedOrange
+ * @brief Test `SignaturePattern` and `scan_regions`.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <utils/SignatureScanner.hpp>
+
+using namespace orange;
+
+static constexpr unsigned char signature[] = {0x7D, 0x15, 0xA1, 0x01, 0x02, 0x03, 0x04, 0x85, 0xC0};
+
+static std::vector<std::byte> random_bytes(std::size_t size) {
+    std::vector<std::byte> ret(size);
+    std::mt19937 rng(114514);
+    for (auto& b : ret)
+        b = static_cast<std::byte>(rng() & 0x7F); // Never contains 0x85 or 0xC0.
+    return ret;
+}
+
+TEST(TestSignatureScanner, test_invalid_pattern) {
+    EXPECT_THROW(SignaturePattern(""), std::invalid_argument);
+    EXPECT_THROW(SignaturePattern("7D 1"), std::invalid_argument);
+    EXPECT_THROW(SignaturePattern("7D XY"), std::invalid_argument);
+    EXPECT_EQ(SignaturePattern("7D 15 A1 ?? ?? ?? ?? 85 C0").size(), 9u);
+}
+TEST(TestSignatureScanner, test_every_offset) {
+    const SignaturePattern pattern{"7D 15 A1 ?? ?? ?? ?? 85 C0"};
+    // Cover the SIMD body, the scalar tail and the borders between them.
+    for (std::size_t size : {9, 15, 16, 24, 25, 40, 100}) {
+        for (std::size_t offset = 0; offset + sizeof(signature) <= size; offset++) {
+            auto data = random_bytes(size);
+            std::memcpy(data.data() + offset, signature, sizeof(signature));
+            EXPECT_EQ(pattern.find(data), offset);
+            EXPECT_EQ(pattern.find_naive(data), offset);
+        }
+    }
+}
+TEST(TestSignatureScanner, test_near_miss) {
+    const SignaturePattern pattern{"7D 15 A1 ?? ?? ?? ?? 85 C0"};
+    auto data = random_bytes(256);
+    std::memcpy(data.data() + 17, signature, sizeof(signature));
+    data[17 + 2] = std::byte{0xA2}; // Anchors still match, the middle does not.
+    EXPECT_FALSE(pattern.find(data));
+    EXPECT_FALSE(pattern.find_naive(data));
+    EXPECT_FALSE(pattern.find(std::span(data.data(), 5)));
+}
+TEST(TestSignatureScanner, test_first_match_wins) {
+    const SignaturePattern pattern{"7D 15 A1 ?? ?? ?? ?? 85 C0"};
+    auto data = random_bytes(4096);
+    std::memcpy(data.data() + 3000, signature, sizeof(signature));
+    std::memcpy(data.data() + 700, signature, sizeof(signature));
+    EXPECT_EQ(pattern.find(data), std::size_t{700});
+}
+TEST(TestSignatureScanner, test_scan_regions) {
+    const SignaturePattern pattern{"7D 15 A1 ?? ?? ?? ?? 85 C0"};
+    auto data = random_bytes(1 << 16);
+    // Across a chunk border, and a second match later that must lose.
+    std::memcpy(data.data() + 4096 - 4, signature, sizeof(signature));
+    std::memcpy(data.data() + 50000, signature, sizeof(signature));
+    const SignatureRegion regions[] = {{0, 1 << 15}, {1 << 15, 1 << 15}};
+    auto read = [&](std::uintptr_t address, std::byte* buffer, std::size_t size) {
+        std::memcpy(buffer, data.data() + address, size);
+        return size;
+    };
+    for (unsigned threads : {1u, 4u})
+        EXPECT_EQ(scan_regions(regions, pattern, read, threads, 4096), std::uintptr_t{4096 - 4});
+
+    const SignatureRegion later[] = {{1 << 15, 1 << 15}};
+    EXPECT_EQ(scan_regions(later, pattern, read, 2, 4096), std::uintptr_t{50000});
+}
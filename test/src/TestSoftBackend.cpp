@@ -0,0 +1,197 @@
+/**
+ * @file TestSoftBackend.cpp
+ * @author UnnamedOrange
+ * @brief Test `overlay::soft_device` primitives and compare a whole frame against a golden image.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+
+#include <gtest/gtest.h>
+
+#include <overlay/frame_builder.hpp>
+#include <overlay/freetype_font.hpp>
+#include <overlay/soft_backend.hpp>
+
+#include "SampleFrame.hpp"
+
+using namespace overlay;
+using orange::test::sample_frame;
+
+namespace {
+    const std::filesystem::path repository_root = OSU_KPS_REPOSITORY_ROOT;
+
+    std::array<unsigned, 4> pixel(const rgba_image& image, size_t x, size_t y) {
+        return rgba_image::unpack(image.at(x, y));
+    }
+
+    /**
+     * @brief Bounding box of the pixels whose red channel is non-zero.
+     */
+    rect ink_box(const rgba_image& image) {
+        rect ret{1e9f, 1e9f, -1e9f, -1e9f};
+        for (size_t y = 0; y < image.height(); y++)
+            for (size_t x = 0; x < image.width(); x++)
+                if (pixel(image, x, y)[0]) {
+                    ret.left = std::min(ret.left, static_cast<float>(x));
+                    ret.top = std::min(ret.top, static_cast<float>(y));
+                    ret.right = std::max(ret.right, static_cast<float>(x + 1));
+                    ret.bottom = std::max(ret.bottom, static_cast<float>(y + 1));
+                }
+        return ret;
+    }
+} // namespace
+
+TEST(TestSoftBackend, test_shapes) {
+    rgba_image image(64, 64);
+    soft_backend backend;
+    backend.device.target = &image;
+    display_list list;
+    list.push(command::clear{color(0u, 0u, 0u)});
+    list.push(command::fill_rounded_rect{{8, 8, 40, 40}, 8, color(255u, 0u, 0u)});
+    list.push(command::line{{0, 50.5f}, {64, 50.5f}, 1, color(0u, 255u, 0u), false});
+    list.push(command::line{{0, 60.5f}, {64, 60.5f}, 1, color(0u, 0u, 255u), true});
+    backend.replay(list);
+
+    EXPECT_EQ(pixel(image, 24, 24), (std::array<unsigned, 4>{255, 0, 0, 255}));
+    EXPECT_EQ(pixel(image, 8, 8), (std::array<unsigned, 4>{0, 0, 0, 255})); // 圆角之外。
+    EXPECT_EQ(pixel(image, 20, 8), (std::array<unsigned, 4>{255, 0, 0, 255}));
+    EXPECT_EQ(pixel(image, 20, 7), (std::array<unsigned, 4>{0, 0, 0, 255}));
+    // 圆角上的像素部分覆盖。
+    const auto corner = pixel(image, 10, 10)[0];
+    EXPECT_GT(corner, 0u);
+    EXPECT_LT(corner, 255u);
+
+    EXPECT_EQ(pixel(image, 30, 50), (std::array<unsigned, 4>{0, 255, 0, 255}));
+    EXPECT_EQ(pixel(image, 30, 49), (std::array<unsigned, 4>{0, 0, 0, 255}));
+    // 虚线：线宽 2 倍长的线段，间隔线宽的 2 倍。
+    EXPECT_EQ(pixel(image, 0, 60)[2], 255u);
+    EXPECT_EQ(pixel(image, 2, 60)[2], 0u);
+    EXPECT_EQ(pixel(image, 4, 60)[2], 255u);
+}
+
+TEST(TestSoftBackend, test_axis_aligned_lines) {
+    // 竖直的虚线与转置后的水平虚线相同，反向绘制时虚线从起点开始。
+    const auto brush = color(255u, 255u, 255u);
+    rgba_image horizontal(48, 8), vertical(8, 48), reversed(48, 8);
+    soft_backend backend;
+    display_list list;
+    list.push(command::clear{color(0u, 0u, 0u)});
+    list.push(command::line{{2, 4.25f}, {45.5f, 4.25f}, 0.75f, brush, true});
+    backend.device.target = &horizontal;
+    backend.replay(list);
+    list.clear();
+    list.push(command::clear{color(0u, 0u, 0u)});
+    list.push(command::line{{4.25f, 2}, {4.25f, 45.5f}, 0.75f, brush, true});
+    backend.device.target = &vertical;
+    backend.replay(list);
+    for (size_t y = 0; y < 8; y++)
+        for (size_t x = 0; x < 48; x++)
+            EXPECT_EQ(pixel(horizontal, x, y), pixel(vertical, y, x));
+
+    list.clear();
+    list.push(command::clear{color(0u, 0u, 0u)});
+    list.push(command::line{{45.5f, 4.25f}, {2, 4.25f}, 0.75f, brush, true});
+    backend.device.target = &reversed;
+    backend.replay(list);
+    EXPECT_GT(pixel(reversed, 45, 4)[0], 0u);
+    EXPECT_EQ(pixel(reversed, 43, 4)[0], 0u);
+    EXPECT_GT(pixel(horizontal, 2, 4)[0], 0u);
+    EXPECT_EQ(pixel(horizontal, 4, 4)[0], 0u);
+    // 线外的行不受影响。
+    EXPECT_EQ(pixel(horizontal, 10, 2)[0], 0u);
+    EXPECT_EQ(pixel(horizontal, 10, 6)[0], 0u);
+}
+
+TEST(TestSoftBackend, test_polygon_coverage_and_gradient) {
+    rgba_image image(100, 100);
+    soft_device device;
+    device.target = &image;
+    device.clear(color(0u, 0u, 0u, 0u));
+    // 超出图像左侧的三角形，图像内的部分是两条直角边长为 80 的直角三角形。
+    auto triangle = device.create_geometry(std::array<point, 3>{{{-10, 90}, {80, 90}, {-10, 0}}});
+    auto stops = device.create_gradient({{{0.f, color(255u, 255u, 255u)}, {0.5f, color(255u, 255u, 255u)},
+                                          {1.f, color(255u, 255u, 255u)}}});
+    device.fill_geometry(triangle, stops, {0, 0, 100, 100});
+    double area = 0;
+    for (auto p : image.pixels())
+        area += rgba_image::unpack(p)[3] / 255.0;
+    EXPECT_NEAR(area, 0.5 * 80 * 80, 2);
+
+    // 渐变从底边到顶边。
+    device.clear(color(0u, 0u, 0u, 0u));
+    auto square = device.create_geometry(std::array<point, 4>{{{0, 0}, {100, 0}, {100, 100}, {0, 100}}});
+    auto ramp = device.create_gradient(
+        {{{0.f, color(0u, 0u, 0u)}, {0.5f, color(0u, 0u, 0u)}, {1.f, color(255u, 0u, 0u)}}});
+    device.fill_geometry(square, ramp, {0, 0, 100, 100});
+    EXPECT_EQ(pixel(image, 50, 99)[0], 0u);
+    EXPECT_EQ(pixel(image, 50, 60)[0], 0u);
+    EXPECT_NEAR(pixel(image, 50, 25)[0], 125.0, 2);
+    EXPECT_GE(pixel(image, 50, 0)[0], 250u);
+}
+
+TEST(TestSoftBackend, test_text_alignment) {
+    freetype_font font(repository_root / "resources" / "exo2-regular.otf", 24);
+    rgba_image image(120, 40);
+    soft_device device;
+    device.target = &image;
+    device.fonts[static_cast<size_t>(text_style::key_name)] = &font;
+    auto brush = device.create_solid_brush(color(255u, 255u, 255u));
+
+    const rect box{0, 0, 120, 40};
+    device.clear(color(0u, 0u, 0u));
+    device.text(box, L"D", text_style::key_name, text_align::center, brush);
+    auto ink = ink_box(image);
+    EXPECT_NEAR((ink.left + ink.right) / 2, 60, 2);
+    EXPECT_NEAR((ink.top + ink.bottom) / 2, 20, 3);
+
+    device.clear(color(0u, 0u, 0u));
+    device.text(box, L"D", text_style::key_name, text_align::trailing, brush);
+    EXPECT_NEAR(ink_box(image).right, 120, 4);
+
+    device.clear(color(0u, 0u, 0u));
+    device.text(box, L"D", text_style::key_name, text_align::leading, brush);
+    EXPECT_NEAR(ink_box(image).left, 0, 4);
+}
+
+/**
+ * @brief Render the sample frame without text and compare it against test/golden/soft_frame.ppm.
+ * On mismatch the rendered frame is written to soft_frame.actual.ppm in the working directory;
+ * copy it over the golden image after an intended change.
+ */
+TEST(TestSoftBackend, test_golden_frame) {
+    sample_frame sample;
+    frame_builder builder;
+    display_list list;
+    builder.build(sample.input, list);
+    rgba_image image(232, 184);
+    soft_backend backend;
+    backend.device.target = &image;
+    backend.replay(list);
+
+    const auto golden_path = repository_root / "test" / "golden" / "soft_frame.ppm";
+    auto golden = rgba_image::read_ppm(golden_path);
+    if (!golden || golden->width() != image.width() || golden->height() != image.height())
+        image.write_ppm("soft_frame.actual.ppm");
+    ASSERT_TRUE(golden);
+    ASSERT_EQ(golden->width(), image.width());
+    ASSERT_EQ(golden->height(), image.height());
+    // 允许不同编译器的浮点舍入造成的微小差别。
+    size_t different = 0;
+    for (size_t y = 0; y < image.height(); y++)
+        for (size_t x = 0; x < image.width(); x++) {
+            auto a = pixel(image, x, y);
+            auto b = pixel(*golden, x, y);
+            for (size_t c = 0; c < 3; c++)
+                different += a[c] + 2 < b[c] || b[c] + 2 < a[c];
+        }
+    EXPECT_LE(different, image.pixels().size() / 1000);
+    if (different > image.pixels().size() / 1000)
+        image.write_ppm("soft_frame.actual.ppm");
+}
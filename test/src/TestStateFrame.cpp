@@ -0,0 +1,121 @@
+/**
+ * @file TestStateFrame.cpp
+ * @author UnnamedOrange
+ * @brief Test `broadcast::state_encoder` and `broadcast::state_decoder`.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <broadcast/state_frame.hpp>
+
+using namespace broadcast;
+
+namespace {
+    live_state sample_state(std::span<const double> history, long long first_second) {
+        live_state state;
+        state.button_count = 4;
+        state.columns[0] = {5.0, 12, true};
+        state.columns[1] = {3.5, 7, false};
+        state.columns[3] = {1.0, 1, true};
+        state.is_autoplay = true;
+        state.total_count = 20;
+        state.max_kps = 12.5;
+        state.kps_now = 8.5;
+        state.history = history;
+        state.history_first_second = first_second;
+        state.history_generation = 1;
+        return state;
+    }
+} // namespace
+
+TEST(TestStateFrame, test_round_trip) {
+    std::array<double, 300> history{};
+    for (size_t i = 0; i < history.size(); i++)
+        history[i] = static_cast<double>(i % 17);
+    state_encoder encoder;
+    auto frame = encoder.encode(sample_state(history, 1000));
+    EXPECT_EQ(frame.size(), frame_fixed_size + 8 * 4 + 4 * history.size());
+
+    state_decoder decoder;
+    EXPECT_EQ(decoder.decode(frame.first(frame.size() - 1)), 0u); // 不足一帧。
+    ASSERT_EQ(decoder.decode(frame), frame.size());
+    const auto& s = decoder.state();
+    EXPECT_EQ(s.sequence, 1u);
+    EXPECT_EQ(s.button_count, 4u);
+    EXPECT_TRUE(s.is_autoplay);
+    EXPECT_EQ(s.total_count, 20);
+    EXPECT_DOUBLE_EQ(s.max_kps, 12.5);
+    EXPECT_DOUBLE_EQ(s.kps_now, 8.5);
+    EXPECT_DOUBLE_EQ(s.columns[1].kps, 3.5);
+    EXPECT_EQ(s.columns[0].times, 12);
+    EXPECT_TRUE(s.columns[0].down);
+    EXPECT_FALSE(s.columns[1].down);
+    EXPECT_TRUE(s.columns[3].down);
+    EXPECT_EQ(s.history_first_second, 1000);
+    EXPECT_EQ(s.history, std::vector<double>(history.begin(), history.end()));
+}
+
+TEST(TestStateFrame, test_history_delta) {
+    std::array<double, 300> history{};
+    for (size_t i = 0; i < history.size(); i++)
+        history[i] = static_cast<double>(i);
+    state_encoder encoder;
+    state_decoder decoder;
+    std::vector<std::byte> stream; // 模拟订阅者收到的字节流。
+    auto send = [&](const live_state& state) {
+        auto frame = encoder.encode(state);
+        stream.insert(stream.end(), frame.begin(), frame.end());
+        return frame.size();
+    };
+    send(sample_state(history, 1000));
+
+    // 时间戳相同，只有最后一个值可能不同。
+    history.back() = 500;
+    EXPECT_EQ(send(sample_state(history, 1000)), frame_fixed_size + 8 * 4 + 4);
+    // 平移 3 秒，发送最后 4 个值。
+    std::shift_left(history.begin(), history.end(), 3);
+    history[296] = 501;
+    history[297] = 502;
+    history[298] = 503;
+    history[299] = 504;
+    EXPECT_EQ(send(sample_state(history, 1003)), frame_fixed_size + 8 * 4 + 4 * 4);
+
+    size_t offset = 0;
+    while (size_t size = decoder.decode(std::span(stream).subspan(offset)))
+        offset += size;
+    EXPECT_EQ(offset, stream.size());
+    EXPECT_EQ(decoder.state().sequence, 3u);
+    EXPECT_EQ(decoder.state().history_first_second, 1003);
+    EXPECT_EQ(decoder.state().history, std::vector<double>(history.begin(), history.end()));
+
+    // 代数改变或有新订阅者时发送完整的历史记录。
+    auto state = sample_state(history, 1003);
+    state.history_generation = 2;
+    EXPECT_EQ(send(state), frame_fixed_size + 8 * 4 + 4 * history.size());
+    EXPECT_EQ(send(state), frame_fixed_size + 8 * 4 + 4);
+    encoder.request_keyframe();
+    EXPECT_EQ(send(state), frame_fixed_size + 8 * 4 + 4 * history.size());
+}
+
+TEST(TestStateFrame, test_invalid_frame) {
+    std::array<double, 300> history{};
+    state_encoder encoder;
+    encoder.encode(sample_state(history, 1000));
+    auto delta = encoder.encode(sample_state(history, 1001));
+    std::vector<std::byte> frame(delta.begin(), delta.end());
+
+    state_decoder decoder;
+    EXPECT_THROW(decoder.decode(frame), std::runtime_error); // 订阅者尚未收到关键帧。
+    frame[0] = std::byte{};
+    EXPECT_THROW(decoder.decode(frame), std::runtime_error);
+}
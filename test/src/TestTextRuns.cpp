@@ -0,0 +1,63 @@
+/**
+ * @file TestTextRuns.cpp
+ * @author UnnamedOrange
+ * @brief Test `overlay::text_run_cache`.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <format>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <overlay/text_runs.hpp>
+
+using namespace overlay;
+
+TEST(TestTextRuns, test_formats_each_value_once) {
+    text_run_cache texts;
+    EXPECT_EQ(texts.get(text_format::integer, 12), L"12");
+    EXPECT_EQ(texts.get(text_format::integer, -3), L"-3");
+    EXPECT_EQ(texts.formatted_count(), 2u);
+
+    const auto view = texts.get(text_format::integer, 12);
+    EXPECT_EQ(view, L"12");
+    EXPECT_EQ(texts.formatted_count(), 2u);
+    // Cached runs do not move when other runs are added.
+    for (int i = 0; i < 100; i++)
+        texts.get(text_format::integer, i);
+    EXPECT_EQ(view.data(), texts.get(text_format::integer, 12).data());
+}
+
+TEST(TestTextRuns, test_set_format_drops_runs_of_that_format) {
+    text_run_cache texts;
+    texts.set_format(text_format::keys, L"({0} keys)");
+    texts.set_format(text_format::recent, L"{0:.1f} max KPS in recent 5 minutes.");
+    EXPECT_EQ(texts.get(text_format::keys, 4), L"(4 keys)");
+    EXPECT_EQ(texts.get(text_format::recent, 125), L"12.5 max KPS in recent 5 minutes.");
+    EXPECT_EQ(texts.get(text_format::integer, 7), L"7");
+    EXPECT_EQ(texts.formatted_count(), 3u);
+
+    // Setting the same format keeps the cached runs.
+    texts.set_format(text_format::keys, L"({0} keys)");
+    texts.get(text_format::keys, 4);
+    EXPECT_EQ(texts.formatted_count(), 3u);
+
+    texts.set_format(text_format::keys, L"（{0} 键）");
+    EXPECT_EQ(texts.get(text_format::keys, 4), L"（4 键）");
+    texts.get(text_format::integer, 7);
+    EXPECT_EQ(texts.formatted_count(), 4u);
+}
+
+TEST(TestTextRuns, test_recent_matches_direct_formatting) {
+    text_run_cache texts;
+    texts.set_format(text_format::recent, L"{0:.1f}");
+    for (int tenths = 0; tenths < 3000; tenths += 7) {
+        double value = tenths / 10.0;
+        EXPECT_EQ(texts.get(text_format::recent, tenths), std::format(L"{0:.1f}", value));
+    }
+}
@@ -0,0 +1,96 @@
+/**
+ * @file TestTimingStatistics.cpp
+ * @author UnnamedOrange
+ * @brief Test `log_histogram` and `timing_statistics`.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <timing_statistics.hpp>
+
+using namespace kps;
+using namespace std::literals;
+
+TEST(TestTimingStatistics, test_bucket_bounds) {
+    EXPECT_EQ(log_histogram::index_of(log_histogram::max_value), log_histogram::bucket_count - 1);
+    EXPECT_EQ(log_histogram::index_of(log_histogram::max_value * 10), log_histogram::bucket_count - 1);
+    for (size_t i = 0; i < log_histogram::bucket_count; i++) {
+        auto low = log_histogram::lower_bound_of(i);
+        auto high = low + log_histogram::width_of(i) - 1;
+        EXPECT_EQ(log_histogram::index_of(low), i);
+        EXPECT_EQ(log_histogram::index_of(high), i);
+        if (i + 1 < log_histogram::bucket_count) {
+            EXPECT_EQ(log_histogram::lower_bound_of(i + 1), high + 1);
+        }
+        // Relative error of a bucket is bounded.
+        EXPECT_LE(static_cast<double>(high - low), static_cast<double>(low) / log_histogram::sub_bucket_count + 1);
+    }
+}
+TEST(TestTimingStatistics, test_moments) {
+    timing_statistics<2> stats;
+    std::vector<double> values;
+    std::mt19937 rng(1919810);
+    std::uniform_int_distribution<int> dist(20, 200);
+    for (int i = 0; i < 1000; i++) {
+        int ms = dist(rng);
+        values.push_back(ms * 1000.0);
+        stats.record(1, timing_statistics<2>::metric::interval, std::chrono::milliseconds(ms));
+    }
+    double mean = 0;
+    for (double v : values)
+        mean += v;
+    mean /= values.size();
+    double variance = 0;
+    for (double v : values)
+        variance += (v - mean) * (v - mean);
+    variance /= values.size();
+
+    auto s = stats.snapshot(1, timing_statistics<2>::metric::interval);
+    EXPECT_EQ(s.moments.count, 1000u);
+    EXPECT_NEAR(s.moments.mean, mean, 1e-6 * mean);
+    EXPECT_NEAR(s.moments.variance(), variance, 1e-6 * variance);
+
+    std::sort(values.begin(), values.end());
+    double exact_median = values[499];
+    EXPECT_NEAR(s.quantile(0.5), exact_median, exact_median / log_histogram::sub_bucket_count);
+
+    // Other channels are untouched.
+    EXPECT_EQ(stats.snapshot(0, timing_statistics<2>::metric::interval).moments.count, 0u);
+    EXPECT_EQ(stats.snapshot(1, timing_statistics<2>::metric::hold).moments.count, 0u);
+}
+TEST(TestTimingStatistics, test_clear) {
+    timing_statistics<1> stats;
+    stats.record(0, timing_statistics<1>::metric::hold, -5ms);
+    auto s = stats.snapshot(0, timing_statistics<1>::metric::hold);
+    EXPECT_EQ(s.moments.count, 1u);
+    EXPECT_EQ(s.moments.max, 0.0);
+    stats.clear();
+    s = stats.snapshot(0, timing_statistics<1>::metric::hold);
+    EXPECT_EQ(s.moments.count, 0u);
+    EXPECT_EQ(s.quantile(0.5), 0.0);
+}
+TEST(TestTimingStatistics, test_report) {
+    timing_statistics<3> stats;
+    auto report = stats.report();
+    EXPECT_EQ(std::count(report.begin(), report.end(), L'\n'), 1);
+    stats.record(2, timing_statistics<3>::metric::hold, 40ms);
+    stats.record(2, timing_statistics<3>::metric::hold, 60ms);
+    report = stats.report();
+    // Only the header and the one channel with samples. Columns are numbered from 1.
+    EXPECT_EQ(std::count(report.begin(), report.end(), L'\n'), 2);
+    EXPECT_NE(report.find(L"3 hold"), std::wstring::npos);
+    EXPECT_NE(report.find(L"50000.0"), std::wstring::npos);
+    EXPECT_EQ(report.find(L"interval"), std::wstring::npos);
+}
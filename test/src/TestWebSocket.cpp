@@ -0,0 +1,135 @@
+/**
+ * @file TestWebSocket.cpp
+ * @author UnnamedOrange
+ * @brief Test the WebSocket handshake and framing helpers in `broadcast::websocket`.
+ * @version 1.0.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) UnnamedOrange. Licensed under the MIT License.
+ * See the LICENSE file in the repository root for full license text.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <broadcast/websocket.hpp>
+
+using namespace broadcast;
+
+namespace {
+    std::string hex(std::span<const std::uint8_t> data) {
+        std::string ret;
+        for (auto b : data)
+            ret += std::format("{:02x}", b);
+        return ret;
+    }
+} // namespace
+
+TEST(TestWebSocket, test_sha1_and_base64) {
+    EXPECT_EQ(hex(websocket::sha1("")), "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+    EXPECT_EQ(hex(websocket::sha1("abc")), "a9993e364706816aba3e25717850c26c9cd0d89d");
+    // 填充跨越两个块。
+    EXPECT_EQ(hex(websocket::sha1("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq")),
+              "84983e441c3bd26ebaae4aa1f95129e5e54670f1");
+
+    const std::array<std::uint8_t, 5> data{'h', 'e', 'l', 'l', 'o'};
+    EXPECT_EQ(websocket::base64(data), "aGVsbG8=");
+    EXPECT_EQ(websocket::base64(std::span(data).first(3)), "aGVs");
+    EXPECT_EQ(websocket::base64(std::span(data).first(4)), "aGVsbA==");
+}
+
+TEST(TestWebSocket, test_handshake) {
+    // RFC 6455 第 1.3 节的例子。
+    EXPECT_EQ(websocket::accept_key("dGhlIHNhbXBsZSBub25jZQ=="), "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=");
+
+    const std::string request = "GET /?edges=1 HTTP/1.1\r\n"
+                                "Host: 127.0.0.1:7271\r\n"
+                                "upgrade: WebSocket\r\n"
+                                "Connection: keep-alive, Upgrade\r\n"
+                                "Sec-WebSocket-Key:  dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                                "Sec-WebSocket-Version: 13\r\n"
+                                "\r\n";
+    size_t consumed = 0;
+    EXPECT_FALSE(websocket::parse_request(request.substr(0, request.size() - 1), consumed)); // 不完整。
+    auto parsed = websocket::parse_request(request + "extra", consumed);
+    ASSERT_TRUE(parsed);
+    EXPECT_EQ(consumed, request.size());
+    EXPECT_EQ(parsed->method, "GET");
+    EXPECT_EQ(parsed->target, "/?edges=1");
+    EXPECT_EQ(parsed->key, "dGhlIHNhbXBsZSBub25jZQ==");
+    EXPECT_TRUE(parsed->upgrade);
+
+    parsed = websocket::parse_request("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n", consumed);
+    ASSERT_TRUE(parsed);
+    EXPECT_FALSE(parsed->upgrade);
+    EXPECT_THROW(websocket::parse_request("nonsense\r\n\r\n", consumed), std::runtime_error);
+}
+
+TEST(TestWebSocket, test_origin_allowed) {
+    size_t consumed = 0;
+    auto origin_of = [&](std::string_view header) {
+        return websocket::parse_request(std::format("GET / HTTP/1.1\r\n{}\r\n", header), consumed)->origin;
+    };
+    const std::vector<std::string> allowed{"https://Overlay.example/"};
+    auto allows = [&](std::string_view header) {
+        return websocket::origin_allowed(origin_of(header), 7271, allowed);
+    };
+
+    EXPECT_TRUE(allows(""));                                 // 不是浏览器中的页面。
+    EXPECT_TRUE(allows("Origin: file://\r\n"));              // 本地文件。
+    EXPECT_TRUE(allows("Origin: http://127.0.0.1:7271\r\n")); // 本服务器。
+    EXPECT_TRUE(allows("origin: HTTPS://overlay.example\r\n"));
+    EXPECT_FALSE(allows("Origin: http://127.0.0.1:8080\r\n"));
+    EXPECT_FALSE(allows("Origin: https://evil.example\r\n"));
+    EXPECT_FALSE(allows("Origin: https://overlay.example.evil\r\n"));
+}
+
+TEST(TestWebSocket, test_origin_null) {
+    size_t consumed = 0;
+    const auto origin = websocket::parse_request("GET / HTTP/1.1\r\nOrigin: null\r\n\r\n", consumed)->origin;
+    EXPECT_FALSE(websocket::origin_allowed(origin, 7271, {})); // 沙箱中的页面也会发送 null。
+    const std::vector<std::string> allowed{"null"};
+    EXPECT_TRUE(websocket::origin_allowed(origin, 7271, allowed));
+}
+
+TEST(TestWebSocket, test_frames) {
+    std::array<std::byte, 10> header;
+    EXPECT_EQ(websocket::write_frame_header(websocket::opcode::text, 125, header), 2u);
+    EXPECT_EQ(header[0], std::byte{0x81});
+    EXPECT_EQ(header[1], std::byte{125});
+    EXPECT_EQ(websocket::write_frame_header(websocket::opcode::text, 300, header), 4u);
+    EXPECT_EQ(header[1], std::byte{126});
+    EXPECT_EQ(header[2], std::byte{0x01});
+    EXPECT_EQ(header[3], std::byte{0x2C});
+    EXPECT_EQ(websocket::write_frame_header(websocket::opcode::binary, 0x10000, header), 10u);
+    EXPECT_EQ(header[1], std::byte{127});
+    EXPECT_EQ(header[7], std::byte{0x01});
+
+    // 客户端发来的带掩码的关闭帧，负载为状态码 1000。
+    const std::vector<std::byte> close{std::byte{0x88}, std::byte{0x82}, std::byte{1},    std::byte{2},
+                                       std::byte{3},    std::byte{4},    std::byte{0xE9}, std::byte{0xEA}};
+    EXPECT_FALSE(websocket::parse_frame_header(std::span(close).first(5)));
+    auto parsed = websocket::parse_frame_header(close);
+    ASSERT_TRUE(parsed);
+    EXPECT_TRUE(parsed->fin);
+    EXPECT_EQ(parsed->code, websocket::opcode::close);
+    EXPECT_TRUE(parsed->masked);
+    EXPECT_EQ(parsed->header_size, 6u);
+    EXPECT_EQ(parsed->payload_size, 2u);
+    EXPECT_EQ(parsed->mask, (std::array<std::uint8_t, 4>{1, 2, 3, 4}));
+
+    // 16 位扩展长度。
+    websocket::write_frame_header(websocket::opcode::text, 300, header);
+    auto extended = websocket::parse_frame_header(std::span(header).first(4));
+    ASSERT_TRUE(extended);
+    EXPECT_EQ(extended->payload_size, 300u);
+    EXPECT_EQ(extended->header_size, 4u);
+}